@@ -0,0 +1,150 @@
+#ifndef BENCH_H
+#define BENCH_H
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../mimpi.h"
+#include "../examples/mimpi_err.h"
+
+// Benchmarks print their results (on rank 0) as CSV, or as JSON lines when BENCH_FORMAT=json.
+// Each benchmark takes the largest message size as an optional first argument.
+
+#define BENCH_TAG 1
+#define BENCH_DEFAULT_MAX_SIZE (64 << 20)
+#define BENCH_WARMUP 2
+#define BENCH_MIN_ITERATIONS 5
+#define BENCH_MAX_ITERATIONS 1000
+#define BENCH_BYTES_PER_SIZE (256 << 20) // Bytes moved per message size before samples get capped.
+
+// Initialises MIMPI, with deadlock detection when BENCH_DEADLOCK_DETECTION=1.
+static inline void bench_init()
+{
+    char const *detection = getenv("BENCH_DEADLOCK_DETECTION");
+    MIMPI_Init(detection != NULL && atoi(detection) == 1);
+}
+
+static inline double bench_now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static inline size_t bench_max_size(int argc, char **argv)
+{
+    return argc > 1 ? (size_t)atoll(argv[1]) : BENCH_DEFAULT_MAX_SIZE;
+}
+
+// Number of samples taken for messages of the given size, BENCH_ITERATIONS lowers the upper limit.
+static inline int bench_iterations(size_t size)
+{
+    char const *limit_str = getenv("BENCH_ITERATIONS");
+    long limit = limit_str ? atol(limit_str) : BENCH_MAX_ITERATIONS;
+    if (limit > BENCH_MAX_ITERATIONS)
+        limit = BENCH_MAX_ITERATIONS;
+    long iterations = BENCH_BYTES_PER_SIZE / (size > 0 ? size : 1);
+
+    if (iterations > limit)
+        iterations = limit;
+    if (iterations < BENCH_MIN_ITERATIONS)
+        iterations = BENCH_MIN_ITERATIONS;
+    return iterations;
+}
+
+static inline void *bench_alloc(size_t size)
+{
+    char *buf = malloc(size > 0 ? size : 1);
+    assert(buf != NULL);
+    memset(buf, 1, size); // Fault the pages in before measuring.
+    return buf;
+}
+
+// Replaces samples of rank 0 with the maximum over all ranks, so that a sample covers the slowest process.
+static inline void bench_collect_max(double *samples, int count)
+{
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    if (world_rank != 0)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Send(samples, count * sizeof(double), 0, BENCH_TAG));
+        return;
+    }
+
+    double *other = malloc(count * sizeof(double));
+    assert(other != NULL);
+    for (int rank = 1; rank < world_size; rank++)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Recv(other, count * sizeof(double), rank, BENCH_TAG));
+        for (int i = 0; i < count; i++)
+            if (other[i] > samples[i])
+                samples[i] = other[i];
+    }
+    free(other);
+}
+
+static inline int bench_compare_doubles(void const *a, void const *b)
+{
+    double const x = *(double const *)a, y = *(double const *)b;
+    return (x > y) - (x < y);
+}
+
+static inline double bench_percentile(double const *sorted, int count, double p)
+{
+    int index = (int)(p / 100 * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+static inline int bench_delay(char const *var)
+{
+    char const *delay = getenv(var);
+    return delay ? atoi(delay) : 0;
+}
+
+// Prints statistics of samples (in microseconds), each of which moved `bytes` bytes (0 if not meaningful).
+static inline void bench_report(char const *name, size_t size, double *samples, int count, double bytes)
+{
+    static bool header_printed = false;
+    bool const json = getenv("BENCH_FORMAT") && strcmp(getenv("BENCH_FORMAT"), "json") == 0;
+
+    qsort(samples, count, sizeof(double), bench_compare_doubles);
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += samples[i];
+
+    double const p50 = bench_percentile(samples, count, 50);
+    double const bandwidth = bytes > 0 ? bytes / p50 : 0; // Bytes per microsecond are megabytes per second.
+    int const n = MIMPI_World_size();
+    int const write_delay = bench_delay("CHANNELS_WRITE_DELAY");
+    int const read_delay = bench_delay("CHANNELS_READ_DELAY");
+
+    if (json)
+    {
+        printf("{\"bench\": \"%s\", \"n\": %d, \"size\": %zu, \"iterations\": %d, "
+               "\"write_delay_ms\": %d, \"read_delay_ms\": %d, "
+               "\"min_us\": %.3f, \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, "
+               "\"max_us\": %.3f, \"mean_us\": %.3f, \"mb_per_s\": %.3f}\n",
+               name, n, size, count, write_delay, read_delay,
+               samples[0], p50, bench_percentile(samples, count, 90), bench_percentile(samples, count, 99),
+               samples[count - 1], sum / count, bandwidth);
+    }
+    else
+    {
+        if (!header_printed && !getenv("BENCH_NO_HEADER"))
+            printf("bench,n,size,iterations,write_delay_ms,read_delay_ms,"
+                   "min_us,p50_us,p90_us,p99_us,max_us,mean_us,mb_per_s\n");
+        printf("%s,%d,%zu,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+               name, n, size, count, write_delay, read_delay,
+               samples[0], p50, bench_percentile(samples, count, 90), bench_percentile(samples, count, 99),
+               samples[count - 1], sum / count, bandwidth);
+    }
+
+    header_printed = true;
+    fflush(stdout);
+}
+
+#endif // BENCH_H
@@ -0,0 +1,74 @@
+#include "bench.h"
+
+typedef enum
+{
+    BARRIER,
+    BCAST,
+    REDUCE,
+    ALLREDUCE,
+} collective;
+
+static void run(collective op, char *data, char *result, size_t size)
+{
+    switch (op)
+    {
+    case BARRIER:
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+        break;
+    case BCAST:
+        ASSERT_MIMPI_OK(MIMPI_Bcast(data, size, 0));
+        break;
+    case REDUCE:
+        ASSERT_MIMPI_OK(MIMPI_Reduce(data, result, size, MIMPI_SUM, 0));
+        break;
+    case ALLREDUCE:
+        ASSERT_MIMPI_OK(MIMPI_Allreduce(data, result, size, MIMPI_SUM));
+        break;
+    }
+}
+
+// Completion time (over the slowest rank) of MIMPI_Barrier, MIMPI_Bcast and MIMPI_Reduce rooted at 0, and MIMPI_Allreduce.
+int main(int argc, char **argv)
+{
+    bench_init();
+
+    int const world_rank = MIMPI_World_rank();
+    size_t const max_size = bench_max_size(argc, argv);
+    char *data = bench_alloc(max_size);
+    char *result = bench_alloc(max_size);
+    double *samples = malloc(BENCH_MAX_ITERATIONS * sizeof(double));
+
+    char const *const names[] = {"barrier", "bcast", "reduce", "allreduce"};
+
+    for (collective op = BARRIER; op <= ALLREDUCE; op++)
+    {
+        for (size_t size = 1; size <= max_size; size *= 2)
+        {
+            int const iterations = bench_iterations(size);
+
+            for (int i = -BENCH_WARMUP; i < iterations; i++)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Barrier());
+                double const start = bench_now_us();
+
+                run(op, data, result, size);
+
+                if (i >= 0)
+                    samples[i] = bench_now_us() - start;
+            }
+
+            bench_collect_max(samples, iterations);
+            if (world_rank == 0)
+                bench_report(names[op], op == BARRIER ? 0 : size, samples, iterations, op == BARRIER ? 0 : size);
+
+            if (op == BARRIER)
+                break;
+        }
+    }
+
+    free(samples);
+    free(result);
+    free(data);
+    MIMPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "bench.h"
+
+// Many-to-one: every rank sends a message to rank 0, which receives them all before the next round.
+int main(int argc, char **argv)
+{
+    bench_init();
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    size_t const max_size = bench_max_size(argc, argv);
+    char *buf = bench_alloc(max_size);
+    double *samples = malloc(BENCH_MAX_ITERATIONS * sizeof(double));
+
+    for (size_t size = 1; size <= max_size; size *= 2)
+    {
+        int const iterations = bench_iterations((world_size - 1) * size);
+
+        for (int i = -BENCH_WARMUP; i < iterations; i++)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Barrier());
+            double const start = bench_now_us();
+
+            if (world_rank == 0)
+            {
+                for (int rank = 1; rank < world_size; rank++)
+                    ASSERT_MIMPI_OK(MIMPI_Recv(buf, size, rank, BENCH_TAG));
+            }
+            else
+            {
+                ASSERT_MIMPI_OK(MIMPI_Send(buf, size, 0, BENCH_TAG));
+            }
+
+            if (i >= 0)
+                samples[i] = bench_now_us() - start;
+        }
+
+        if (world_rank == 0)
+            bench_report("incast", size, samples, iterations, (double)(world_size - 1) * size);
+    }
+
+    free(samples);
+    free(buf);
+    MIMPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include <malloc.h>
+#include <stdint.h>
+#include "bench.h"
+
+#define MATCHING_DEFAULT_MAX_SIZE 1024
+#define MATCHING_DEFAULT_MAX_DEPTH 4096
+#define MATCHING_DEFAULT_TAGS 64
+#define MATCHING_RECEIVES_PER_DEPTH 4096 // Receives posted per queue depth before rounds get capped.
+#define MATCHING_FIRST_TAG (BENCH_TAG + 1) // Flooded messages take tags above the one marking the end of a flood.
+
+typedef enum
+{
+    UNIFORM,
+    ZIPF,
+} distribution;
+
+typedef enum
+{
+    FIFO,    // In the order of arrival.
+    RANDOM,
+    REVERSE, // Latest arrival first, the worst case for queues searched from the oldest message.
+} order;
+
+typedef struct
+{
+    int source;
+    int tag;
+    int size;
+} message;
+
+static char const *const distribution_names[] = {"uniform", "zipf"};
+static char const *const order_names[] = {"fifo", "random", "reverse"};
+
+static uint64_t next_random(uint64_t *state)
+{
+    // xorshift64*, the same sequence on every rank.
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+static double uniform_random(uint64_t *state)
+{
+    return (next_random(state) >> 11) * (1.0 / (1ULL << 53));
+}
+
+// Cumulative weights of `count` values, the k-th taking 1 / (k + 1) for ZIPF, all equal for UNIFORM.
+static double *weights(distribution dist, int count)
+{
+    double *cumulative = malloc(count * sizeof(double));
+    assert(cumulative != NULL);
+
+    double sum = 0;
+    for (int k = 0; k < count; k++)
+    {
+        sum += dist == ZIPF ? 1.0 / (k + 1) : 1;
+        cumulative[k] = sum;
+    }
+    for (int k = 0; k < count; k++)
+        cumulative[k] /= sum;
+    return cumulative;
+}
+
+static int pick(double const *cumulative, int count, uint64_t *state)
+{
+    double const u = uniform_random(state);
+    int low = 0, high = count - 1;
+    while (low < high)
+    {
+        int const middle = (low + high) / 2;
+        if (cumulative[middle] < u)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+// Bytes of the heap in use, including chunks mapped on their own.
+static size_t heap_in_use()
+{
+    struct mallinfo2 const info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static bool selected(char const *var, char const *name)
+{
+    return getenv(var) == NULL || strcmp(getenv(var), name) == 0;
+}
+
+// Prints statistics of receive latencies (in microseconds); the heap per message is left out when negative.
+static void report(distribution dist, order ord, int depth, double *samples, int count,
+                   double heap_per_message, double payload_per_message)
+{
+    static bool header_printed = false;
+    bool const json = getenv("BENCH_FORMAT") && strcmp(getenv("BENCH_FORMAT"), "json") == 0;
+
+    qsort(samples, count, sizeof(double), bench_compare_doubles);
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += samples[i];
+
+    int const n = MIMPI_World_size();
+    char heap[32] = "";
+    if (heap_per_message >= 0)
+        snprintf(heap, sizeof(heap), "%.1f", heap_per_message);
+
+    if (json)
+    {
+        printf("{\"bench\": \"matching\", \"n\": %d, \"distribution\": \"%s\", \"order\": \"%s\", "
+               "\"depth\": %d, \"receives\": %d, "
+               "\"min_us\": %.3f, \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, "
+               "\"max_us\": %.3f, \"mean_us\": %.3f, "
+               "\"heap_bytes_per_message\": %s, \"payload_bytes_per_message\": %.1f}\n",
+               n, distribution_names[dist], order_names[ord], depth, count,
+               samples[0], bench_percentile(samples, count, 50), bench_percentile(samples, count, 90),
+               bench_percentile(samples, count, 99), samples[count - 1], sum / count,
+               heap_per_message >= 0 ? heap : "null", payload_per_message);
+    }
+    else
+    {
+        if (!header_printed && !getenv("BENCH_NO_HEADER"))
+            printf("bench,n,distribution,order,depth,receives,min_us,p50_us,p90_us,p99_us,max_us,mean_us,"
+                   "heap_bytes_per_message,payload_bytes_per_message\n");
+        printf("matching,%d,%s,%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%s,%.1f\n",
+               n, distribution_names[dist], order_names[ord], depth, count,
+               samples[0], bench_percentile(samples, count, 50), bench_percentile(samples, count, 90),
+               bench_percentile(samples, count, 99), samples[count - 1], sum / count,
+               heap, payload_per_message);
+    }
+
+    header_printed = true;
+    fflush(stdout);
+}
+
+// Ranks other than 0 flood rank 0 with `depth` messages in turns and mark the end of the flood.
+// Once all marks have arrived, every message is queued at rank 0, which then receives them in the given order.
+// Returns the heap rank 0 used with the messages queued.
+static size_t flood(message const *messages, int const *receive_order, int depth, char *buf,
+                    double *latencies, size_t baseline)
+{
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    char mark = 0;
+
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    if (world_rank != 0)
+    {
+        for (int i = 0; i < depth; i++)
+            if (messages[i].source == world_rank)
+                ASSERT_MIMPI_OK(MIMPI_Send(buf, messages[i].size, 0, messages[i].tag));
+        ASSERT_MIMPI_OK(MIMPI_Send(&mark, 1, 0, BENCH_TAG));
+        return 0;
+    }
+
+    // Channels are read in order, so messages sent before a mark are queued once it is received.
+    for (int rank = 1; rank < world_size; rank++)
+        ASSERT_MIMPI_OK(MIMPI_Recv(&mark, 1, rank, BENCH_TAG));
+    size_t const heap = heap_in_use() - baseline;
+
+    for (int i = 0; i < depth; i++)
+    {
+        message const *m = &messages[receive_order[i]];
+        double const start = bench_now_us();
+        ASSERT_MIMPI_OK(MIMPI_Recv(buf, m->size, m->source, m->tag));
+        latencies[i] = bench_now_us() - start;
+    }
+    return heap;
+}
+
+// Per-receive latency against the number of messages queued, which floods with tags and sizes drawn
+// from skewed distributions leave unexpected at rank 0, and the heap taken per queued message.
+// Takes the largest message size as an optional argument (1 KiB by default).
+int main(int argc, char **argv)
+{
+    bench_init();
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    assert(world_size > 1);
+
+    size_t const max_size = argc > 1 ? (size_t)atoll(argv[1]) : MATCHING_DEFAULT_MAX_SIZE;
+    char const *max_depth_str = getenv("BENCH_MAX_DEPTH");
+    int const max_depth = max_depth_str ? atoi(max_depth_str) : MATCHING_DEFAULT_MAX_DEPTH;
+    char const *tags_str = getenv("BENCH_TAGS");
+    int const tags = tags_str ? atoi(tags_str) : MATCHING_DEFAULT_TAGS;
+    char const *seed_str = getenv("BENCH_SEED");
+    uint64_t state = seed_str ? strtoull(seed_str, NULL, 10) | 1 : 1;
+
+    int size_classes = 1;
+    while (((size_t)1 << size_classes) <= max_size)
+        size_classes++;
+
+    char *buf = bench_alloc((size_t)1 << (size_classes - 1));
+    message *messages = malloc(max_depth * sizeof(message));
+    int *receive_order = malloc(max_depth * sizeof(int));
+    double *latencies = malloc(max_depth * sizeof(double));
+    double *samples = malloc((MATCHING_RECEIVES_PER_DEPTH + BENCH_MIN_ITERATIONS * max_depth) * sizeof(double));
+    assert(messages != NULL && receive_order != NULL && latencies != NULL && samples != NULL);
+
+    for (int i = 0; i < BENCH_WARMUP; i++)
+    {
+        messages[0] = (message){.source = 1, .tag = MATCHING_FIRST_TAG, .size = 1};
+        receive_order[0] = 0;
+        flood(messages, receive_order, 1, buf, latencies, 0);
+    }
+
+    // Pools of MIMPI keep what the deepest queue so far has taken, so the heap grown since the first flood
+    // tells the memory per message only of floods deeper than all earlier ones.
+    size_t const baseline = world_rank == 0 ? heap_in_use() : 0;
+    int deepest_flood = 0;
+
+    for (distribution dist = UNIFORM; dist <= ZIPF; dist++)
+    {
+        if (!selected("BENCH_DISTRIBUTION", distribution_names[dist]))
+            continue;
+
+        double *tag_weights = weights(dist, tags);
+        double *size_weights = weights(dist, size_classes);
+
+        for (order ord = FIFO; ord <= REVERSE; ord++)
+        {
+            if (!selected("BENCH_ORDER", order_names[ord]))
+                continue;
+
+            for (int depth = 1; depth <= max_depth; depth *= 2)
+            {
+                bool const deepest = depth > deepest_flood;
+                int rounds = MATCHING_RECEIVES_PER_DEPTH / depth;
+                if (rounds < BENCH_MIN_ITERATIONS)
+                    rounds = BENCH_MIN_ITERATIONS;
+
+                int count = 0;
+                double heap_per_message = 0, payload_per_message = 0;
+
+                for (int round = 0; round < rounds; round++)
+                {
+                    size_t payload = 0;
+                    for (int i = 0; i < depth; i++)
+                    {
+                        messages[i].source = 1 + i % (world_size - 1);
+                        messages[i].tag = MATCHING_FIRST_TAG + pick(tag_weights, tags, &state);
+                        messages[i].size = 1 << pick(size_weights, size_classes, &state);
+                        payload += messages[i].size;
+                        receive_order[i] = ord == REVERSE ? depth - 1 - i : i;
+                    }
+                    if (ord == RANDOM)
+                        for (int i = depth - 1; i > 0; i--)
+                        {
+                            int const j = next_random(&state) % (i + 1);
+                            int const swapped = receive_order[i];
+                            receive_order[i] = receive_order[j];
+                            receive_order[j] = swapped;
+                        }
+
+                    size_t const heap = flood(messages, receive_order, depth, buf, latencies, baseline);
+
+                    // A row for depth D covers receives posted with more than D / 2 messages queued.
+                    for (int i = 0; i < depth && depth - i > depth / 2; i++)
+                        samples[count++] = latencies[i];
+                    heap_per_message += (double)heap / depth / rounds;
+                    payload_per_message += (double)payload / depth / rounds;
+                }
+
+                if (world_rank == 0)
+                    report(dist, ord, depth, samples, count, deepest ? heap_per_message : -1, payload_per_message);
+                if (deepest)
+                    deepest_flood = depth;
+            }
+        }
+
+        free(tag_weights);
+        free(size_weights);
+    }
+
+    free(samples);
+    free(latencies);
+    free(receive_order);
+    free(messages);
+    free(buf);
+    MIMPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "bench.h"
+
+// Round-trip latency between ranks 0 and 1 for message sizes from 1 B up to the maximum.
+int main(int argc, char **argv)
+{
+    bench_init();
+
+    int const world_rank = MIMPI_World_rank();
+    size_t const max_size = bench_max_size(argc, argv);
+    char *buf = bench_alloc(max_size);
+    double *samples = malloc(BENCH_MAX_ITERATIONS * sizeof(double));
+
+    for (size_t size = 1; size <= max_size; size *= 2)
+    {
+        int const iterations = bench_iterations(2 * size);
+
+        for (int i = -BENCH_WARMUP; i < iterations; i++)
+        {
+            double const start = bench_now_us();
+
+            if (world_rank == 0)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Send(buf, size, 1, BENCH_TAG));
+                ASSERT_MIMPI_OK(MIMPI_Recv(buf, size, 1, BENCH_TAG));
+            }
+            else if (world_rank == 1)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Recv(buf, size, 0, BENCH_TAG));
+                ASSERT_MIMPI_OK(MIMPI_Send(buf, size, 0, BENCH_TAG));
+            }
+
+            if (i >= 0)
+                samples[i] = (bench_now_us() - start) / 2;
+        }
+
+        if (world_rank == 0)
+            bench_report("pingpong", size, samples, iterations, size);
+    }
+
+    free(samples);
+    free(buf);
+    MIMPI_Finalize();
+    return 0;
+}
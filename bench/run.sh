@@ -0,0 +1,63 @@
+#!/bin/bash
+# Runs every benchmark three times: with channels unchanged, with CHANNELS_*_DELAY set
+# and over links emulated with CHANNELS_LATENCY and CHANNELS_BANDWIDTH.
+# Results go to $BENCH_OUTPUT (default bench_results/) as no_delay.csv, delay.csv and links.csv,
+# or as .json files with JSON lines when BENCH_FORMAT=json. The matching benchmark, which has
+# columns of its own, runs once per distribution without delays into matching.csv.
+#
+# Usage: bench/run.sh [MAX_PROCESSES]
+#
+# Tunables (environment):
+#   BENCH_DELAY             delay in ms per 512 B block of the delayed run (default 1)
+#   BENCH_DELAYED_MAX_SIZE  largest message of the delayed run (default 16384)
+#   BENCH_DELAYED_ITERATIONS  samples per size of the delayed run (default 10)
+#   BENCH_LATENCY           latency in us of links of the emulated run (default 50)
+#   BENCH_BANDWIDTH         bandwidth in MB/s of links of the emulated run (default 1000)
+set -e
+
+MAX_PROCESSES=${1:-16}
+OUTPUT=${BENCH_OUTPUT:-bench_results}
+EXTENSION=csv
+if [ "$BENCH_FORMAT" = "json" ]; then
+    EXTENSION=json
+fi
+
+make bench >/dev/null
+mkdir -p "$OUTPUT"
+
+run_all() {
+    local file="$OUTPUT/$1.$EXTENSION"
+    local max_size=$2
+    : > "$file"
+
+    # Only the first benchmark prints the CSV header.
+    ./mimpirun 2 bench_build/pingpong "$max_size" >> "$file"
+    export BENCH_NO_HEADER=1
+    ./mimpirun 2 bench_build/streaming "$max_size" >> "$file"
+    for n in $(seq 2 "$MAX_PROCESSES"); do
+        ./mimpirun "$n" bench_build/incast "$max_size" >> "$file"
+        ./mimpirun "$n" bench_build/collectives "$max_size" >> "$file"
+    done
+    unset BENCH_NO_HEADER
+
+    echo "Results written to $file"
+}
+
+unset CHANNELS_WRITE_DELAY CHANNELS_READ_DELAY
+run_all no_delay $((64 << 20))
+
+# A process per distribution, so that the heap per message is reported for each.
+file="$OUTPUT/matching.$EXTENSION"
+BENCH_DISTRIBUTION=uniform ./mimpirun 2 bench_build/matching > "$file"
+BENCH_DISTRIBUTION=zipf BENCH_NO_HEADER=1 ./mimpirun 2 bench_build/matching >> "$file"
+echo "Results written to $file"
+
+export CHANNELS_WRITE_DELAY=${BENCH_DELAY:-1}
+export CHANNELS_READ_DELAY=${BENCH_DELAY:-1}
+BENCH_ITERATIONS=${BENCH_DELAYED_ITERATIONS:-10} run_all delay "${BENCH_DELAYED_MAX_SIZE:-16384}"
+
+unset CHANNELS_WRITE_DELAY CHANNELS_READ_DELAY
+
+export CHANNELS_LATENCY=${BENCH_LATENCY:-50}
+export CHANNELS_BANDWIDTH=${BENCH_BANDWIDTH:-1000}
+BENCH_ITERATIONS=${BENCH_DELAYED_ITERATIONS:-10} run_all links "${BENCH_DELAYED_MAX_SIZE:-16384}"
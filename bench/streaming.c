@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#define WINDOW 64
+
+// Unidirectional bandwidth: rank 0 streams windows of messages to rank 1, which acknowledges each window.
+int main(int argc, char **argv)
+{
+    bench_init();
+
+    int const world_rank = MIMPI_World_rank();
+    size_t const max_size = bench_max_size(argc, argv);
+    char *buf = bench_alloc(max_size);
+    double *samples = malloc(BENCH_MAX_ITERATIONS * sizeof(double));
+    char ack = 0;
+
+    for (size_t size = 1; size <= max_size; size *= 2)
+    {
+        int const iterations = bench_iterations(WINDOW * size);
+
+        for (int i = -BENCH_WARMUP; i < iterations; i++)
+        {
+            double const start = bench_now_us();
+
+            if (world_rank == 0)
+            {
+                for (int j = 0; j < WINDOW; j++)
+                    ASSERT_MIMPI_OK(MIMPI_Send(buf, size, 1, BENCH_TAG));
+                ASSERT_MIMPI_OK(MIMPI_Recv(&ack, 1, 1, BENCH_TAG));
+            }
+            else if (world_rank == 1)
+            {
+                for (int j = 0; j < WINDOW; j++)
+                    ASSERT_MIMPI_OK(MIMPI_Recv(buf, size, 0, BENCH_TAG));
+                ASSERT_MIMPI_OK(MIMPI_Send(&ack, 1, 0, BENCH_TAG));
+            }
+
+            if (i >= 0)
+                samples[i] = bench_now_us() - start;
+        }
+
+        if (world_rank == 0)
+            bench_report("streaming", size, samples, iterations, (double)WINDOW * size);
+    }
+
+    free(samples);
+    free(buf);
+    MIMPI_Finalize();
+    return 0;
+}
@@ -4,14 +4,25 @@ Might be changed during testing,
 but as stated in the assignment description the provided functions' behaviour
 shouldn't observably differ in any way other than execution duration.
 */
+#define _GNU_SOURCE
 #include "channel.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <poll.h>
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -27,51 +38,345 @@ shouldn't observably differ in any way other than execution duration.
             );                                                                               \
     } while(0)
 
-// based on: https://stackoverflow.com/questions/1157209/is-there-an-alternative-sleep-function-in-c-to-milliseconds
-/* msleep(): Sleep for the requested number of milliseconds. */
-static int msleep(long msec)
+#define WRITE_VAR "CHANNELS_WRITE_DELAY"
+#define READ_VAR "CHANNELS_READ_DELAY"
+#define LATENCY_VAR "CHANNELS_LATENCY"
+#define BANDWIDTH_VAR "CHANNELS_BANDWIDTH"
+#define LINKS_VAR "CHANNELS_LINKS"
+#define ATOMIC_BLOCK_SIZE 512
+#define ANY_END -1
+
+/* Emulated parameters of links from `sender` to `receiver` (ANY_END matches any process). */
+typedef struct link_rule
+{
+    int sender;
+    int receiver;
+    uint64_t latency_ns; // Time every message takes to arrive on top of its transmission.
+    double ns_per_byte;  // Transmission time of a byte, 0 for unlimited bandwidth.
+} link_rule;
+
+/* Emulated link a descriptor is an end of. Transfers over it queue behind each other. */
+typedef struct link_model
+{
+    pthread_mutex_t mutex;
+    uint64_t busy_until; // Time the link finishes transmitting what has been queued so far.
+    uint64_t latency_ns;
+    double ns_per_byte;
+} link_model;
+
+static uint64_t write_block_ns = 0; // Transmission time of a 512 B block, from CHANNELS_WRITE_DELAY.
+static uint64_t read_block_ns = 0;  // Same for reads, from CHANNELS_READ_DELAY.
+static link_rule *rules = NULL;     // Default parameters followed by those of CHANNELS_LINKS, later ones win.
+static int rules_count = 0;
+static link_model **models = NULL;  // Links indexed by descriptors, NULL for ones never labelled.
+static int models_count = 0;
+
+static uint64_t now_ns(void)
 {
     struct timespec ts;
-    int res;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
 
-    if (msec < 0)
+static void sleep_until(uint64_t deadline_ns)
+{
+    struct timespec const ts = {.tv_sec = deadline_ns / 1000000000, .tv_nsec = deadline_ns % 1000000000};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static uint64_t block_delay_ns(const char *delay_var)
+{
+    const char *delay_str = getenv(delay_var);
+    int const delay_ms = delay_str != NULL ? atoi(delay_str) : 0;
+    return delay_ms > 0 ? (uint64_t)delay_ms * 1000000 : 0;
+}
+
+static link_rule make_rule(int sender, int receiver, long long latency_us, long long bandwidth)
+{
+    return (link_rule){
+        .sender = sender,
+        .receiver = receiver,
+        .latency_ns = latency_us > 0 ? (uint64_t)latency_us * 1000 : 0,
+        .ns_per_byte = bandwidth > 0 ? 1000.0 / bandwidth : 0,
+    };
+}
+
+static int parse_end(const char *str, char **end)
+{
+    if (*str == '*')
     {
-        errno = EINVAL;
-        return -1;
+        *end = (char *)str + 1;
+        return ANY_END;
     }
+    return (int)strtol(str, end, 10);
+}
 
-    ts.tv_sec = msec / 1000;
-    ts.tv_nsec = (msec % 1000) * 1000000;
+/* Reads rules of CHANNELS_LINKS: comma separated SENDER-RECEIVER=LATENCY/BANDWIDTH, `*` matching any process. */
+static void parse_rules(void)
+{
+    const char *latency_str = getenv(LATENCY_VAR);
+    const char *bandwidth_str = getenv(BANDWIDTH_VAR);
+    const char *links_str = getenv(LINKS_VAR);
+
+    int capacity = 1;
+    for (const char *c = links_str; c != NULL && *c != '\0'; c++)
+        capacity += *c == ',';
+    capacity += links_str != NULL;
+
+    rules = malloc(capacity * sizeof(link_rule));
+    if (rules == NULL)
+    {
+        perror("channels_init");
+        exit(1);
+    }
+    rules[0] = make_rule(ANY_END, ANY_END, latency_str != NULL ? atoll(latency_str) : 0, bandwidth_str != NULL ? atoll(bandwidth_str) : 0);
+    rules_count = 1;
 
-    do
+    const char *c = links_str;
+    while (c != NULL && *c != '\0')
     {
-        res = nanosleep(&ts, &ts);
-    } while (res && errno == EINTR);
+        char *end;
+        int const sender = parse_end(c, &end);
+        if (*end != '-')
+            break;
+        int const receiver = parse_end(end + 1, &end);
+        if (*end != '=')
+            break;
+        long long const latency_us = strtoll(end + 1, &end, 10);
+        if (*end != '/')
+            break;
+        long long const bandwidth = strtoll(end + 1, &end, 10);
+        if (*end != ',' && *end != '\0')
+            break;
 
-    return res;
+        rules[rules_count++] = make_rule(sender, receiver, latency_us, bandwidth);
+        c = *end == ',' ? end + 1 : end;
+    }
+
+    if (c != NULL && *c != '\0')
+    {
+        fprintf(stderr, "%s: malformed entry at '%s', expected SENDER-RECEIVER=LATENCY/BANDWIDTH\n", LINKS_VAR, c);
+        exit(1);
+    }
 }
 
-#define WRITE_VAR "CHANNELS_WRITE_DELAY"
-#define READ_VAR "CHANNELS_READ_DELAY"
-#define ATOMIC_BLOCK_SIZE 512
+static bool rules_emulate(void)
+{
+    for (int i = 0; i < rules_count; i++)
+        if (rules[i].latency_ns > 0 || rules[i].ns_per_byte > 0)
+            return true;
+    return false;
+}
 
-pthread_mutex_t mutex;
+static link_model *find_model(int fd)
+{
+    return fd >= 0 && fd < models_count ? models[fd] : NULL;
+}
 
-static void delay(const char *delay_var, const size_t size)
+/* Makes a transfer of `size` bytes over the link of the descriptor take as long as the emulated link would. */
+static void delay(int fd, const size_t size, bool is_write)
 {
-    ASSERT_ZERO(pthread_mutex_lock(&mutex));
+    uint64_t const block_ns = is_write ? write_block_ns : read_block_ns;
+    link_model *m = find_model(fd);
+    uint64_t const latency_ns = is_write && m != NULL ? m->latency_ns : 0;
+    double const ns_per_byte = is_write && m != NULL ? m->ns_per_byte : 0;
 
-    const char *delay_str = getenv(delay_var);
-    if (delay_str)
+    uint64_t const transmission_ns = (size + ATOMIC_BLOCK_SIZE - 1) / ATOMIC_BLOCK_SIZE * block_ns + (uint64_t)(size * ns_per_byte);
+    if (transmission_ns == 0 && latency_ns == 0)
+        return; // Defaults to not wait
+
+    // Only the reservation of the link is serialised, threads sleep on different links at the same time.
+    uint64_t start = now_ns();
+    if (m != NULL)
     {
-        int delay_ms = atoi(delay_str);
-        if (delay_ms > 0)
+        ASSERT_ZERO(pthread_mutex_lock(&m->mutex));
+        if (m->busy_until > start)
+            start = m->busy_until;
+        m->busy_until = start + transmission_ns;
+        ASSERT_ZERO(pthread_mutex_unlock(&m->mutex));
+    }
+
+    sleep_until(start + transmission_ns + latency_ns);
+}
+
+#define RING_LINE_SIZE 64
+#define RING_LIVENESS_CHECK_MS 100
+
+/* Control block of a ring, followed in memory by its data. Positions only grow. */
+typedef struct ring
+{
+    _Alignas(RING_LINE_SIZE) _Atomic size_t head; // Bytes consumed so far, advanced by the reader.
+    _Alignas(RING_LINE_SIZE) _Atomic size_t tail; // Bytes produced so far, advanced by the writer.
+    _Alignas(RING_LINE_SIZE) _Atomic uint32_t reader_awake; // Reader will look at the ring without a wake-up byte.
+    _Atomic uint32_t writer_waiting; // Futex word the writer sleeps on while the ring is full.
+    _Atomic uint32_t reader_closed; // Reading end has been closed.
+} ring;
+
+/* Ring attached to a descriptor. */
+typedef struct ring_link
+{
+    ring *ring;
+    char *data;
+    size_t capacity;
+} ring_link;
+
+static ring_link *links = NULL;
+static int links_count = 0;
+
+static ring_link *find_link(int fd)
+{
+    if (fd < 0 || fd >= links_count || links[fd].ring == NULL)
+        return NULL;
+    return &links[fd];
+}
+
+static long futex(_Atomic uint32_t *word, int op, uint32_t value, const struct timespec *timeout)
+{
+    return syscall(SYS_futex, word, op, value, timeout, NULL, 0);
+}
+
+/* Wakes up the reader if it went to sleep on the descriptor. */
+static int wake_reader(int fd, ring_link *l)
+{
+    if (!atomic_load(&l->ring->reader_awake) && !atomic_exchange(&l->ring->reader_awake, 1))
+    {
+        char const bell = 0;
+        if (write(fd, &bell, 1) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+/* Wakes up the writer if it went to sleep waiting for free space. */
+static void wake_writer(ring_link *l)
+{
+    if (atomic_load(&l->ring->writer_waiting) && atomic_exchange(&l->ring->writer_waiting, 0))
+        futex(&l->ring->writer_waiting, FUTEX_WAKE, 1, NULL);
+}
+
+/* Sleeps until the reader frees some space; fails if the reader is gone. */
+static int wait_for_space(int fd, ring_link *l)
+{
+    ring *r = l->ring;
+    atomic_store(&r->writer_waiting, 1);
+
+    if (atomic_load(&r->tail) - atomic_load(&r->head) < l->capacity)
+    {
+        atomic_store(&r->writer_waiting, 0);
+        return 0;
+    }
+
+    struct timespec const timeout = {.tv_sec = 0, .tv_nsec = RING_LIVENESS_CHECK_MS * 1000000L};
+    if (!atomic_load(&r->reader_closed)
+        && futex(&r->writer_waiting, FUTEX_WAIT, 1, &timeout) == -1 && errno == ETIMEDOUT)
+    {
+        // The reader might have died without closing its end.
+        struct pollfd pfd = {.fd = fd, .events = 0};
+        if (poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLERR))
+            atomic_store(&r->reader_closed, 1);
+    }
+
+    if (atomic_load(&r->reader_closed))
+    {
+        errno = EPIPE;
+        return -1;
+    }
+    return 0;
+}
+
+static ssize_t ring_send(int fd, ring_link *l, const struct iovec *iov, int iovcnt)
+{
+    ring *r = l->ring;
+    if (atomic_load(&r->reader_closed))
+    {
+        errno = EPIPE;
+        return -1;
+    }
+
+    ssize_t sent = 0;
+    for (int i = 0; i < iovcnt && sent < INT_MAX; i++)
+    {
+        const char *buf = iov[i].iov_base;
+        size_t left = iov[i].iov_len;
+        if (left > (size_t)(INT_MAX - sent))
+            left = INT_MAX - sent; // The result has to fit in an int.
+
+        while (left > 0)
         {
-            msleep((size + ATOMIC_BLOCK_SIZE - 1) / ATOMIC_BLOCK_SIZE * delay_ms);
+            size_t const tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+            size_t const space = l->capacity - (tail - atomic_load_explicit(&r->head, memory_order_acquire));
+
+            if (space == 0)
+            {
+                if (wake_reader(fd, l) == -1 || wait_for_space(fd, l) == -1)
+                    return sent > 0 ? sent : -1;
+                continue;
+            }
+
+            size_t const offset = tail & (l->capacity - 1);
+            size_t n = left < space ? left : space;
+            if (n > l->capacity - offset)
+                n = l->capacity - offset;
+
+            memcpy(l->data + offset, buf, n);
+            atomic_store(&r->tail, tail + n);
+
+            buf += n;
+            left -= n;
+            sent += n;
+        }
+    }
+
+    if (wake_reader(fd, l) == -1 && sent == 0)
+        return -1;
+    return sent;
+}
+
+/* Takes whatever the ring holds, up to `nbytes`, without blocking. */
+static size_t ring_take(ring_link *l, void *buf, size_t nbytes)
+{
+    ring *r = l->ring;
+    size_t const head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t const available = atomic_load_explicit(&r->tail, memory_order_acquire) - head;
+    size_t const offset = head & (l->capacity - 1);
+
+    size_t n = nbytes < available ? nbytes : available;
+    if (n == 0)
+        return 0;
+
+    size_t const first = n < l->capacity - offset ? n : l->capacity - offset;
+    memcpy(buf, l->data + offset, first);
+    memcpy((char *)buf + first, l->data, n - first);
+
+    atomic_store(&r->head, head + n);
+    wake_writer(l);
+    return n;
+}
+
+static ssize_t ring_recv(int fd, ring_link *l, void *buf, size_t nbytes)
+{
+    while (1)
+    {
+        size_t n = ring_take(l, buf, nbytes);
+        if (n > 0)
+            return n;
+
+        atomic_store(&l->ring->reader_awake, 0);
+        n = ring_take(l, buf, nbytes);
+        if (n > 0)
+        {
+            atomic_store(&l->ring->reader_awake, 1);
+            return n;
         }
+
+        char bell;
+        ssize_t const res = read(fd, &bell, 1);
+        if (res == 0)
+            return ring_take(l, buf, nbytes); // The writer has closed its end.
+        if (res < 0)
+            return res;
     }
-    // Defaults to not wait
-    ASSERT_ZERO(pthread_mutex_unlock(&mutex));
 }
 
 int channel(int pipefd[2])
@@ -79,28 +384,209 @@ int channel(int pipefd[2])
     return pipe(pipefd);
 }
 
+size_t chringsize(size_t __capacity)
+{
+    return sizeof(ring) + __capacity;
+}
+
+void chattach(int __fd, void *__ring, size_t __capacity)
+{
+    if (__fd >= links_count)
+    {
+        int const count = __fd + 1 > 2 * links_count ? __fd + 1 : 2 * links_count;
+        ring_link *grown = realloc(links, count * sizeof(ring_link));
+        if (grown == NULL)
+        {
+            perror("chattach");
+            exit(1);
+        }
+        memset(grown + links_count, 0, (count - links_count) * sizeof(ring_link));
+        links = grown;
+        links_count = count;
+    }
+
+    links[__fd] = (ring_link){.ring = __ring, .data = (char *)__ring + sizeof(ring), .capacity = __capacity};
+}
+
+void chlink(int __fd, int __sender, int __receiver)
+{
+    if (write_block_ns == 0 && read_block_ns == 0 && !rules_emulate())
+        return; // Nothing is emulated, transfers need no link to queue on.
+
+    if (__fd >= models_count)
+    {
+        int const count = __fd + 1 > 2 * models_count ? __fd + 1 : 2 * models_count;
+        link_model **grown = realloc(models, count * sizeof(link_model *));
+        if (grown == NULL)
+        {
+            perror("chlink");
+            exit(1);
+        }
+        memset(grown + models_count, 0, (count - models_count) * sizeof(link_model *));
+        models = grown;
+        models_count = count;
+    }
+
+    link_model *m = models[__fd];
+    if (m == NULL)
+    {
+        m = malloc(sizeof(link_model));
+        if (m == NULL)
+        {
+            perror("chlink");
+            exit(1);
+        }
+        ASSERT_ZERO(pthread_mutex_init(&m->mutex, NULL));
+        models[__fd] = m;
+    }
+    m->busy_until = 0;
+
+    link_rule rule = rules[0];
+    for (int i = 1; i < rules_count; i++)
+    {
+        if ((rules[i].sender == ANY_END || rules[i].sender == __sender)
+            && (rules[i].receiver == ANY_END || rules[i].receiver == __receiver))
+            rule = rules[i];
+    }
+    m->latency_ns = rule.latency_ns;
+    m->ns_per_byte = rule.ns_per_byte;
+}
+
+int chclose(int __fd)
+{
+    ring_link *l = find_link(__fd);
+    if (l != NULL)
+    {
+        if ((fcntl(__fd, F_GETFL) & O_ACCMODE) == O_RDONLY)
+        {
+            atomic_store(&l->ring->reader_closed, 1);
+            if (atomic_exchange(&l->ring->writer_waiting, 0))
+                futex(&l->ring->writer_waiting, FUTEX_WAKE, 1, NULL);
+        }
+        l->ring = NULL;
+    }
+    return close(__fd);
+}
+
 void channels_init() {
     signal(SIGPIPE, SIG_IGN);
 
-    pthread_mutexattr_t attr;
-    ASSERT_ZERO(pthread_mutexattr_init(&attr));
-    ASSERT_ZERO(pthread_mutex_init(&mutex, &attr));
-    ASSERT_ZERO(pthread_mutexattr_destroy(&attr));
+    write_block_ns = block_delay_ns(WRITE_VAR);
+    read_block_ns = block_delay_ns(READ_VAR);
+    parse_rules();
 }
 
 void channels_finalize() {
-    ASSERT_ZERO(pthread_mutex_destroy(&mutex));
+    for (int fd = 0; fd < models_count; fd++)
+    {
+        if (models[fd] != NULL)
+        {
+            ASSERT_ZERO(pthread_mutex_destroy(&models[fd]->mutex));
+            free(models[fd]);
+        }
+    }
+    free(models);
+    models = NULL;
+    models_count = 0;
+
+    free(rules);
+    rules = NULL;
+    rules_count = 0;
+
+    free(links);
+    links = NULL;
+    links_count = 0;
 }
 
 int chsend(int __fd, const void *__buf, size_t __n)
 {
-    delay(WRITE_VAR, __n);
+    delay(__fd, __n, true);
+
+    ring_link *l = find_link(__fd);
+    if (l != NULL)
+    {
+        struct iovec const iov = {.iov_base = (void *)__buf, .iov_len = __n};
+        return ring_send(__fd, l, &iov, 1);
+    }
     return write(__fd, __buf, __n);
 }
 
+int chsendv(int __fd, const struct iovec *__iov, int __iovcnt)
+{
+    size_t n = 0;
+    for (int i = 0; i < __iovcnt; i++)
+        n += __iov[i].iov_len;
+
+    delay(__fd, n, true);
+
+    ring_link *l = find_link(__fd);
+    if (l != NULL)
+        return ring_send(__fd, l, __iov, __iovcnt);
+    return writev(__fd, __iov, __iovcnt);
+}
+
 int chrecv(int __fd, void *__buf, size_t __nbytes)
 {
-    ssize_t res = read(__fd, __buf, __nbytes);
-    delay(READ_VAR, __nbytes);
+    ring_link *l = find_link(__fd);
+    ssize_t res = l != NULL ? ring_recv(__fd, l, __buf, __nbytes) : read(__fd, __buf, __nbytes);
+    if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return res; // Nothing was transferred from a non-blocking channel.
+
+    int const saved_errno = errno;
+    delay(__fd, __nbytes, false);
+    errno = saved_errno;
     return res;
 }
+
+int chvmsplice(int __fd, const struct iovec *__iov, int __iovcnt)
+{
+    if (find_link(__fd) != NULL)
+    {
+        errno = EINVAL; // Data of an attached channel does not go through the pipe.
+        return -1;
+    }
+
+    size_t n = 0;
+    for (int i = 0; i < __iovcnt; i++)
+        n += __iov[i].iov_len;
+
+    delay(__fd, n, true);
+    return vmsplice(__fd, __iov, __iovcnt, 0);
+}
+
+#define DRAIN_SPINS 16
+#define DRAIN_MAX_SLEEP_NS 1000000
+
+int chdrain(int __fd, const _Atomic size_t *__written, size_t __until)
+{
+    // A few yields catch a receiver already reading, after them the wait sleeps for longer and longer.
+    long sleep_ns = 10000;
+    for (int spins = 0;; spins++)
+    {
+        // Counted before the pipe is looked at, bytes sent in between only make the count of those read lower.
+        size_t const written = atomic_load(__written);
+        int pending;
+        if (ioctl(__fd, FIONREAD, &pending) == -1)
+            return -1;
+        if (written - (size_t)pending >= __until)
+            return 0;
+
+        struct pollfd pfd = {.fd = __fd, .events = 0};
+        if (poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLERR))
+        {
+            errno = EPIPE; // Nobody is left to read the data.
+            return -1;
+        }
+
+        if (spins < DRAIN_SPINS)
+        {
+            sched_yield();
+            continue;
+        }
+
+        struct timespec const ts = {.tv_sec = 0, .tv_nsec = sleep_ns};
+        nanosleep(&ts, NULL);
+        if (sleep_ns < DRAIN_MAX_SLEEP_NS)
+            sleep_ns *= 2;
+    }
+}
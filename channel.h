@@ -8,7 +8,9 @@ Overview rules to apply:
 */
 #ifndef CHANNEL_H
 #define CHANNEL_H
+#include <stdatomic.h>
 #include <stddef.h>
+#include <sys/uio.h>
 
 /*
 This is required to be called in MIMPI_Init.
@@ -29,8 +31,54 @@ Works similarly to `write`, but possibly takes more time to finish.
 */
 int chsend(int __fd, const void *__buf, size_t __n);
 /*
+Works similarly to `writev`, but possibly takes more time to finish.
+*/
+int chsendv(int __fd, const struct iovec *__iov, int __iovcnt);
+/*
+Works similarly to `vmsplice` without flags, but possibly takes more time to finish.
+Pages of the buffers are only referenced by the channel, so they must not be modified
+until `chdrain` returns. Fails with EINVAL on attached channels' descriptors.
+*/
+int chvmsplice(int __fd, const struct iovec *__iov, int __iovcnt);
+/*
+Waits until the first `__until` bytes sent through the channel's writing descriptor have been read,
+`*__written` being the number of bytes sent so far, advanced once they are in the channel;
+data sent later does not prolong the wait. Polls the pipe, first yielding the CPU and then
+sleeping for up to a millisecond at a time. Fails with EPIPE if the reading end has been closed.
+*/
+int chdrain(int __fd, const _Atomic size_t *__written, size_t __until);
+/*
 Works similarly to `read`, but possibly takes more time to finish.
 */
 int chrecv(int __fd, void *__buf, size_t __nbytes);
+/*
+Labels a channel's descriptor as an end of the link from process `__sender` to process `__receiver`.
+Transfers through labelled descriptors of one link queue behind each other, those of different links
+take their emulated time concurrently; the emulation is set up by the environment:
+- CHANNELS_WRITE_DELAY, CHANNELS_READ_DELAY - milliseconds every 512 B block takes to be sent, received,
+- CHANNELS_LATENCY - microseconds every sent message takes to arrive,
+- CHANNELS_BANDWIDTH - bytes per microsecond (MB/s) links transmit, unlimited if unset,
+- CHANNELS_LINKS - comma separated SENDER-RECEIVER=LATENCY/BANDWIDTH overriding both for some links,
+  `*` matching any process, later entries winning.
+Has to be called before the descriptor is used by more than one thread.
+*/
+void chlink(int __fd, int __sender, int __receiver);
+/*
+Works similarly to `close`; has to be used instead of it on attached channels' descriptors.
+*/
+int chclose(int __fd);
+
+/*
+Returns the number of bytes of shared memory needed by a ring able to hold `__capacity` bytes.
+*/
+size_t chringsize(size_t __capacity);
+/*
+Makes data sent through (or received from) a channel's descriptor travel through
+a single-producer single-consumer ring placed at `__ring` in memory shared by both ends
+(initially zeroed, `chringsize(__capacity)` bytes long, `__capacity` being a power of two).
+Both ends have to attach the same ring. The descriptor itself keeps carrying wake-ups
+and the end-of-file, so closing the writing end still makes `chrecv` return 0.
+*/
+void chattach(int __fd, void *__ring, size_t __capacity);
 
 #endif /* CHANNEL_H */
@@ -0,0 +1,67 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// Small buffers go through recursive doubling, large ones through reduce-scatter and allgather.
+static int const counts[] = {1, 7, 1003, 100003};
+
+static int value(int rank, int i)
+{
+    return (rank * 7 + i * 3) % 23 - 11;
+}
+
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+
+    for (int c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+        int const count = counts[c];
+        int32_t *data = malloc(count * sizeof(int32_t));
+        int32_t *sum = malloc(count * sizeof(int32_t));
+        int32_t *max = malloc(count * sizeof(int32_t));
+        double *doubles = malloc(count * sizeof(double));
+        uint8_t *bytes = malloc(count);
+        assert(data && sum && max && doubles && bytes);
+
+        for (int i = 0; i < count; i++) {
+            data[i] = value(rank, i);
+            doubles[i] = value(rank, i) / 4.0;
+            bytes[i] = value(rank, i);
+        }
+
+        ASSERT_MIMPI_OK(MIMPI_Allreduce_typed(data, sum, count, MIMPI_INT32, MIMPI_SUM));
+        ASSERT_MIMPI_OK(MIMPI_Allreduce_typed(data, max, count, MIMPI_INT32, MIMPI_MAX));
+        ASSERT_MIMPI_OK(MIMPI_Allreduce_typed(doubles, doubles, count, MIMPI_DOUBLE, MIMPI_SUM));
+        ASSERT_MIMPI_OK(MIMPI_Allreduce(bytes, bytes, count, MIMPI_SUM));
+
+        for (int i = 0; i < count; i++) {
+            int32_t expected_sum = 0, expected_max = value(0, i);
+            for (int r = 0; r < world_size; r++) {
+                expected_sum += value(r, i);
+                expected_max = value(r, i) > expected_max ? value(r, i) : expected_max;
+            }
+            test_assert(sum[i] == expected_sum);
+            test_assert(max[i] == expected_max);
+            test_assert(doubles[i] == expected_sum / 4.0);
+            test_assert(bytes[i] == (uint8_t)expected_sum);
+        }
+
+        free(data);
+        free(sum);
+        free(max);
+        free(doubles);
+        free(bytes);
+    }
+
+    MIMPI_Finalize();
+    if (rank == 0)
+        printf("Allreduce OK\n");
+    return test_success();
+}
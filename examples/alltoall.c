@@ -0,0 +1,48 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define COUNT 41
+#define ROUNDS 10
+
+// Every process gets the block meant for it from every other process,
+// also when blocks are too large for pipes to hold them all at once.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const count = argc > 1 ? atoi(argv[1]) : COUNT;
+
+    uint8_t *send = malloc((size_t)count * world_size);
+    uint8_t *recv = malloc((size_t)count * world_size);
+    assert(send != NULL && recv != NULL);
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int to = 0; to < world_size; to++)
+            for (int i = 0; i < count; i++)
+                send[(size_t)to * count + i] = rank * 13 + to * 5 + round + i;
+
+        ASSERT_MIMPI_OK(MIMPI_Alltoall(send, recv, count));
+
+        for (int from = 0; from < world_size; from++)
+            for (int i = 0; i < count; i++)
+                test_assert(recv[(size_t)from * count + i] == (uint8_t)(from * 13 + rank * 5 + round + i));
+
+        if (round % 3 == 0)
+            ASSERT_MIMPI_OK(MIMPI_Barrier());
+    }
+
+    free(send);
+    free(recv);
+
+    MIMPI_Finalize();
+    printf("Alltoall OK\n");
+    return test_success();
+}
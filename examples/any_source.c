@@ -0,0 +1,104 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define COUNT 64
+#define ROUNDS 20
+#define WORK_TAG 3
+#define REPLY_TAG 4
+
+// Workers report to the master, which takes reports in whatever order they come from
+// and replies to their senders. Reports of one worker still arrive in the order sent.
+// Further arguments: "any_tag" makes the master accept reports of any tag,
+// "detect" enables deadlock detection, which must not report the master waiting.
+int main(int argc, char **argv) {
+    bool any_tag = false, detect = false;
+    for (int i = 2; i < argc; i++)
+    {
+        any_tag |= strcmp(argv[i], "any_tag") == 0;
+        detect |= strcmp(argv[i], "detect") == 0;
+    }
+
+    MIMPI_Init(detect);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const count = argc > 1 ? atoi(argv[1]) : COUNT;
+
+    uint8_t *data = malloc(count > 0 ? count : 1);
+    assert(data != NULL);
+
+    if (rank == 0)
+    {
+        int *next_round = calloc(world_size, sizeof(int));
+        assert(next_round != NULL);
+
+        for (int report = 0; report < (world_size - 1) * ROUNDS; report++)
+        {
+            MIMPI_Status status;
+
+            if (report % 2 == 0)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Recv_status(data, count, MIMPI_ANY_SOURCE, any_tag ? MIMPI_ANY_TAG : WORK_TAG, &status));
+            }
+            else
+            {
+                MIMPI_Request request;
+                ASSERT_MIMPI_OK(MIMPI_Irecv(data, count, MIMPI_ANY_SOURCE, any_tag ? MIMPI_ANY_TAG : WORK_TAG, &request));
+                ASSERT_MIMPI_OK(MIMPI_Wait_status(&request, &status));
+            }
+
+            int const worker = status.source;
+            test_assert(worker > 0 && worker < world_size);
+            test_assert(status.tag == (any_tag ? WORK_TAG + worker : WORK_TAG));
+            test_assert(status.count == count);
+
+            for (int i = 0; i < count; i++)
+                test_assert(data[i] == (uint8_t)(worker * 7 + next_round[worker] + i));
+            next_round[worker]++;
+
+            ASSERT_MIMPI_OK(MIMPI_Send(&next_round[worker], sizeof(int), worker, REPLY_TAG));
+        }
+
+        for (int worker = 1; worker < world_size; worker++)
+            test_assert(next_round[worker] == ROUNDS);
+
+        // Nobody is left to send anything.
+        test_assert(MIMPI_Recv(data, count, MIMPI_ANY_SOURCE, MIMPI_ANY_TAG) == MIMPI_ERROR_REMOTE_FINISHED);
+        free(next_round);
+    }
+    else
+    {
+        // Replies are received before the next report is sent, as sends may wait for matching receives.
+        for (int round = 0; round < ROUNDS; round += 2)
+        {
+            int done[2];
+            MIMPI_Request replies[2];
+            for (int reply = 0; reply < 2; reply++)
+                ASSERT_MIMPI_OK(MIMPI_Irecv(&done[reply], sizeof(int), 0, REPLY_TAG, &replies[reply]));
+
+            // Two reports are sent before the first one is acknowledged.
+            for (int report = round; report < round + 2; report++)
+            {
+                for (int i = 0; i < count; i++)
+                    data[i] = rank * 7 + report + i;
+                ASSERT_MIMPI_OK(MIMPI_Send(data, count, 0, any_tag ? WORK_TAG + rank : WORK_TAG));
+            }
+
+            ASSERT_MIMPI_OK(MIMPI_Waitall(2, replies));
+            test_assert(done[0] == round + 1 && done[1] == round + 2);
+        }
+    }
+
+    free(data);
+
+    MIMPI_Finalize();
+    printf("Any source OK\n");
+    return test_success();
+}
@@ -0,0 +1,56 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define MESSAGES 64
+#define LARGEST 300000
+
+static int message_size(int i)
+{
+    return i % 8 == 7 ? LARGEST - i : (i * 997) % 3000 + 1;
+}
+
+// Rank 0 sends everything and finalizes at once, the others receive only later.
+// With MIMPI_SEND_BUFFER set, the messages still queued are written by MIMPI_Finalize
+// in the order they were sent, messages larger than the whole buffer included.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    char *data = malloc(LARGEST);
+    assert(data != NULL);
+
+    if (rank == 0)
+    {
+        for (int i = 0; i < MESSAGES; i++)
+            for (int peer = 1; peer < world_size; peer++)
+            {
+                memset(data, i + peer, message_size(i));
+                ASSERT_MIMPI_OK(MIMPI_Send(data, message_size(i), peer, 1 + i % 3));
+            }
+    }
+    else
+    {
+        usleep(100000);
+        for (int i = 0; i < MESSAGES; i++)
+        {
+            int const size = message_size(i);
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, size, 0, 1 + i % 3));
+            for (int j = 0; j < size; j++)
+                test_assert(data[j] == (char)(i + rank));
+        }
+        printf("Buffered sends OK\n");
+    }
+
+    free(data);
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,80 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define MESSAGES 2000
+#define MAX_COUNT 16
+#define TAGS 5
+#define ROUNDS 50
+
+static int message_count(int i)
+{
+    return 1 + i % MAX_COUNT;
+}
+
+// Many small messages, meant to be coalesced with MIMPI_COALESCE_SIZE, arrive intact and in order,
+// and a process polling with MIMPI_Test never waits for its own kept back messages.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+    uint8_t data[MAX_COUNT];
+
+    if (rank == 0)
+    {
+        for (int peer = 1; peer < world_size; peer++)
+        {
+            for (int i = 0; i < MESSAGES; i++)
+            {
+                for (int j = 0; j < message_count(i); j++)
+                    data[j] = i + j;
+                ASSERT_MIMPI_OK(MIMPI_Send(data, message_count(i), peer, 1 + i % TAGS));
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < MESSAGES; i++)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, message_count(i), 0, 1 + i % TAGS));
+            for (int j = 0; j < message_count(i); j++)
+                test_assert(data[j] == (uint8_t)(i + j));
+        }
+    }
+
+    // Ranks 0 and 1 bounce a byte, waiting for it by polling.
+    if (rank < 2 && world_size > 1)
+    {
+        uint8_t ball = 0;
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            if ((round % 2 == 0) == (rank == 0))
+            {
+                ball++;
+                ASSERT_MIMPI_OK(MIMPI_Send(&ball, 1, 1 - rank, 2));
+                continue;
+            }
+
+            MIMPI_Request request;
+            bool completed = false;
+            ASSERT_MIMPI_OK(MIMPI_Irecv(&ball, 1, 1 - rank, 2, &request));
+            while (!completed)
+                ASSERT_MIMPI_OK(MIMPI_Test(&request, &completed));
+            test_assert(ball == round + 1);
+        }
+    }
+
+    ASSERT_MIMPI_OK(MIMPI_Flush());
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    MIMPI_Finalize();
+    if (rank == 0)
+        printf("Coalescing OK\n");
+    return test_success();
+}
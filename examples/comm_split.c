@@ -0,0 +1,127 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define COUNT 19
+#define ROUNDS 20
+
+// Processes form a grid with rows of `width` processes (4 by default). Collectives run within rows
+// and columns, interleaved with world ones, in groups ordered by key, and in groups split from groups.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const width = argc > 1 ? atoi(argv[1]) : 4;
+    int const row = rank / width, column = rank % width;
+    int const rows = (world_size + width - 1) / width;
+    int const row_size = row < rows - 1 ? width : world_size - (rows - 1) * width;
+    int const column_size = (world_size - column + width - 1) / width;
+
+    MIMPI_Comm row_comm, column_comm, reversed;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, row, column, &row_comm));
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, column, row, &column_comm));
+    // The key reverses the order of ranks.
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, 0, world_size - rank, &reversed));
+
+    test_assert(MIMPI_Comm_rank(row_comm) == column && MIMPI_Comm_size(row_comm) == row_size);
+    test_assert(MIMPI_Comm_rank(column_comm) == row && MIMPI_Comm_size(column_comm) == column_size);
+    test_assert(MIMPI_Comm_rank(reversed) == world_size - 1 - rank && MIMPI_Comm_size(reversed) == world_size);
+    test_assert(MIMPI_Comm_rank(MIMPI_COMM_WORLD) == rank && MIMPI_Comm_size(MIMPI_COMM_WORLD) == world_size);
+    ASSERT_MIMPI_RETCODE(MIMPI_Bcast_comm(NULL, 0, row_size, row_comm), MIMPI_ERROR_NO_SUCH_RANK);
+
+    // Processes of even columns of a row form a group of their own.
+    MIMPI_Comm halves;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(row_comm, column % 2, 0, &halves));
+    test_assert(MIMPI_Comm_rank(halves) == column / 2);
+
+    int32_t values[COUNT], sums[COUNT];
+    uint8_t data[COUNT];
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < COUNT; i++)
+            values[i] = rank * round + i;
+
+        // Sums over the row.
+        ASSERT_MIMPI_OK(MIMPI_Allreduce_comm(values, sums, COUNT, MIMPI_INT32, MIMPI_SUM, row_comm));
+        for (int i = 0; i < COUNT; i++)
+        {
+            int32_t expected = 0;
+            for (int c = 0; c < row_size; c++)
+                expected += (row * width + c) * round + i;
+            test_assert(sums[i] == expected);
+        }
+
+        // Sums over the column, held by its last process.
+        int const root = column_size - 1;
+        ASSERT_MIMPI_OK(MIMPI_Reduce_comm(values, sums, COUNT, MIMPI_INT32, MIMPI_SUM, root, column_comm));
+        if (row == root)
+            for (int i = 0; i < COUNT; i++)
+            {
+                int32_t expected = 0;
+                for (int r = 0; r < column_size; r++)
+                    expected += (r * width + column) * round + i;
+                test_assert(sums[i] == expected);
+            }
+
+        for (int i = 0; i < COUNT; i++)
+            data[i] = rank == world_size - 1 ? round + i : 0;
+        ASSERT_MIMPI_OK(MIMPI_Bcast_comm(data, COUNT, 0, reversed));
+        for (int i = 0; i < COUNT; i++)
+            test_assert(data[i] == (uint8_t)(round + i));
+
+        for (int i = 0; i < COUNT; i++)
+            data[i] = column == round % row_size ? row + round + i : 0;
+        ASSERT_MIMPI_OK(MIMPI_Bcast_comm(data, COUNT, round % row_size, row_comm));
+        for (int i = 0; i < COUNT; i++)
+            test_assert(data[i] == (uint8_t)(row + round + i));
+
+        int block = rank, blocks[64];
+        ASSERT_MIMPI_OK(MIMPI_Allgather_comm(&block, blocks, sizeof(int), column_comm));
+        for (int r = 0; r < column_size; r++)
+            test_assert(blocks[r] == r * width + column);
+
+        ASSERT_MIMPI_OK(MIMPI_Gather_comm(&block, blocks, sizeof(int), 0, halves));
+        if (column / 2 == 0)
+            for (int i = 0; i < MIMPI_Comm_size(halves); i++)
+                test_assert(blocks[i] == row * width + column % 2 + 2 * i);
+
+        int parts[64], part = -1;
+        for (int c = 0; c < row_size; c++)
+            parts[c] = round * 100 + c;
+        ASSERT_MIMPI_OK(MIMPI_Scatter_comm(parts, &part, sizeof(int), 0, row_comm));
+        test_assert(part == round * 100 + column);
+
+        for (int r = 0; r < column_size; r++)
+            parts[r] = rank * 1000 + r;
+        ASSERT_MIMPI_OK(MIMPI_Alltoall_comm(parts, blocks, sizeof(int), column_comm));
+        for (int r = 0; r < column_size; r++)
+            test_assert(blocks[r] == (r * width + column) * 1000 + row);
+
+        ASSERT_MIMPI_OK(MIMPI_Barrier_comm(halves));
+
+        if (round % 4 == 0)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Allreduce_typed(values, sums, COUNT, MIMPI_INT32, MIMPI_SUM));
+            for (int i = 0; i < COUNT; i++)
+                test_assert(sums[i] == round * world_size * (world_size - 1) / 2 + world_size * i);
+            ASSERT_MIMPI_OK(MIMPI_Barrier());
+        }
+    }
+
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&halves));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&reversed));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&column_comm));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&row_comm));
+    test_assert(row_comm == MIMPI_COMM_NULL);
+
+    MIMPI_Finalize();
+    printf("Comm split OK\n");
+    return test_success();
+}
@@ -0,0 +1,100 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// Fills a buffer with data compressing well (repeat = true) or not at all.
+static void fill(char *data, int size, bool repeat, uint32_t seed)
+{
+    uint32_t state = seed | 1;
+    for (int i = 0; i < size; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[i] = repeat ? (char)(i % 61 + seed) : (char)state;
+    }
+}
+
+static void check(char const *data, int size, bool repeat, uint32_t seed)
+{
+    char *expected = malloc(size);
+    assert(expected != NULL);
+    fill(expected, size, repeat, seed);
+    test_assert(memcmp(data, expected, size) == 0);
+    free(expected);
+}
+
+// Payloads compressed on their way (with MIMPI_COMPRESS_THRESHOLD set) arrive intact whether
+// they are received into posted buffers, queued or broadcast.
+// With a second argument of 1, the compressible message has to take fewer bytes than its size.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const rank = MIMPI_World_rank();
+    int const size = argc > 1 ? atoi(argv[1]) : 100000;
+    bool const expect_compressed = argc > 2 && atoi(argv[2]) == 1;
+    char *data = malloc(size), *other = malloc(size);
+    assert(data != NULL && other != NULL);
+    MIMPI_Request sends[2];
+
+    if (rank == 1)
+    {
+        MIMPI_Request request;
+        ASSERT_MIMPI_OK(MIMPI_Irecv(data, size, 0, 1, &request));
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+        ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+        check(data, size, true, 1);
+    }
+    else
+    {
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+    }
+
+    if (rank == 0)
+    {
+        MIMPI_Peer_stats before, after;
+        ASSERT_MIMPI_OK(MIMPI_Get_peer_stats(1, &before));
+        fill(data, size, true, 1);
+        ASSERT_MIMPI_OK(MIMPI_Send(data, size, 1, 1));
+        ASSERT_MIMPI_OK(MIMPI_Get_peer_stats(1, &after));
+        if (expect_compressed)
+            test_assert(after.bytes_sent - before.bytes_sent < (uint64_t)size);
+
+        // Messages above the eager limit are sent only once received, hence the non-blocking sends.
+        fill(data, size, true, 2);
+        ASSERT_MIMPI_OK(MIMPI_Isend(data, size, 1, 2, &sends[0]));
+        fill(other, size, false, 3);
+        ASSERT_MIMPI_OK(MIMPI_Isend(other, size, 1, 3, &sends[1]));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    if (rank == 1)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Recv(data, size, 0, 3));
+        check(data, size, false, 3);
+        ASSERT_MIMPI_OK(MIMPI_Recv(data, size, 0, 2));
+        check(data, size, true, 2);
+    }
+    else if (rank == 0)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Waitall(2, sends));
+    }
+
+    if (rank == 0)
+        fill(data, size, true, 4);
+    ASSERT_MIMPI_OK(MIMPI_Bcast(data, size, 0));
+    check(data, size, true, 4);
+
+    free(data);
+    free(other);
+    MIMPI_Finalize();
+    printf("Compressed messages OK\n");
+    return test_success();
+}
@@ -0,0 +1,52 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define MESSAGES 1000
+#define UNMATCHED 100
+
+// Deadlock detection forgets messages once the receiver has read them and never mistakes
+// a message still on its way for a deadlock, however many messages have been exchanged.
+int main(int argc, char **argv) {
+    MIMPI_Init(true);
+    int const world_rank = MIMPI_World_rank();
+    int const partner_rank = (world_rank / 2 * 2) + 1 - world_rank % 2;
+    int number = 0;
+
+    // A long stream in one direction, answered only when all of it has been received.
+    if (world_rank % 2 == 0)
+    {
+        for (int i = 0; i < MESSAGES; i++)
+            ASSERT_MIMPI_OK(MIMPI_Send(&i, sizeof(int), partner_rank, 1));
+        ASSERT_MIMPI_OK(MIMPI_Recv(&number, sizeof(int), partner_rank, 2));
+        test_assert(number == MESSAGES);
+    }
+    else
+    {
+        for (int i = 0; i < MESSAGES; i++)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(&number, sizeof(int), partner_rank, 1));
+            test_assert(number == i);
+        }
+        number = MESSAGES;
+        ASSERT_MIMPI_OK(MIMPI_Send(&number, sizeof(int), partner_rank, 2));
+    }
+
+    // Messages which are never received do not hide a later deadlock.
+    for (int i = 0; i < UNMATCHED; i++)
+        ASSERT_MIMPI_OK(MIMPI_Send(&i, sizeof(int), partner_rank, 3));
+    ASSERT_MIMPI_RETCODE(MIMPI_Recv(&number, sizeof(int), partner_rank, 4), MIMPI_ERROR_DEADLOCK_DETECTED);
+
+    // Received messages of a matching tag do not count as being on the way either.
+    ASSERT_MIMPI_OK(MIMPI_Recv(&number, sizeof(int), partner_rank, 3));
+    test_assert(number == 0);
+    ASSERT_MIMPI_RETCODE(MIMPI_Recv(&number, sizeof(int), partner_rank, 5), MIMPI_ERROR_DEADLOCK_DETECTED);
+
+    MIMPI_Finalize();
+    return test_success();
+}
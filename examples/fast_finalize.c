@@ -0,0 +1,65 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+static long elapsed_ms(struct timespec const *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+// The last process stays in the MPI block for a while, leaving messages of others unreceived.
+// With MIMPI_FAST_FINALIZE=1 the others leave MIMPI_Finalize without waiting for it.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const linger_ms = argc > 1 ? atoi(argv[1]) : 1000;
+    bool const expect_fast = getenv("MIMPI_FAST_FINALIZE") != NULL && atoi(getenv("MIMPI_FAST_FINALIZE")) == 1;
+    int const last = world_size - 1;
+
+    // Small and large messages nobody receives stay queued until MIMPI_Finalize.
+    static char data[1 << 20];
+    memset(data, rank, sizeof(data));
+    for (int destination = 0; destination < world_size; destination++)
+    {
+        if (destination == rank)
+            continue;
+        for (int i = 0; i < 100; i++)
+            ASSERT_MIMPI_OK(MIMPI_Send(data, 16, destination, 1));
+        ASSERT_MIMPI_OK(MIMPI_Send(data, sizeof(data), destination, 2));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    if (rank == last)
+    {
+        usleep(linger_ms * 1000);
+
+        // The others may be gone already, but every send still completes.
+        for (int destination = 0; destination < last; destination++)
+        {
+            MIMPI_Retcode const ret = MIMPI_Send(data, 16, destination, 3);
+            test_assert((ret == MIMPI_SUCCESS || ret == MIMPI_ERROR_REMOTE_FINISHED));
+        }
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    MIMPI_Finalize();
+
+    if (rank != last && expect_fast)
+        test_assert(elapsed_ms(&start) < linger_ms / 2);
+
+    printf("Finalized\n");
+    return test_success();
+}
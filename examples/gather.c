@@ -0,0 +1,67 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define COUNT 37
+#define ROUNDS 5
+
+// Gathers, scatters and allgathers with every root and a large block size
+// deliver every block to its place in rank order.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const count = argc > 1 ? atoi(argv[1]) : COUNT;
+
+    uint8_t *block = malloc(count);
+    uint8_t *all = malloc((size_t)count * world_size);
+    assert(block != NULL && all != NULL);
+
+    ASSERT_MIMPI_RETCODE(MIMPI_Gather(block, all, count, world_size), MIMPI_ERROR_NO_SUCH_RANK);
+    ASSERT_MIMPI_RETCODE(MIMPI_Scatter(all, block, count, -1), MIMPI_ERROR_NO_SUCH_RANK);
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int root = 0; root < world_size; root++)
+        {
+            for (int i = 0; i < count; i++)
+                block[i] = rank * 31 + round + i;
+
+            ASSERT_MIMPI_OK(MIMPI_Gather(block, all, count, root));
+            if (rank == root)
+                for (int r = 0; r < world_size; r++)
+                    for (int i = 0; i < count; i++)
+                        test_assert(all[(size_t)r * count + i] == (uint8_t)(r * 31 + round + i));
+
+            if (rank == root)
+                for (int r = 0; r < world_size; r++)
+                    for (int i = 0; i < count; i++)
+                        all[(size_t)r * count + i] = r * 17 + root + i;
+
+            ASSERT_MIMPI_OK(MIMPI_Scatter(all, block, count, root));
+            for (int i = 0; i < count; i++)
+                test_assert(block[i] == (uint8_t)(rank * 17 + root + i));
+        }
+
+        for (int i = 0; i < count; i++)
+            block[i] = rank * 7 + round + i;
+
+        ASSERT_MIMPI_OK(MIMPI_Allgather(block, all, count));
+        for (int r = 0; r < world_size; r++)
+            for (int i = 0; i < count; i++)
+                test_assert(all[(size_t)r * count + i] == (uint8_t)(r * 7 + round + i));
+    }
+
+    free(block);
+    free(all);
+
+    MIMPI_Finalize();
+    printf("Gather OK\n");
+    return test_success();
+}
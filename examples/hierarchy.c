@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define SIZE 1000
+#define ROUNDS 3
+#define PASSES_PER_ROUND 6 // Synchronising barrier, broadcast and reduction pass the tree twice each.
+
+// Collectives of processes placed on several nodes (as in MIMPI_NODES) give correct results,
+// while every pass along the tree crosses between nodes once for every node but the root's.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const node_count = argc > 1 ? atoi(argv[1]) : 1;
+
+    int *nodes = malloc(world_size * sizeof(int));
+    assert(nodes != NULL);
+    char const *layout = getenv("MIMPI_NODES");
+    for (int i = 0; i < world_size; i++)
+    {
+        nodes[i] = layout != NULL ? atoi(layout) : 0;
+        layout = layout != NULL && strchr(layout, ',') != NULL ? strchr(layout, ',') + 1 : layout;
+    }
+
+    // mimpirun places the processes on as many nodes as the test expects.
+    int distinct_nodes = 0;
+    for (int i = 0; i < world_size; i++)
+    {
+        bool seen = false;
+        for (int j = 0; j < i; j++)
+            seen = seen || nodes[j] == nodes[i];
+        distinct_nodes += !seen;
+    }
+    test_assert(distinct_nodes == node_count);
+
+    uint8_t data[SIZE], result[SIZE];
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        int const root = (round * 2) % world_size;
+
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+        memset(data, rank == root ? round + 1 : 0, SIZE);
+        ASSERT_MIMPI_OK(MIMPI_Bcast(data, SIZE, root));
+        for (int i = 0; i < SIZE; i++)
+            test_assert(data[i] == round + 1);
+
+        memset(data, rank + 1, SIZE);
+        ASSERT_MIMPI_OK(MIMPI_Reduce(data, result, SIZE, MIMPI_MAX, root));
+        if (rank == root)
+            for (int i = 0; i < SIZE; i++)
+                test_assert(result[i] == world_size);
+    }
+
+#ifdef MIMPI_STATS
+    int crossing = 0;
+    for (int peer = 0; peer < world_size; peer++)
+    {
+        if (peer == rank || nodes[peer] == nodes[rank])
+            continue;
+
+        MIMPI_Peer_stats peer_stats;
+        ASSERT_MIMPI_OK(MIMPI_Get_peer_stats(peer, &peer_stats));
+        crossing += peer_stats.messages_sent;
+    }
+
+    if (rank != 0)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Send(&crossing, sizeof(int), 0, 1));
+    }
+    else
+    {
+        for (int peer = 1; peer < world_size; peer++)
+        {
+            int other;
+            ASSERT_MIMPI_OK(MIMPI_Recv(&other, sizeof(int), peer, 1));
+            crossing += other;
+        }
+        printf("Messages between nodes: %d\n", crossing);
+        test_assert(crossing == ROUNDS * PASSES_PER_ROUND * (node_count - 1));
+    }
+#endif
+
+    free(nodes);
+    MIMPI_Finalize();
+    return test_success();
+}
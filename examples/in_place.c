@@ -0,0 +1,78 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// Reductions with MIMPI_IN_PLACE take the data of a process from its place for the result,
+// which only the result replaces: in the root, or in every process of an allreduce.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const count = argc > 1 ? atoi(argv[1]) : 1000;
+    int const root = argc > 2 ? atoi(argv[2]) : 0;
+    int32_t *data = malloc(count * sizeof(int32_t));
+    assert(data != NULL);
+
+    int32_t sum = 0;
+    for (int r = 0; r < world_size; r++)
+        sum += r + 1;
+
+    for (int i = 0; i < count; i++)
+        data[i] = rank + 1 + i;
+    ASSERT_MIMPI_OK(MIMPI_Reduce_typed(MIMPI_IN_PLACE, data, count, MIMPI_INT32, MIMPI_SUM, root));
+    for (int i = 0; i < count; i++)
+        test_assert(data[i] == (rank == root ? sum + world_size * i : rank + 1 + i));
+
+    // The data of the root reduced in place is also its result.
+    uint8_t bytes[64];
+    for (int i = 0; i < 64; i++)
+        bytes[i] = rank + i;
+    ASSERT_MIMPI_OK(MIMPI_Reduce(bytes, bytes, 64, MIMPI_MAX, root));
+    for (int i = 0; i < 64; i++)
+        test_assert(bytes[i] == (uint8_t)((rank == root ? world_size - 1 : rank) + i));
+
+    for (int i = 0; i < count; i++)
+        data[i] = rank + 1;
+    ASSERT_MIMPI_OK(MIMPI_Allreduce_typed(MIMPI_IN_PLACE, data, count, MIMPI_INT32, MIMPI_SUM));
+    for (int i = 0; i < count; i++)
+        test_assert(data[i] == sum);
+
+    for (int i = 0; i < 64; i++)
+        bytes[i] = rank == i % world_size;
+    ASSERT_MIMPI_OK(MIMPI_Allreduce(MIMPI_IN_PLACE, bytes, 64, MIMPI_SUM));
+    for (int i = 0; i < 64; i++)
+        test_assert(bytes[i] == 1);
+
+    MIMPI_Comm half;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, rank % 2, rank, &half));
+    int32_t value = rank;
+    ASSERT_MIMPI_OK(MIMPI_Reduce_comm(MIMPI_IN_PLACE, &value, 1, MIMPI_INT32, MIMPI_MAX, 0, half));
+    int32_t const largest = (world_size - 1) % 2 == rank % 2 ? world_size - 1 : world_size - 2;
+    test_assert(value == (rank < 2 ? largest : rank));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&half));
+
+    MIMPI_Request planned;
+    ASSERT_MIMPI_OK(MIMPI_Reduce_init(MIMPI_IN_PLACE, data, count, MIMPI_INT32, MIMPI_SUM, root, &planned));
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < count; i++)
+            data[i] = round;
+        ASSERT_MIMPI_OK(MIMPI_Start(&planned));
+        ASSERT_MIMPI_OK(MIMPI_Wait(&planned));
+        for (int i = 0; i < count; i++)
+            test_assert(data[i] == (rank == root ? round * world_size : round));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Request_free(&planned));
+
+    free(data);
+    MIMPI_Finalize();
+    printf("In-place reductions OK\n");
+    return test_success();
+}
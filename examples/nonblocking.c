@@ -0,0 +1,142 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define COUNT 1000
+#define TAGS 8
+#define LARGE 4096
+
+// Receives posted on many processes at once, and out of order on one process, are all matched.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+
+    // Exchange between all pairs, with every receive posted before any send.
+    uint8_t *in = malloc(world_size * COUNT);
+    uint8_t *out = malloc(COUNT);
+    MIMPI_Request *requests = malloc(2 * world_size * sizeof(MIMPI_Request));
+    assert(in && out && requests);
+
+    for (int i = 0; i < COUNT; i++)
+        out[i] = rank + i;
+    for (int peer = 0; peer < world_size; peer++)
+    {
+        requests[peer] = MIMPI_REQUEST_NULL;
+        requests[world_size + peer] = MIMPI_REQUEST_NULL;
+        if (peer == rank)
+            continue;
+        ASSERT_MIMPI_OK(MIMPI_Irecv(in + peer * COUNT, COUNT, peer, 1, &requests[peer]));
+    }
+    for (int peer = 0; peer < world_size; peer++)
+        if (peer != rank)
+            ASSERT_MIMPI_OK(MIMPI_Isend(out, COUNT, peer, 1, &requests[world_size + peer]));
+    ASSERT_MIMPI_OK(MIMPI_Waitall(2 * world_size, requests));
+
+    for (int peer = 0; peer < world_size; peer++)
+    {
+        if (peer == rank)
+            continue;
+        for (int i = 0; i < COUNT; i++)
+            test_assert(in[peer * COUNT + i] == (uint8_t)(peer + i));
+    }
+
+    MIMPI_Request request;
+    test_assert(MIMPI_Irecv(in, COUNT, rank, 1, &request) == MIMPI_ERROR_ATTEMPTED_SELF_OP);
+    test_assert(request == MIMPI_REQUEST_NULL);
+    test_assert(MIMPI_Isend(out, COUNT, world_size, 1, &request) == MIMPI_ERROR_NO_SUCH_RANK);
+    ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+
+    // Rank 0 posts receives for tags in reverse order and polls them, rank 1 sends in order.
+    if (rank == 0 && world_size > 1)
+    {
+        int received[TAGS];
+        MIMPI_Request tagged[TAGS];
+        for (int tag = TAGS; tag >= 1; tag--)
+            ASSERT_MIMPI_OK(MIMPI_Irecv(&received[tag - 1], sizeof(int), 1, tag, &tagged[tag - 1]));
+
+        int pending = TAGS;
+        while (pending > 0)
+        {
+            pending = 0;
+            for (int tag = 1; tag <= TAGS; tag++)
+            {
+                bool completed;
+                ASSERT_MIMPI_OK(MIMPI_Test(&tagged[tag - 1], &completed));
+                if (!completed)
+                    pending++;
+            }
+        }
+        for (int tag = 1; tag <= TAGS; tag++)
+            test_assert(received[tag - 1] == tag * 10);
+
+        // MIMPI_ANY_TAG matches the oldest message.
+        int first, second;
+        ASSERT_MIMPI_OK(MIMPI_Irecv(&first, sizeof(int), 1, MIMPI_ANY_TAG, &tagged[0]));
+        ASSERT_MIMPI_OK(MIMPI_Irecv(&second, sizeof(int), 1, MIMPI_ANY_TAG, &tagged[1]));
+        ASSERT_MIMPI_OK(MIMPI_Waitall(2, tagged));
+        test_assert(first == 1 && second == 2);
+    }
+    else if (rank == 1)
+    {
+        for (int tag = 1; tag <= TAGS; tag++)
+        {
+            int value = tag * 10;
+            ASSERT_MIMPI_OK(MIMPI_Send(&value, sizeof(int), 0, tag));
+        }
+        int first = 1, second = 2;
+        ASSERT_MIMPI_OK(MIMPI_Send(&first, sizeof(int), 0, 5));
+        ASSERT_MIMPI_OK(MIMPI_Send(&second, sizeof(int), 0, 3));
+    }
+
+    // A receive posted before its message arrives matches it with MIMPI_ANY_TAG too.
+    int late = 0;
+    MIMPI_Request late_request = MIMPI_REQUEST_NULL;
+    if (rank == 0 && world_size > 1)
+        ASSERT_MIMPI_OK(MIMPI_Irecv(&late, sizeof(int), 1, MIMPI_ANY_TAG, &late_request));
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+    if (rank == 1)
+    {
+        int value = 7;
+        ASSERT_MIMPI_OK(MIMPI_Send(&value, sizeof(int), 0, 9));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Wait(&late_request));
+    if (rank == 0 && world_size > 1)
+        test_assert(late == 7);
+
+    // Large non-blocking sends are written by a helper thread, later sends do not overtake them.
+    uint8_t *large = malloc(2 * LARGE);
+    assert(large);
+    if (rank == 1)
+    {
+        MIMPI_Request queued;
+        memset(large, 1, LARGE);
+        memset(large + LARGE, 2, LARGE);
+        ASSERT_MIMPI_OK(MIMPI_Isend(large, LARGE, 0, 11, &queued));
+        ASSERT_MIMPI_OK(MIMPI_Send(large + LARGE, LARGE, 0, 11));
+        ASSERT_MIMPI_OK(MIMPI_Wait(&queued));
+    }
+    else if (rank == 0 && world_size > 1)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Recv(large, LARGE, 1, 11));
+        ASSERT_MIMPI_OK(MIMPI_Recv(large + LARGE, LARGE, 1, 11));
+        for (int i = 0; i < LARGE; i++)
+            test_assert(large[i] == 1 && large[LARGE + i] == 2);
+    }
+
+    free(large);
+    free(requests);
+    free(out);
+    free(in);
+    MIMPI_Finalize();
+    if (rank == 0)
+        printf("Non-blocking operations OK\n");
+    return test_success();
+}
@@ -0,0 +1,42 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define ITERATIONS 50
+#define COUNT 300
+
+// Processes racing ahead between relaxed collectives must not mix up their messages.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+
+    for (int it = 0; it < ITERATIONS; it++) {
+        int const root = it % world_size;
+        uint8_t data[COUNT], result[COUNT];
+
+        for (int i = 0; i < COUNT; i++)
+            data[i] = rank + it + i;
+        ASSERT_MIMPI_OK(MIMPI_Reduce_nosync(data, result, COUNT, MIMPI_SUM, root));
+
+        if (rank == root) {
+            for (int i = 0; i < COUNT; i++)
+                test_assert(result[i] == (uint8_t)(world_size * (world_size - 1) / 2 + world_size * (it + i)));
+        }
+
+        ASSERT_MIMPI_OK(MIMPI_Bcast_nosync(result, COUNT, root));
+        for (int i = 0; i < COUNT; i++)
+            test_assert(result[i] == (uint8_t)(world_size * (world_size - 1) / 2 + world_size * (it + i)));
+    }
+
+    MIMPI_Finalize();
+    if (rank == 0)
+        printf("Relaxed collectives OK\n");
+    return test_success();
+}
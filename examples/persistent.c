@@ -0,0 +1,77 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define COUNT 100
+#define ROUNDS 50
+
+// Persistent broadcasts and reductions started many times, with every root and between
+// ordinary group functions, give the same results as the group functions themselves.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+
+    MIMPI_Request request = MIMPI_REQUEST_NULL;
+    ASSERT_MIMPI_RETCODE(MIMPI_Bcast_init(NULL, 0, world_size, &request), MIMPI_ERROR_NO_SUCH_RANK);
+    ASSERT_MIMPI_RETCODE(MIMPI_Reduce_init(NULL, NULL, 0, MIMPI_INT32, MIMPI_SUM, -1, &request), MIMPI_ERROR_NO_SUCH_RANK);
+
+    for (int root = 0; root < world_size; root++)
+    {
+        uint8_t data[COUNT];
+        int32_t values[COUNT], sums[COUNT];
+        MIMPI_Request requests[2];
+
+        ASSERT_MIMPI_OK(MIMPI_Bcast_init(data, COUNT, root, &requests[0]));
+        ASSERT_MIMPI_OK(MIMPI_Reduce_init(values, sums, COUNT, MIMPI_INT32, MIMPI_SUM, root, &requests[1]));
+
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            for (int i = 0; i < COUNT; i++)
+            {
+                data[i] = rank == root ? round + i : 0;
+                values[i] = rank * round + i;
+            }
+
+            ASSERT_MIMPI_OK(MIMPI_Start(&requests[0]));
+            ASSERT_MIMPI_OK(MIMPI_Start(&requests[1]));
+
+            // Started collectives have completed and their requests stay until freed.
+            bool completed = false;
+            ASSERT_MIMPI_OK(MIMPI_Test(&requests[0], &completed));
+            test_assert(completed && requests[0] != MIMPI_REQUEST_NULL);
+            ASSERT_MIMPI_OK(MIMPI_Waitall(2, requests));
+            test_assert(requests[1] != MIMPI_REQUEST_NULL);
+
+            for (int i = 0; i < COUNT; i++)
+            {
+                test_assert(data[i] == (uint8_t)(round + i));
+                if (rank == root)
+                    test_assert(sums[i] == round * world_size * (world_size - 1) / 2 + world_size * i);
+            }
+
+            if (round % 10 == 0)
+                ASSERT_MIMPI_OK(MIMPI_Barrier());
+        }
+
+        ASSERT_MIMPI_OK(MIMPI_Request_free(&requests[0]));
+        ASSERT_MIMPI_OK(MIMPI_Request_free(&requests[1]));
+        test_assert(requests[0] == MIMPI_REQUEST_NULL && requests[1] == MIMPI_REQUEST_NULL);
+    }
+
+    // Reductions in place still combine the data of the root itself.
+    int32_t value = rank + 1;
+    ASSERT_MIMPI_OK(MIMPI_Reduce_typed(&value, &value, 1, MIMPI_INT32, MIMPI_SUM, 0));
+    if (rank == 0)
+        test_assert(value == world_size * (world_size + 1) / 2);
+
+    MIMPI_Finalize();
+    printf("Persistent collectives OK\n");
+    return test_success();
+}
@@ -0,0 +1,60 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define BURST 16
+
+// Every pipe has the capacity given as the argument (in bytes), so a burst
+// of messages filling it is written without waiting for the receiver.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const expected = argc > 1 ? atoi(argv[1]) : 65536;
+
+    for (int peer = 0; peer < world_size; peer++)
+    {
+        if (peer == rank)
+            continue;
+
+        MIMPI_Peer_stats peer_stats;
+        ASSERT_MIMPI_OK(MIMPI_Get_peer_stats(peer, &peer_stats));
+        test_assert(peer_stats.send_pipe_size == (uint64_t)expected);
+        test_assert(peer_stats.recv_pipe_size == (uint64_t)expected);
+    }
+
+    MIMPI_Stats stats;
+    ASSERT_MIMPI_OK(MIMPI_Get_stats(&stats));
+    test_assert((world_size == 1 || stats.min_pipe_size == (uint64_t)expected));
+
+    int const size = expected / BURST - 8;
+    char *data = malloc(size);
+    assert(data != NULL);
+    memset(data, rank, size);
+
+    if (rank == 0 && world_size > 1)
+    {
+        for (int i = 0; i < BURST; i++)
+            ASSERT_MIMPI_OK(MIMPI_Send(data, size, 1, 1));
+    }
+    else if (rank == 1)
+    {
+        for (int i = 0; i < BURST; i++)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, size, 0, 1));
+            test_assert(data[size - 1] == 0);
+        }
+    }
+
+    free(data);
+
+    MIMPI_Finalize();
+    printf("Pipe size OK\n");
+    return test_success();
+}
@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define MAX_LENGTH 1000
+#define RECORDS 30
+#define RECORD_TAG 7
+#define FILTER_TAG 8
+
+static int record_length(int rank, int record, int max_length)
+{
+    return (rank * 31 + record * 97) % max_length + 1;
+}
+
+static uint8_t record_byte(int rank, int record, int i)
+{
+    return rank * 11 + record * 3 + i;
+}
+
+// Workers send records of varying length and the master receives them without knowing
+// their lengths in advance, taking turns at probing, receiving up to a size and polling.
+// Then a message too long for a receive up to a size is passed over for a later short one.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const max_length = argc > 1 ? atoi(argv[1]) : MAX_LENGTH;
+
+    uint8_t *buffer = malloc((size_t)max_length * 4);
+    assert(buffer != NULL);
+
+    if (rank == 0)
+    {
+        int *next_record = calloc(world_size, sizeof(int));
+        assert(next_record != NULL);
+
+        for (int record = 0; record < (world_size - 1) * RECORDS; record++)
+        {
+            MIMPI_Status status;
+            uint8_t *data = buffer;
+
+            if (record % 3 == 0)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Probe(MIMPI_ANY_SOURCE, RECORD_TAG, &status));
+                data = malloc(status.count);
+                assert(data != NULL);
+                ASSERT_MIMPI_OK(MIMPI_Recv(data, status.count, status.source, RECORD_TAG));
+            }
+            else if (record % 3 == 1)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Recv_up_to(buffer, max_length, MIMPI_ANY_SOURCE, RECORD_TAG, &status));
+            }
+            else
+            {
+                bool found = false;
+                while (!found)
+                    ASSERT_MIMPI_OK(MIMPI_Iprobe(MIMPI_ANY_SOURCE, RECORD_TAG, &found, &status));
+                test_assert(status.tag == RECORD_TAG);
+                ASSERT_MIMPI_OK(MIMPI_Recv(buffer, status.count, status.source, status.tag));
+            }
+
+            int const worker = status.source;
+            test_assert(worker > 0 && worker < world_size);
+            test_assert(status.count == record_length(worker, next_record[worker], max_length));
+
+            for (int i = 0; i < status.count; i++)
+                test_assert(data[i] == record_byte(worker, next_record[worker], i));
+            next_record[worker]++;
+
+            if (data != buffer)
+                free(data);
+        }
+
+        for (int worker = 1; worker < world_size; worker++)
+        {
+            MIMPI_Status status;
+
+            test_assert(next_record[worker] == RECORDS);
+
+            ASSERT_MIMPI_OK(MIMPI_Recv_up_to(buffer, max_length, worker, FILTER_TAG, &status));
+            test_assert(status.source == worker && status.tag == FILTER_TAG && status.count == 1);
+            test_assert(buffer[0] == worker);
+
+            ASSERT_MIMPI_OK(MIMPI_Probe(worker, FILTER_TAG, &status));
+            test_assert(status.count == max_length * 4);
+            ASSERT_MIMPI_OK(MIMPI_Recv(buffer, status.count, worker, FILTER_TAG));
+            for (int i = 0; i < status.count; i++)
+                test_assert(buffer[i] == (uint8_t)(worker + i));
+        }
+
+        // Nobody is left to send anything.
+        bool found = true;
+        test_assert(MIMPI_Probe(MIMPI_ANY_SOURCE, MIMPI_ANY_TAG, NULL) == MIMPI_ERROR_REMOTE_FINISHED);
+        test_assert(MIMPI_Iprobe(1, MIMPI_ANY_TAG, &found, NULL) == MIMPI_ERROR_REMOTE_FINISHED && !found);
+        free(next_record);
+    }
+    else
+    {
+        for (int record = 0; record < RECORDS; record++)
+        {
+            int const length = record_length(rank, record, max_length);
+            for (int i = 0; i < length; i++)
+                buffer[i] = record_byte(rank, record, i);
+            ASSERT_MIMPI_OK(MIMPI_Send(buffer, length, 0, RECORD_TAG));
+        }
+
+        // The long message may have to wait until the short one has been received.
+        for (int i = 0; i < max_length * 4; i++)
+            buffer[i] = rank + i;
+        MIMPI_Request request;
+        ASSERT_MIMPI_OK(MIMPI_Isend(buffer, max_length * 4, 0, FILTER_TAG, &request));
+
+        uint8_t const small = rank;
+        ASSERT_MIMPI_OK(MIMPI_Send(&small, 1, 0, FILTER_TAG));
+        ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+    }
+
+    free(buffer);
+
+    MIMPI_Finalize();
+    printf("Probe OK\n");
+    return test_success();
+}
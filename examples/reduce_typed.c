@@ -0,0 +1,67 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// Not a multiple of any vector width, so that scalar tails get exercised too.
+#define COUNT 1003
+
+// Values in [-11, 11] for MAX, MIN and SUM, and in {-1, 0, 1} for PROD, so that results are exact in every type.
+static int value(int rank, int i, MIMPI_Op op)
+{
+    if (op == MIMPI_PROD)
+        return (rank + i) % 3 - 1;
+    return (rank * 7 + i * 3) % 23 - 11;
+}
+
+#define CHECK_REDUCE(type, datatype)                                                            \
+    do {                                                                                        \
+        for (MIMPI_Op op = MIMPI_MAX; op <= MIMPI_PROD; op++) {                                 \
+            type data[COUNT], result[COUNT];                                                    \
+            for (int i = 0; i < COUNT; i++) {                                                   \
+                data[i] = (type)value(rank, i, op);                                             \
+                result[i] = 0;                                                                  \
+            }                                                                                   \
+            ASSERT_MIMPI_OK(MIMPI_Reduce_typed(data, result, COUNT, datatype, op, root));       \
+            if (rank != root)                                                                   \
+                continue;                                                                       \
+            for (int i = 0; i < COUNT; i++) {                                                   \
+                type expected = (type)value(0, i, op);                                          \
+                for (int r = 1; r < world_size; r++) {                                          \
+                    type const v = (type)value(r, i, op);                                       \
+                    if (op == MIMPI_MAX)                                                        \
+                        expected = v > expected ? v : expected;                                 \
+                    else if (op == MIMPI_MIN)                                                   \
+                        expected = v < expected ? v : expected;                                 \
+                    else if (op == MIMPI_SUM)                                                   \
+                        expected = (type)(expected + v);                                        \
+                    else                                                                        \
+                        expected = (type)(expected * v);                                        \
+                }                                                                               \
+                test_assert(result[i] == expected);                                             \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+int main(int argc, char **argv) {
+    int root = atoi(argv[1]);
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+
+    CHECK_REDUCE(uint8_t, MIMPI_UINT8);
+    CHECK_REDUCE(int32_t, MIMPI_INT32);
+    CHECK_REDUCE(int64_t, MIMPI_INT64);
+    CHECK_REDUCE(float, MIMPI_FLOAT);
+    CHECK_REDUCE(double, MIMPI_DOUBLE);
+
+    MIMPI_Finalize();
+    if (rank == root)
+        printf("Typed reductions OK\n");
+    return test_success();
+}
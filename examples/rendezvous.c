@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define SMALL 100
+#define LARGE (1 << 20)
+#define TAGS 4
+
+static void fill(uint8_t *data, int count, int seed)
+{
+    for (int i = 0; i < count; i++)
+        data[i] = seed + i;
+}
+
+static void check(uint8_t const *data, int count, int seed)
+{
+    for (int i = 0; i < count; i++)
+        test_assert(data[i] == (uint8_t)(seed + i));
+}
+
+// Large messages, meant to exceed MIMPI_EAGER_LIMIT, are received in any order, mixed with small ones
+// and exchanged between all pairs at once.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+
+    uint8_t *data = malloc((size_t)TAGS * LARGE);
+    uint8_t *small = malloc(SMALL);
+    assert(data && small);
+
+    // Rank 1 receives the large messages in reverse order, each after the small message sent behind it.
+    if (rank == 0)
+    {
+        MIMPI_Request requests[2 * TAGS];
+        for (int tag = 1; tag <= TAGS; tag++)
+        {
+            fill(data + (tag - 1) * LARGE, LARGE, tag);
+            fill(small + tag, 1, tag);
+            ASSERT_MIMPI_OK(MIMPI_Isend(data + (tag - 1) * LARGE, LARGE, 1, tag, &requests[tag - 1]));
+            ASSERT_MIMPI_OK(MIMPI_Isend(small + tag, 1, 1, tag, &requests[TAGS + tag - 1]));
+        }
+        ASSERT_MIMPI_OK(MIMPI_Waitall(2 * TAGS, requests));
+    }
+    else if (rank == 1)
+    {
+        for (int tag = TAGS; tag >= 1; tag--)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(small, 1, 0, tag));
+            check(small, 1, tag);
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, LARGE, 0, tag));
+            check(data, LARGE, tag);
+        }
+    }
+
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    // Every process sends a large message to every other one, waiting for its receives first.
+    uint8_t *in = malloc((size_t)world_size * LARGE);
+    MIMPI_Request *requests = malloc(2 * world_size * sizeof(MIMPI_Request));
+    assert(in && requests);
+
+    fill(data, LARGE, rank);
+    for (int peer = 0; peer < world_size; peer++)
+    {
+        requests[peer] = MIMPI_REQUEST_NULL;
+        requests[world_size + peer] = MIMPI_REQUEST_NULL;
+        if (peer == rank)
+            continue;
+        ASSERT_MIMPI_OK(MIMPI_Irecv(in + (size_t)peer * LARGE, LARGE, peer, MIMPI_ANY_TAG, &requests[peer]));
+        ASSERT_MIMPI_OK(MIMPI_Isend(data, LARGE, peer, 2, &requests[world_size + peer]));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Waitall(2 * world_size, requests));
+
+    for (int peer = 0; peer < world_size; peer++)
+        if (peer != rank)
+            check(in + (size_t)peer * LARGE, LARGE, peer);
+
+    // Blocking sends return before their data is written, the buffer can be reused at once,
+    // and large messages nobody receives do not keep processes finalizing together from leaving.
+    fill(data, LARGE, rank);
+    ASSERT_MIMPI_OK(MIMPI_Send(data, LARGE, (rank + 1) % world_size, 3));
+    fill(data, LARGE, rank + 1);
+    ASSERT_MIMPI_OK(MIMPI_Send(data, LARGE, (rank + 1) % world_size, 4));
+    ASSERT_MIMPI_OK(MIMPI_Recv(in, LARGE, (rank + world_size - 1) % world_size, 3));
+    check(in, LARGE, (rank + world_size - 1) % world_size);
+
+    free(requests);
+    free(in);
+    free(small);
+    free(data);
+    MIMPI_Finalize();
+    if (rank == 0)
+        printf("Rendezvous OK\n");
+    return test_success();
+}
@@ -0,0 +1,69 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// Prefix reductions: every process gets the reduction of the data of processes of lower ranks,
+// together with its own for an inclusive scan.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const count = argc > 1 ? atoi(argv[1]) : 1000;
+    int64_t *data = malloc(count * sizeof(int64_t));
+    int64_t *result = malloc(count * sizeof(int64_t));
+    assert(data != NULL && result != NULL);
+
+    for (int i = 0; i < count; i++)
+        data[i] = rank + 1 + i;
+
+    ASSERT_MIMPI_OK(MIMPI_Scan(data, result, count, MIMPI_INT64, MIMPI_SUM));
+    for (int i = 0; i < count; i++)
+        test_assert(result[i] == (int64_t)(rank + 1) * (rank + 2) / 2 + (int64_t)(rank + 1) * i);
+
+    for (int i = 0; i < count; i++)
+        result[i] = -1;
+    ASSERT_MIMPI_OK(MIMPI_Exscan(data, result, count, MIMPI_INT64, MIMPI_SUM));
+    for (int i = 0; i < count; i++)
+        test_assert(result[i] == (rank == 0 ? -1 : (int64_t)rank * (rank + 1) / 2 + (int64_t)rank * i));
+
+    // Offsets of blocks of different sizes, as for parallel output.
+    int32_t size = 3 * rank + 1;
+    int32_t offset = size;
+    ASSERT_MIMPI_OK(MIMPI_Exscan(MIMPI_IN_PLACE, &offset, 1, MIMPI_INT32, MIMPI_SUM));
+    if (rank > 0)
+        test_assert(offset == 3 * rank * (rank - 1) / 2 + rank);
+
+    double value = rank % 3 == 0 ? rank : -rank;
+    ASSERT_MIMPI_OK(MIMPI_Scan(MIMPI_IN_PLACE, &value, 1, MIMPI_DOUBLE, MIMPI_MAX));
+    test_assert(value == (double)(rank / 3 * 3));
+
+    uint8_t bytes[16];
+    for (int i = 0; i < 16; i++)
+        bytes[i] = rank == i % world_size ? 2 : 1;
+    ASSERT_MIMPI_OK(MIMPI_Scan(MIMPI_IN_PLACE, bytes, 16, MIMPI_UINT8, MIMPI_PROD));
+    for (int i = 0; i < 16; i++)
+        test_assert(bytes[i] == (i % world_size <= rank ? 2 : 1));
+
+    MIMPI_Comm half;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, rank % 2, world_size - rank, &half));
+    int32_t smallest = rank;
+    ASSERT_MIMPI_OK(MIMPI_Scan_comm(MIMPI_IN_PLACE, &smallest, 1, MIMPI_INT32, MIMPI_MIN, half));
+    test_assert(smallest == rank);
+    int32_t largest = -1;
+    ASSERT_MIMPI_OK(MIMPI_Exscan_comm(&rank, &largest, 1, MIMPI_INT32, MIMPI_MAX, half));
+    test_assert(largest == (rank + 2 < world_size ? (world_size - 1 - rank) / 2 * 2 + rank : -1));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&half));
+
+    free(data);
+    free(result);
+    MIMPI_Finalize();
+    printf("Scans OK\n");
+    return test_success();
+}
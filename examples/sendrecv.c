@@ -0,0 +1,54 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// Every rank exchanges data with both neighbours on a ring, and then with its partner
+// of a pairing, without ordering the exchanges by hand. With messages above
+// MIMPI_EAGER_LIMIT, sends followed by receives would wait for each other forever.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const size = argc > 1 ? atoi(argv[1]) : 100000;
+    char *out = malloc(size), *in = malloc(size);
+    assert(out != NULL && in != NULL);
+
+    int const right = (rank + 1) % world_size;
+    int const left = (rank - 1 + world_size) % world_size;
+    MIMPI_Status status;
+
+    memset(out, rank, size);
+    ASSERT_MIMPI_OK(MIMPI_Sendrecv(out, size, right, 1, in, size, left, 1, &status));
+    test_assert(status.source == left && status.tag == 1 && status.count == size);
+    for (int i = 0; i < size; i++)
+        test_assert(in[i] == (char)left);
+
+    ASSERT_MIMPI_OK(MIMPI_Sendrecv(out, size, left, 2, in, size, MIMPI_ANY_SOURCE, 2, &status));
+    test_assert(status.source == right && status.count == size);
+    for (int i = 0; i < size; i++)
+        test_assert(in[i] == (char)right);
+
+    int const partner = rank ^ 1;
+    if (partner < world_size)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Sendrecv(out, size, partner, 3, in, size, partner, 3, NULL));
+        for (int i = 0; i < size; i++)
+            test_assert(in[i] == (char)partner);
+    }
+
+    test_assert(MIMPI_Sendrecv(out, 1, rank, 4, in, 1, left, 4, NULL) == MIMPI_ERROR_ATTEMPTED_SELF_OP);
+    test_assert(MIMPI_Sendrecv(out, 1, right, 4, in, 1, world_size, 4, NULL) == MIMPI_ERROR_NO_SUCH_RANK);
+
+    free(out);
+    free(in);
+    MIMPI_Finalize();
+    printf("Exchanges OK\n");
+    return test_success();
+}
@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define MESSAGES 50
+#define SIZE 100
+
+// Counters of MIMPI_Get_stats and MIMPI_Get_peer_stats follow the traffic of the process,
+// or stay zero when the library is built without MIMPI_STATS.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    char data[SIZE];
+    memset(data, rank, SIZE);
+
+    MIMPI_Peer_stats peer_stats;
+    ASSERT_MIMPI_RETCODE(MIMPI_Get_peer_stats(rank, &peer_stats), MIMPI_ERROR_ATTEMPTED_SELF_OP);
+    ASSERT_MIMPI_RETCODE(MIMPI_Get_peer_stats(world_size, &peer_stats), MIMPI_ERROR_NO_SUCH_RANK);
+
+    if (rank == 0)
+    {
+        for (int peer = 1; peer < world_size; peer++)
+            for (int i = 0; i < MESSAGES; i++)
+                ASSERT_MIMPI_OK(MIMPI_Send(data, SIZE, peer, 1));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    if (rank != 0)
+    {
+        for (int i = 0; i < MESSAGES; i++)
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, SIZE, 0, 1));
+
+        // Rank 0 answers only after a while, so that waiting for it takes time.
+        ASSERT_MIMPI_OK(MIMPI_Send(data, 1, 0, 2));
+        ASSERT_MIMPI_OK(MIMPI_Recv(data, 1, 0, 3));
+    }
+    else
+    {
+        for (int peer = 1; peer < world_size; peer++)
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, 1, peer, 2));
+        usleep(20000);
+        for (int peer = 1; peer < world_size; peer++)
+            ASSERT_MIMPI_OK(MIMPI_Send(data, 1, peer, 3));
+    }
+
+    MIMPI_Stats stats;
+    ASSERT_MIMPI_OK(MIMPI_Get_stats(&stats));
+
+#ifdef MIMPI_STATS
+    if (rank != 0)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Get_peer_stats(0, &peer_stats));
+        test_assert(peer_stats.messages_received >= MESSAGES + 1);
+        test_assert(peer_stats.bytes_received >= MESSAGES * SIZE + 1);
+        // All messages arrived during the barrier, before any receive was posted.
+        test_assert(peer_stats.unexpected_high_water >= MESSAGES);
+        test_assert(peer_stats.messages_sent >= 1);
+        test_assert(stats.recv_wait_ns >= 10000000);
+    }
+    else
+    {
+        test_assert(stats.messages_sent >= (uint64_t)(world_size - 1) * (MESSAGES + 1));
+        test_assert(stats.bytes_sent >= (uint64_t)(world_size - 1) * MESSAGES * SIZE);
+    }
+    test_assert(stats.send_calls > 0);
+    test_assert(stats.recv_calls > 0);
+    test_assert(stats.control_sent == 0 && stats.control_received == 0);
+#else
+    test_assert(stats.messages_sent == 0 && stats.messages_received == 0 && stats.recv_wait_ns == 0);
+#endif
+
+    MIMPI_Finalize();
+    return test_success();
+}
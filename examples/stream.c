@@ -0,0 +1,94 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define LENGTH ((5 << 20) + 123)
+#define STREAMS 2
+#define STREAM_TAG 9
+
+typedef struct {
+    long long position;
+    long long length;
+    int calls;
+} generator;
+
+static uint8_t stream_byte(int stream, long long position)
+{
+    return (uint8_t)(position * 7 + position / 4096 + stream);
+}
+
+// Produces chunks of varying size, never filling the whole capacity on every other call.
+static int produce(void *context, void *chunk, int capacity)
+{
+    generator *g = context;
+    long long left = g->length - g->position;
+    int count = (g->calls++ % 2 == 0) ? capacity : capacity / 3 + 1;
+
+    if (count > left)
+        count = (int)left;
+    for (int i = 0; i < count; i++)
+        ((uint8_t *)chunk)[i] = stream_byte(0, g->position + i);
+    g->position += count;
+    return count;
+}
+
+static void consume(void *context, void const *chunk, int count)
+{
+    generator *g = context;
+
+    test_assert(count > 0);
+    for (int i = 0; i < count; i++)
+        test_assert(((uint8_t const *)chunk)[i] == stream_byte(0, g->position + i));
+    g->position += count;
+    g->calls++;
+}
+
+// Pairs of processes pass streams, neither side knowing in advance how they are chunked,
+// then exchange a plain message on the tag of the streams.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    long long const length = argc > 1 ? atoll(argv[1]) : LENGTH;
+    int const partner = rank ^ 1;
+
+    if (partner < world_size)
+    {
+        for (int stream = 0; stream < STREAMS; stream++)
+        {
+            generator g = {.position = 0, .length = length, .calls = 0};
+
+            if (rank % 2 == 0)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Send_stream(produce, &g, partner, STREAM_TAG));
+                test_assert(g.position == length);
+            }
+            else
+            {
+                ASSERT_MIMPI_OK(MIMPI_Recv_stream(consume, &g, partner, STREAM_TAG));
+                test_assert(g.position == length);
+            }
+        }
+
+        int value = rank;
+        if (rank % 2 == 0)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(&value, sizeof(int), partner, STREAM_TAG));
+            test_assert(value == partner);
+        }
+        else
+        {
+            ASSERT_MIMPI_OK(MIMPI_Send(&value, sizeof(int), partner, STREAM_TAG));
+        }
+    }
+
+    MIMPI_Finalize();
+    printf("Stream OK\n");
+    return test_success();
+}
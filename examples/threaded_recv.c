@@ -0,0 +1,100 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+#define ITERATIONS 200
+#define COUNT 5000
+#define THREADS_PER_SOURCE 2
+
+typedef struct {
+    int source;
+    int tag;
+} receiver_args;
+
+// Receives every message of its tag from its source and checks its contents.
+static void *receiver(void *arg)
+{
+    receiver_args const *args = arg;
+    uint8_t *data = malloc(COUNT);
+    assert(data);
+
+    for (int it = 0; it < ITERATIONS; it++)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Recv(data, COUNT, args->source, args->tag));
+        for (int i = 0; i < COUNT; i++)
+            test_assert(data[i] == (uint8_t)(args->source + args->tag + it + i));
+    }
+
+    free(data);
+    return NULL;
+}
+
+typedef struct {
+    int tag;
+} sender_args;
+
+// Sends every message of its tag to rank 0.
+static void *sender(void *arg)
+{
+    sender_args const *args = arg;
+    int const rank = MIMPI_World_rank();
+    uint8_t *data = malloc(COUNT);
+    assert(data);
+
+    for (int it = 0; it < ITERATIONS; it++)
+    {
+        for (int i = 0; i < COUNT; i++)
+            data[i] = rank + args->tag + it + i;
+        ASSERT_MIMPI_OK(MIMPI_Send(data, COUNT, 0, args->tag));
+    }
+
+    free(data);
+    return NULL;
+}
+
+// Rank 0 receives from every other process in several threads at once, each with its own tag.
+// The other processes send from one thread per tag.
+int main(int argc, char **argv) {
+    MIMPI_Init(false);
+    int world_size = MIMPI_World_size();
+    int rank = MIMPI_World_rank();
+
+    int const threads = rank == 0 ? (world_size - 1) * THREADS_PER_SOURCE : THREADS_PER_SOURCE;
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    receiver_args *receivers = malloc(threads * sizeof(receiver_args));
+    sender_args *senders = malloc(threads * sizeof(sender_args));
+    assert(ids && receivers && senders);
+
+    for (int t = 0; t < threads; t++)
+    {
+        if (rank == 0)
+        {
+            receivers[t] = (receiver_args){.source = 1 + t / THREADS_PER_SOURCE, .tag = 1 + t % THREADS_PER_SOURCE};
+            test_assert(pthread_create(&ids[t], NULL, receiver, &receivers[t]) == 0);
+        }
+        else
+        {
+            senders[t] = (sender_args){.tag = 1 + t};
+            test_assert(pthread_create(&ids[t], NULL, sender, &senders[t]) == 0);
+        }
+    }
+    for (int t = 0; t < threads; t++)
+        test_assert(pthread_join(ids[t], NULL) == 0);
+
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+    free(senders);
+    free(receivers);
+    free(ids);
+    MIMPI_Finalize();
+    if (rank == 0)
+        printf("Threaded receives OK\n");
+    return test_success();
+}
@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "../mimpi.h"
+#include "mimpi_err.h"
+
+// One-sided windows: processes write, read and accumulate into segments of others,
+// which take part only in fences.
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_size = MIMPI_World_size();
+    int const rank = MIMPI_World_rank();
+    int const count = argc > 1 ? atoi(argv[1]) : 1000;
+    int const updates = argc > 2 ? atoi(argv[2]) : 100;
+
+    // Segments of different sizes, the last element of every one counts accumulates.
+    int const length = count + rank;
+    int64_t *segment;
+    MIMPI_Win win;
+    ASSERT_MIMPI_OK(MIMPI_Win_create((length + 1) * sizeof(int64_t), MIMPI_COMM_WORLD, (void **)&segment, &win));
+    for (int i = 0; i <= length; i++)
+        segment[i] = 0;
+    ASSERT_MIMPI_OK(MIMPI_Win_fence(win));
+
+    int const next = (rank + 1) % world_size;
+    int64_t *data = malloc((count + world_size) * sizeof(int64_t));
+    assert(data != NULL);
+    for (int i = 0; i < count + next; i++)
+        data[i] = rank * 1000000 + i;
+    ASSERT_MIMPI_OK(MIMPI_Put(data, (count + next) * sizeof(int64_t), next, 0, win));
+
+    int64_t const one = 1;
+    for (int i = 0; i < updates; i++)
+    {
+        for (int target = 0; target < world_size; target++)
+        {
+            int const last = (count + target) * sizeof(int64_t);
+            ASSERT_MIMPI_OK(MIMPI_Accumulate(&one, 1, MIMPI_INT64, MIMPI_SUM, target, last, win));
+        }
+    }
+    ASSERT_MIMPI_OK(MIMPI_Win_fence(win));
+
+    int const previous = (rank + world_size - 1) % world_size;
+    for (int i = 0; i < length; i++)
+        test_assert(segment[i] == previous * 1000000 + i);
+    test_assert(segment[length] == (int64_t)world_size * updates);
+
+    int64_t read[2];
+    ASSERT_MIMPI_OK(MIMPI_Get(read, sizeof(read), next, (count + next - 1) * sizeof(int64_t), win));
+    test_assert(read[0] == rank * 1000000 + count + next - 1);
+    test_assert(read[1] == (int64_t)world_size * updates);
+
+    test_assert(MIMPI_Put(data, 1, world_size, 0, win) == MIMPI_ERROR_NO_SUCH_RANK);
+    ASSERT_MIMPI_OK(MIMPI_Win_fence(win));
+    ASSERT_MIMPI_OK(MIMPI_Win_free(&win));
+    test_assert(win == MIMPI_WIN_NULL);
+
+    // A window of a group, with the largest value of every pair kept by maximum accumulates.
+    MIMPI_Comm pair;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, rank / 2, rank, &pair));
+    double *largest;
+    ASSERT_MIMPI_OK(MIMPI_Win_create(sizeof(double), pair, (void **)&largest, &win));
+    *largest = -1;
+    ASSERT_MIMPI_OK(MIMPI_Win_fence(win));
+    double const value = rank;
+    for (int target = 0; target < MIMPI_Comm_size(pair); target++)
+        ASSERT_MIMPI_OK(MIMPI_Accumulate(&value, 1, MIMPI_DOUBLE, MIMPI_MAX, target, 0, win));
+    ASSERT_MIMPI_OK(MIMPI_Win_fence(win));
+    test_assert(*largest == (rank / 2 * 2 + 1 < world_size ? rank / 2 * 2 + 1 : rank));
+    ASSERT_MIMPI_OK(MIMPI_Win_free(&win));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&pair));
+
+    free(data);
+    MIMPI_Finalize();
+    printf("Windows OK\n");
+    return test_success();
+}
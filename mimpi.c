@@ -2,9 +2,27 @@
  * This file is for implementation of MIMPI library.
  * */
 
+#define _GNU_SOURCE
+
 #include "mimpi.h"
 #include "mimpi_common.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef MIMPI_COMPRESSION
+#include <zlib.h>
+#endif
+
 
 /* Return MIMPI_ERROR_NO_SUCH_RANK if rank passed as an argument is not correct. */
 #define CHECK_RANK_ERROR(rank)                                                  \
@@ -16,6 +34,15 @@
     } while (0)
 
 
+/* Return MIMPI_ERROR_NO_SUCH_RANK if rank passed as an argument is not a rank in the group. */
+#define CHECK_GROUP_RANK_ERROR(comm, rank)                                      \
+    do {                                                                        \
+        if ((rank) < 0 || (rank) >= (comm)->size) {                             \
+            return MIMPI_ERROR_NO_SUCH_RANK;                                    \
+        }                                                                       \
+    } while (0)
+
+
 /* Return MIMPI_ERROR_ATTEMPTED_SELF_OP if process calls function on itself. */
 #define CHECK_SELF_OP_ERROR(rank)                                               \
     do {                                                                        \
@@ -34,11 +61,199 @@
     } while(0)                                                                  \
 
 
-/* Maximum world size. */
-#define MAXSIZE 16
+/* Hooks of communication statistics, compiled out unless MIMPI_STATS is defined. */
+#ifdef MIMPI_STATS
+#define STATS_ADD(counter, n) atomic_fetch_add_explicit(&(counter), (n), memory_order_relaxed)
+#define STATS_MAX(counter, n)                                                   \
+    do {                                                                        \
+        if ((uint64_t)(n) > atomic_load_explicit(&(counter), memory_order_relaxed)) \
+            atomic_store_explicit(&(counter), (n), memory_order_relaxed);       \
+    } while (0)
+#define STATS_CLOCK(var) const uint64_t var = monotonic_clock()
+#define STATS_SINCE(counter, var) STATS_ADD(counter, monotonic_clock() - (var))
+#else
+#define STATS_ADD(counter, n) ((void)0)
+#define STATS_MAX(counter, n) ((void)0)
+#define STATS_CLOCK(var) ((void)0)
+#define STATS_SINCE(counter, var) ((void)0)
+#endif
+
+
+/* Environment variable with the directory statistics of each process are written to by MIMPI_Finalize. */
+#define STATS_OUTPUT_VAR "MIMPI_STATS_OUTPUT"
+
+
+/* Environment variable selecting the algorithm of MIMPI_Barrier: "binomial", "dissemination" or "kary:K". */
+#define BARRIER_ALGORITHM_VAR "MIMPI_BARRIER_ALGORITHM"
+
+
+/* Environment variable with the number of events kept per thread by the tracer. */
+#define TRACE_EVENTS_VAR "MIMPI_TRACE_EVENTS"
+
+
+/* Default number of events kept per thread by the tracer, the oldest ones are overwritten. */
+#define TRACE_DEFAULT_EVENTS 65536
+
+
+/* Version of the wire format, in the upper half of the first byte of every frame. */
+#define FRAME_VERSION 1
+
+
+/* Kinds of frames, in the lower half of the first byte of every frame. */
+typedef enum {
+    FRAME_DATA,             // Data of a user message or of a collective, under the tag of the header.
+    FRAME_DEADLOCK,         // Report of a deadlock of the receive last reported waiting.
+    FRAME_WAITING,          // Report of a receive waiting for the message of the header, with the number of messages read.
+    FRAME_RECEIVED,         // Number of messages read, in the value.
+    FRAME_REQUEST_TO_SEND,  // Announcement of the message of the header, with its ticket.
+    FRAME_CLEAR_TO_SEND,    // Ticket of an announced message the receiver is ready for.
+    FRAME_RENDEZVOUS_DATA,  // Data of an announced message, with its ticket.
+    FRAME_STREAM_CREDIT,    // Credit for the next chunk of the stream whose tag is the count of the header.
+    FRAME_CLEARS_DONE,      // Notice that the sender clears no more announced messages, it is finalizing.
+    FRAME_KINDS,
+} frame_kind;
+
+
+/* The frame carries `count` bytes of payload after its header. */
+#define FRAME_PAYLOAD 0x1
+
+/* The header is followed by a value, the ticket or the number of messages the kind of the frame needs. */
+#define FRAME_VALUE 0x2
+
+/* The payload is compressed with zlib into `packed` bytes, which follow the value (the flag implies FRAME_VALUE). */
+#define FRAME_COMPRESSED 0x4
+
+
+/* Header opening every frame on a channel. */
+typedef struct frame_header {
+    uint8_t version_kind;   // FRAME_VERSION in the upper half, the kind of the frame in the lower one.
+    uint8_t flags;          // FRAME_* flags.
+    uint16_t reserved;      // Zero, room for later fields.
+    int32_t tag;            // Tag of the message carried, announced or waited for.
+    int32_t count;          // Number of bytes of the message carried, announced or waited for.
+    uint32_t value;         // Present only with FRAME_VALUE.
+    uint32_t packed;        // Number of payload bytes on the channel, present only with FRAME_COMPRESSED.
+} frame_header;
+
+
+/* Size of the part of the header every frame has. */
+#define FRAME_HEADER_SIZE offsetof(frame_header, value)
+
+
+/* Environment variable with the size (in bytes) from which payloads are compressed, 0 (default) disables it. */
+#define COMPRESS_THRESHOLD_VAR "MIMPI_COMPRESS_THRESHOLD"
+
+
+/* Environment variable selecting how incoming channels are served: "threads" or "epoll". */
+#define PROGRESS_ENGINE_VAR "MIMPI_PROGRESS_ENGINE"
+
+
+/* Environment variable with the size (in bytes) of segments MIMPI_Bcast pipelines data in, 0 disables it. */
+#define BCAST_SEGMENT_VAR "MIMPI_BCAST_SEGMENT"
+
+
+/* Default size of broadcast segments, equal to the default capacity of a pipe. */
+#define BCAST_DEFAULT_SEGMENT 65536
+
+
+/* Environment variable with the size (in bytes) of segments reductions pipeline data in, 0 disables it. */
+#define REDUCE_SEGMENT_VAR "MIMPI_REDUCE_SEGMENT"
+
+
+/* Default size of reduction segments. */
+#define REDUCE_DEFAULT_SEGMENT 0
+
+
+/* Alignment of segments of windows in their mapping. */
+#define WINDOW_ALIGNMENT 64
+
+
+/* Length of names of shared memory objects backing windows. */
+#define WINDOW_NAME_LENGTH 64
+
+
+/* Environment variable which, set to 1, makes MIMPI_Bcast and MIMPI_Reduce skip their synchronisation passes. */
+#define RELAXED_COLLECTIVES_VAR "MIMPI_RELAXED_COLLECTIVES"
+
+
+/* Size (in bytes) from which MIMPI_Allreduce switches from recursive doubling to reduce-scatter and allgather. */
+#define ALLREDUCE_LARGE_SIZE 65536
+
+
+/* Environment variable with the size (in bytes) above which data is sent by rendezvous, unlimited by default. */
+#define EAGER_LIMIT_VAR "MIMPI_EAGER_LIMIT"
+
+
+/* Environment variable with the capacity (in bytes) of per-destination buffers coalescing small messages, 0 by default (disabled). */
+#define COALESCE_SIZE_VAR "MIMPI_COALESCE_SIZE"
+
+
+/* Environment variable with the size (in bytes) from which payloads are spliced into pipes instead of copied, 0 (default) disables it. */
+#define SPLICE_THRESHOLD_VAR "MIMPI_SPLICE_THRESHOLD"
+
+
+/* Environment variable with the memory (in bytes) copies of blocking sends by rendezvous may take. */
+#define RENDEZVOUS_BUFFER_VAR "MIMPI_RENDEZVOUS_BUFFER"
+
+
+/* Default memory copies of blocking sends by rendezvous may take. */
+#define RENDEZVOUS_DEFAULT_BUFFER ((size_t)64 << 20)
+
+
+/* Environment variable with the memory (in bytes) frames queued for writer threads may take, 0 by default (senders write frames themselves). */
+#define SEND_BUFFER_VAR "MIMPI_SEND_BUFFER"
+
 
-/* Size of metadata used with sending messages. */
-#define METADATA_SIZE (2 * sizeof(int)) 
+/* Size from which eager non-blocking sends are written by the rendezvous thread instead of the caller. */
+#define ISEND_QUEUE_THRESHOLD 1024
+
+
+/* Size of the buffer each reader reads ahead into, payloads not smaller are read directly. */
+#define READ_AHEAD_SIZE 65536
+
+
+/* Environment variable of channel.c with the time (in milliseconds) every block read takes, charged for the bytes a read asks for. */
+#define CHANNELS_READ_DELAY_VAR "CHANNELS_READ_DELAY"
+
+
+/* Environment variable with the time (in milliseconds) a receive waits before reporting itself for deadlock detection. */
+#define DEADLOCK_TIMEOUT_VAR "MIMPI_DEADLOCK_TIMEOUT"
+
+
+/* Default time a receive waits before reporting itself for deadlock detection. */
+#define DEADLOCK_DEFAULT_TIMEOUT 10
+
+
+/* Environment variable with the time (in microseconds) a receive spins before blocking, 0 by default (never spins). */
+#define SPIN_TIME_VAR "MIMPI_SPIN_US"
+
+
+/* Environment variable which, set to 1, makes MIMPI_Finalize interrupt readers instead of waiting for peers to leave. */
+#define FAST_FINALIZE_VAR "MIMPI_FAST_FINALIZE"
+
+
+/* Signal interrupting reads of readers at a fast MIMPI_Finalize. */
+#define FAST_FINALIZE_SIGNAL (SIGRTMIN + 1)
+
+
+/* Time (in microseconds) MIMPI_Finalize gives a reader to leave before interrupting it again. */
+#define FAST_FINALIZE_RETRY_US 1000
+
+
+/* Number of pauses between two looks at the clock of a spinning receive. */
+#define SPIN_CLOCK_INTERVAL 64
+
+
+/* Number of messages read from a process after which their arrival is acknowledged (deadlock detection). */
+#define ARRIVAL_ACK_BATCH 64
+
+
+/* Size (in bytes) of the chunks streams are sent in, each side of a stream buffers one chunk. */
+#define STREAM_CHUNK_SIZE (1 << 20)
+
+
+/* Maximum number of events handled by the progress engine in one epoll_wait call. */
+#define PROGRESS_EVENTS 64
 
 
 /* Default count used with special messages. */
@@ -69,9 +284,20 @@ typedef enum {
     MIMPI_MIN_TAG = -8,
     MIMPI_SUM_TAG = -9,
     MIMPI_PROD_TAG = -10,
+    MIMPI_LAST_REDUCE_TAG = MIMPI_MAX_TAG - MIMPI_DATATYPES * MIMPI_OPS + 1,
+    MIMPI_REQUEST_TO_SEND_TAG = MIMPI_LAST_REDUCE_TAG - 1,    // Announces a message, carries its count, tag and ticket.
+    MIMPI_CLEAR_TO_SEND_TAG = MIMPI_LAST_REDUCE_TAG - 2,      // Asks for the data of an announced message, carries its ticket.
+    MIMPI_RENDEZVOUS_DATA_TAG = MIMPI_LAST_REDUCE_TAG - 3,    // Data of an announced message, carries its ticket.
+    MIMPI_STREAM_CREDIT_TAG = MIMPI_LAST_REDUCE_TAG - 4,      // Lets a stream send its next chunk, the tag of the stream is in place of the count.
+    MIMPI_CLEARS_DONE_TAG = MIMPI_LAST_REDUCE_TAG - 5,        // Tells a process that its announced messages will not be cleared any more.
+    MIMPI_FIRST_GROUP_TAG = MIMPI_LAST_REDUCE_TAG - 6,        // Collectives of groups other than the world use tags from here down.
 } MIMPI_Tags;
 
 
+/* Number of tags collectives of a single group use: no message, broadcast and every reduction. */
+#define GROUP_TAGS (2 + MIMPI_DATATYPES * MIMPI_OPS)
+
+
 /* Represents a message */
 typedef struct {
     int tag;            // Identifier for the message.
@@ -79,9 +305,21 @@ typedef struct {
     int source;         // Source process rank.
     void* data;         // Pointer to the message data.
     bool received;      // Flag indicating whether the message has been received.
+    bool claimed;       // Flag indicating whether a reader is delivering the message directly into data.
+    bool announced;     // Flag indicating whether only the announcement arrived, without any data.
+    int ticket;         // Ticket of an announced message.
+    uint64_t arrival;   // Position in the order of arrival from all processes (queued messages only).
 } Message;
 
 
+/* Kinds of keys under which received messages are indexed. */
+typedef enum {
+    MIMPI_EXACT_INDEX = 0,      // Messages keyed by (tag, count).
+    MIMPI_ANY_TAG_INDEX = 1,    // Messages keyed by count only, used by MIMPI_ANY_TAG.
+    MIMPI_INDEX_KINDS = 2,
+} MIMPI_Index_kind;
+
+
 /* Doubly-linked list implementation from slides from course WDP*. */
 
 /* Represents an element in a doubly-linked list, */
@@ -89,6 +327,11 @@ typedef struct elem {
     struct elem* next;      // Pointer to the next element in the list.
     struct elem* prev;      // Pointer to the previous element in the list.
     Message* message;       // Pointer to the associated message.
+    bool pooled;            // Whether the element and its message come from a reader's pool.
+
+    struct elem* key_next[MIMPI_INDEX_KINDS];       // Next element with the same key in each index.
+    struct elem* key_prev[MIMPI_INDEX_KINDS];       // Previous element with the same key in each index.
+    struct bucket* key_bucket[MIMPI_INDEX_KINDS];   // Bucket holding the element in each index.
 } elem;
 
 
@@ -99,891 +342,6583 @@ typedef struct list {
 } list;
 
 
-/*  Represents the result of a read operation */
-typedef struct Readcode {
-    bool error_occured;     // Flag indicating whether an error occurred during the read operation.
-    void* data;             // Pointer to the data obtained from the read operation.
-} Readcode; 
+/* Represents a FIFO of indexed elements sharing one key. */
+typedef struct bucket {
+    struct bucket* chain;   // Next bucket in the same hash slot.
+    int tag;                // Tag of the key (MIMPI_ANY_TAG in the any-tag index).
+    int count;              // Count of the key.
+    elem* first;            // Oldest element with this key.
+    elem* last;             // Newest element with this key.
+} bucket;
 
 
-Message const MIMPI_DEFAULT_MSG = {
-    .tag = MIMPI_DEFAULT_TAG, .count = MIMPI_DEFAULT_COUNT, .source = MIMPI_DEFAULT_SOURCE, .data = NULL, .received = false
-};
-Message* MIMPI_waiting;
+/* Represents a chained hash table of buckets. */
+typedef struct hash_index {
+    bucket** slots;         // Array of bucket chains.
+    size_t capacity;        // Number of slots, always a power of two.
+    size_t size;            // Number of buckets stored.
+} hash_index;
 
-bool MIMPI_deadlock_enabled;
-bool MIMPI_already_left[MAXSIZE];
 
-list* MIMPI_send_not_received;
-list* MIMPI_others_recv[MAXSIZE];
-list* MIMPI_received_messages[MAXSIZE];
+/* Represents messages received from one source, in arrival order and indexed for matching. */
+typedef struct queue {
+    list* arrivals;                             // All messages in arrival order.
+    hash_index indices[MIMPI_INDEX_KINDS];      // Matching indices over the same messages.
+    size_t length;                              // Number of messages queued.
+} queue;
 
-pthread_cond_t MIMPI_cond;
-pthread_mutex_t MIMPI_mutex;
-pthread_t MIMPI_threads[MAXSIZE];
 
+/* Represents the beginning or the end of a traced operation. */
+typedef struct trace_event {
+    uint64_t time;              // Time of the event in nanoseconds of the monotonic clock.
+    const char* name;           // Name of the operation, a string literal.
+    int peer;                   // Process communicated with, -1 if none (beginnings only).
+    int tag;                    // Tag of the operation (beginnings only).
+    int count;                  // Number of bytes at the beginning, return code at the end.
+    char phase;                 // 'B' for the beginning, 'E' for the end.
+} trace_event;
 
-/// @brief Creates a message.
-///
-/// @param tag - identifier for the message.
-/// @param count - number of bytes in the message data.
-/// @param source - source process rank.
-/// @param data - pointer to the message data.
-///
-/// @return Message*:
-///     - pointer to the newly created message.
-static Message* create_message(
-    int tag, 
-    int count, 
-    int source, 
-    void* data
-) {
-    Message* message = (Message*)malloc(sizeof(Message));
-    ASSERT_MALLOC(message);
 
-    *message = (Message) {.tag = tag, .count = count, .source = source, .data = data, .received = false};
-    return message;
-}
+/* Ring buffer of the latest events of one thread, written only by the thread itself. */
+typedef struct trace_ring {
+    struct trace_ring* next;    // Ring of the thread registered before.
+    int thread;                 // Number of the thread within the process.
+    char thread_name[32];       // Name of the thread shown in the timeline.
+    atomic_size_t written;      // Number of events ever recorded.
+    trace_event events[];       // Events, the latest TRACE_EVENTS ones kept.
+} trace_ring;
 
 
-/// @brief Deletes a message.
-///
-/// @param message - pointer to the message to be deleted.
-static void delete_message(
-    Message* message
-) {
-    if(message->tag != MIMPI_DEADLOCK_TAG && message->tag != MIMPI_NO_MESSAGE_TAG)
-        free(message->data);
-    message->data = NULL;
-    free(message);
-}
+#ifdef MIMPI_STATS
+/* Counters of communication with one process, see MIMPI_Peer_stats. */
+typedef struct peer_stats {
+    atomic_uint_fast64_t messages_sent;
+    atomic_uint_fast64_t bytes_sent;
+    atomic_uint_fast64_t messages_received;
+    atomic_uint_fast64_t bytes_received;
+    atomic_uint_fast64_t unexpected_high_water;
+} peer_stats;
 
 
-/// @brief Compares two messages.
-///
-/// @param a - pointer to the first message.
-/// @param b - pointer to the second message.
-///
-/// @return bool:
-///     - true if the messages are equal, false otherwise.
-static bool compare_message(
-    const Message* a, 
-    const Message* b
-) {
-    return a->source == b->source && a->count == b->count && (b->tag == MIMPI_ANY_TAG || a->tag == b->tag);
-}
+/* Counters of the process not tied to a single peer, see MIMPI_Stats. */
+typedef struct process_stats {
+    atomic_uint_fast64_t recv_wait_ns;
+    atomic_uint_fast64_t send_calls;
+    atomic_uint_fast64_t recv_calls;
+    atomic_uint_fast64_t control_sent;
+    atomic_uint_fast64_t control_received;
+} process_stats;
+#endif
 
 
-/// @brief Creates an element.
-///
-/// @param next - pointer to the next element in the list.
-/// @param prev - pointer to the previous element in the list.
-/// @param message - pointer to the associated message.
-///
-/// @return elem*:
-///     - pointer to the newly created element.
-static elem* create_elem(
-    elem* next, 
-    elem* prev, 
-    Message* message
-) {
-    elem* el = (elem*)malloc(sizeof(elem));
-    ASSERT_MALLOC(el);
+/* Smallest pooled block, as a power of two. */
+#define POOL_MIN_SHIFT 5
 
-    *el = (elem) {.next = next, .prev = prev, .message = message};
-    return el;
-}
+/* Number of pooled payload size classes (blocks of 32 B up to 16 KiB). */
+#define POOL_PAYLOAD_CLASSES 10
 
+/* Size class of combined element and message nodes. */
+#define POOL_NODE_CLASS POOL_PAYLOAD_CLASSES
 
-/// @brief Deletes an element.
-///
-/// @param el - pointer to the element to be deleted.
-static void delete_elem(
-    elem* el
-) {
-    el->next = NULL;
-    el->prev = NULL;
-    if (el->message)
-        delete_message(el->message);
-    el->message = NULL;
-    free(el);
-}
+/* Number of size classes kept on free lists. */
+#define POOL_CLASSES (POOL_PAYLOAD_CLASSES + 1)
 
+/* Size class marking payloads too large to be pooled, allocated with malloc. */
+#define POOL_LARGE_CLASS POOL_CLASSES
 
-/// @brief Creates a list with empty head and tail elements.
-///
-/// @return list*:
-///     - pointer to the newly created list.
-static list* create_list() {
-    list* l = (list*)malloc(sizeof(list));
-    ASSERT_MALLOC(l);
-    
-    *l = (list) {
-        .head = create_elem(NULL, NULL, NULL), 
-        .tail = create_elem(NULL, NULL, NULL)
-    };
+/* Size of a slab carved into pooled blocks. */
+#define POOL_SLAB_SIZE (128 * 1024)
 
-    l->tail->next = l->head;
-    l->head->prev = l->tail;
 
-    return l;
-}
+/* Header preceding every block handed out by a pool. */
+typedef struct block_header {
+    struct pool* owner;     // Pool the block belongs to.
+    int size_class;         // Size class of the block.
+} __attribute__((aligned(16))) block_header;
 
 
-/// @brief Removes an element from the list.
-///
-/// @param el - pointer to the element to be removed from the list.
-static void remove_from_list(
-    elem* el
-) {
-    elem* previous_element = el->prev;
-    elem* next_element = el->next;
+/* Link stored in place of the data of a free block. */
+typedef struct free_block {
+    struct free_block* next;    // Next free block of the same class.
+} free_block;
 
-    if (previous_element)
-        previous_element->next = next_element;
 
-    if (next_element)
-        next_element->prev = previous_element;
+/* Header of a slab, followed by carved blocks. */
+typedef struct slab {
+    struct slab* next;      // Next slab owned by the same pool.
+} __attribute__((aligned(16))) slab;
 
-    delete_elem(el);
-}
 
+/* Represents a per-reader-thread allocator of message nodes and payloads. */
+typedef struct pool {
+    free_block* free_blocks[POOL_CLASSES];              // Blocks freed by the owning thread.
+    _Atomic(free_block*) returned_blocks[POOL_CLASSES]; // Blocks freed by other threads.
+    slab* slabs;                                        // Slabs owned by the pool, newest first.
+    size_t slab_used;                                   // Bytes carved from the newest slab.
+} pool;
 
-/// @brief Deletes a list.
+
+/* Combined allocation of an element with its message. */
+typedef struct node {
+    elem el;                // Element linking the message into lists.
+    Message message;        // Message owned by the element.
+} node;
+
+
+/* Parent and children of a process in the binomial tree of group functions rooted at one process. */
+typedef struct schedule {
+    int parent;             // Rank of the parent, -1 in the root.
+    int children_count;     // Number of children.
+    int children[32];       // Ranks of the children, in the order they are served.
+} schedule;
+
+
+/* Algorithms MIMPI_Barrier can synchronise processes with. */
+typedef enum {
+    BARRIER_BINOMIAL,       // Gather to rank 0 and release from it along the binomial tree.
+    BARRIER_DISSEMINATION,  // Rounds of messages to the process 2^round ranks ahead.
+    BARRIER_KARY,           // Gather and release along a tree of the given arity.
+} barrier_algorithm;
+
+
+/* Group of processes collectives run among, MIMPI_world holds all of them. */
+typedef struct MIMPI_Comm_data {
+    int id;                 // Identifier tags of collectives of the group are derived from, 0 for the world.
+    int rank;               // Rank of the process in the group.
+    int size;               // Number of processes in the group.
+    int* ranks;             // World ranks of the processes, indexed by their ranks in the group.
+    schedule* schedules;    // Place of the process in the tree of every root, in ranks of the group.
+    schedule* node_schedules; // Place in the two-level tree of every root, NULL unless the group spans several nodes.
+    schedule barrier_tree;  // Place of the process in the k-ary barrier tree, in ranks of the group.
+} communicator;
+
+
+/* Collective planned once by MIMPI_Bcast_init or MIMPI_Reduce_init and run by every MIMPI_Start. */
+typedef struct persistent {
+    void* data;             // Buffer of the broadcast, place for the result of the reduction.
+    void const* send_data;  // Data to be reduced (reductions only).
+    void* staging;          // Buffer the reduction combines data in (reductions only).
+    int count;              // Number of bytes broadcast or elements reduced.
+    int root;               // Rank of the root.
+    bool is_reduce;         // Flag indicating whether the collective is a reduction.
+    MIMPI_Datatype datatype; // Type of the elements (reductions only).
+    MIMPI_Op op;            // Reduction operation (reductions only).
+} persistent;
+
+
+/* Represents a non-blocking operation, and the receive posted by a blocking one. */
+typedef struct MIMPI_Request_data {
+    Message message;        // Posted receive, must stay first so that a claimed message leads back to it.
+    elem posted;            // Element linking the receive into the list of posted receives.
+    elem* found;            // Message matched by the receive (NULL if delivered in place).
+    void* buffer;           // Buffer of the receive, also for messages that are not delivered in place.
+    bool is_send;           // Flag indicating whether the operation is a send.
+    int ticket;             // Ticket of the message exchanged by rendezvous (NO_TICKET otherwise).
+    MIMPI_Retcode result;   // Outcome of a completed send, or of a receive failed by its peer.
+    persistent* planned;    // Collective of a persistent request (NULL for point-to-point operations).
+    bool any_source;        // Flag whether the receive was posted for MIMPI_ANY_SOURCE, its source is set once matched.
+    uint64_t posted_order;  // Position in the order of posting among all receives.
+    int matched_tag;        // Tag of the message the receive has been matched with.
+    bool detached;          // Flag whether the send has returned already, leaving the request a copy of its data.
+} request;
+
+
+/* One-sided window: a segment of every process of a group in a mapping shared by all of them. */
+typedef struct MIMPI_Win_data {
+    const communicator* comm; // Group the window spans.
+    char* memory;           // Mapping of the window, locks of the segments followed by the segments.
+    size_t memory_size;     // Size of the mapping.
+    size_t* offsets;        // Offsets of the segments in the mapping, indexed by ranks in the group.
+    size_t* sizes;          // Sizes of the segments, indexed by ranks in the group.
+} window;
+
+
+/* Lock of a segment of a window, held by accumulates into it, padded to a cache line. */
+typedef union window_lock {
+    pthread_mutex_t mutex;
+    char padding[WINDOW_ALIGNMENT];
+} window_lock;
+
+
+/* Ticket of operations which do not take part in a rendezvous. */
+#define NO_TICKET -1
+
+
+/* Represents a write done by the rendezvous thread on behalf of others. */
+typedef struct rendezvous_job {
+    struct rendezvous_job* next;    // Next job in the queue.
+    int destination;                // Rank of the process written to.
+    int tag;                        // Tag of the control frame written (if there is no send).
+    int ticket;                     // Ticket of the message cleared to be sent.
+    request* send;                  // Send whose data is written (NULL if the job writes a control frame).
+} rendezvous_job;
+
+
+/* Represents the progress of reading messages from one channel. */
+typedef struct reader {
+    int fd;                 // Descriptor of the channel.
+    frame_header header;    // Header of the frame being read.
+    size_t header_read;     // Number of header bytes read so far.
+    int count;              // Count of the message being read, decoded from the header.
+    int tag;                // Tag of the message being read, decoded from the header.
+    void* payload;          // Buffer the payload is read into.
+    size_t payload_read;    // Number of payload bytes read so far.
+    Message* claimed;       // Posted receive the payload goes straight to (NULL if none).
+    void* unpacked;         // Buffer a compressed payload is inflated into, NULL unless the frame is compressed.
+    char* buffer;           // Data read ahead from the channel.
+    size_t buffered;        // Number of bytes in the buffer.
+    size_t consumed;        // Number of bytes of the buffer already handled.
+} reader;
+
+
+/* Message sent to a process, as kept in its sent log for deadlock detection. */
+typedef struct sent_record {
+    int count;              // Number of bytes in the message data.
+    int tag;                // Identifier of the message.
+} sent_record;
+
+
+/* Initial number of records of a sent log, a power of two. */
+#define SENT_LOG_INITIAL_CAPACITY 64
+
+
+/* Frames queued for the writer thread of their destination (buffered sends). */
+typedef struct outgoing {
+    struct outgoing* next;  // Frames queued later.
+    size_t length;          // Number of bytes of the frames.
+    char data[];            // The frames, as they are to be written.
+} outgoing;
+
+
+/* Represents the state kept about every other process in the world. */
+typedef struct peer {
+    pthread_mutex_t mutex;      // Guards all state below except the reader and the thread.
+    pthread_cond_t cond;        // Signalled when a receive posted on the process may complete.
+    atomic_uint wakeups;        // Number of times the condition has been signalled, spinning receives watch it.
+    pthread_mutex_t send_mutex; // Keeps frames sent to the process by concurrent threads from interleaving, guards the batch.
+    char* batch;                // Frames coalesced for the process and not written yet (NULL if coalescing is disabled).
+    size_t batch_used;          // Number of bytes in the batch.
+    outgoing* out_first;        // Frames queued for the writer thread, oldest first (buffered sends).
+    outgoing* out_last;         // Frames queued for the writer thread most recently.
+    pthread_cond_t out_cond;    // Signalled when frames are queued for the writer thread or it has to stop.
+    bool out_broken;            // Flag indicating whether the writer thread has failed to write to the process.
+    pthread_t writer;           // Writer thread of the channel to the process (buffered sends).
+    list* posted;               // Receives posted on the process and not matched yet, oldest first.
+    request* blocked;           // Receive the user thread is blocked on (deadlock detection).
+    list* cleared;              // Receives matched with announced messages, waiting for their data.
+    list* announced_sends;      // Sends announced to the process and not cleared yet.
+    int next_ticket;            // Ticket of the next message announced to the process.
+    int detached_sends;         // Number of blocking sends to the process which have returned before their data was written.
+    atomic_int queued_sends;    // Number of eager non-blocking sends to the process queued for the rendezvous thread.
+    bool stopped_clearing;      // Flag indicating whether the process has told it clears no more announced messages.
+    bool already_left;          // Flag indicating whether the process has escaped the MPI block.
+    list* others_recv;          // Receives the process reported to be waiting on (deadlock detection).
+    sent_record* sent_log;      // Ring of messages sent to the process and not known to have arrived (deadlock detection).
+    int sent_capacity;          // Number of records the ring holds, a power of two.
+    int sent;                   // Number of messages sent to the process (deadlock detection).
+    int logged;                 // Number of messages in the sent log, the newest ones sent.
+    int arrived;                // Number of messages read from the process (deadlock detection).
+    int acknowledged;           // Number of messages read from the process whose arrival has been reported.
+    queue* received_messages;   // Messages received from the process and not consumed yet.
+    pool pool;                  // Allocator of the reader thread of the process.
+    reader reader;              // Progress of reading the channel from the process.
+    pthread_t thread;           // Reader thread of the channel from the process.
+    int send_pipe_size;         // Capacity of the pipe carrying frames to the process.
+    atomic_size_t bytes_written;    // Bytes written to the channel to the process so far, counted once they are in it.
+    int recv_pipe_size;         // Capacity of the pipe carrying frames from the process.
+#ifdef MIMPI_STATS
+    peer_stats stats;           // Counters of communication with the process.
+#endif
+} peer;
+
+
+int MIMPI_rank;
+int MIMPI_size;
+
+bool MIMPI_deadlock_enabled;
+
+peer* MIMPI_peers;
+#ifdef MIMPI_STATS
+process_stats MIMPI_stats;
+#endif
+
+bool MIMPI_use_epoll;
+int MIMPI_epoll_fd;
+pthread_t MIMPI_progress_thread;
+
+int MIMPI_bcast_segment;
+int MIMPI_reduce_segment;
+bool MIMPI_relaxed_collectives;
+communicator MIMPI_world;
+int MIMPI_next_group_id;
+int MIMPI_next_window_id;
+barrier_algorithm MIMPI_barrier_algorithm;
+int MIMPI_barrier_arity;
+int* MIMPI_nodes;                           // Node of every world rank, as placed by mimpirun, NULL if unknown.
+void* MIMPI_staging;
+size_t MIMPI_staging_size;
+
+int MIMPI_deadlock_timeout;
+long MIMPI_spin_ns;                         // Time a receive spins before blocking, 0 if receives block at once.
+int MIMPI_eager_limit;
+bool MIMPI_read_ahead;                      // Flag whether readers read greedily, off under a read delay.
+size_t MIMPI_coalesce_size;
+size_t MIMPI_splice_threshold;              // Payloads of at least this many bytes are spliced, 0 if none are.
+size_t MIMPI_compress_threshold;            // Payloads of at least this many bytes are compressed, 0 if none are.
+atomic_bool MIMPI_splice_supported;         // Cleared once the kernel refuses to splice, copying from then on.
+bool MIMPI_rendezvous_running;              // Flag whether the rendezvous thread has been started.
+pthread_t MIMPI_rendezvous_thread;
+pthread_mutex_t MIMPI_rendezvous_mutex;
+pthread_cond_t MIMPI_rendezvous_cond;
+rendezvous_job* MIMPI_rendezvous_first;
+rendezvous_job* MIMPI_rendezvous_last;
+bool MIMPI_rendezvous_stopping;
+bool MIMPI_clears_done;                     // Set by MIMPI_Finalize, announced messages are not cleared from then on.
+size_t MIMPI_rendezvous_buffer;             // Bytes copies of blocking sends by rendezvous may take.
+size_t MIMPI_rendezvous_buffered;           // Bytes copies of blocking sends by rendezvous take, guarded by MIMPI_rendezvous_mutex.
+pthread_cond_t MIMPI_rendezvous_buffer_cond;    // Signalled when copies of blocking sends by rendezvous are freed.
+
+size_t MIMPI_send_buffer;                   // Bytes queued frames may take, 0 if senders write frames themselves.
+size_t MIMPI_send_buffered;                 // Bytes queued frames take.
+bool MIMPI_writers_stopping;                // Flag telling writer threads to stop once their queues are empty.
+bool MIMPI_fast_finalize;                   // Flag whether MIMPI_Finalize interrupts readers rather than joining them.
+atomic_bool MIMPI_readers_stopping;         // Set by a fast MIMPI_Finalize, readers leave once interrupted.
+struct sigaction MIMPI_previous_action;     // Action of FAST_FINALIZE_SIGNAL before MIMPI_Init, restored by MIMPI_Finalize.
+pthread_mutex_t MIMPI_send_buffer_mutex;    // Guards the queues of writer threads and the bytes they take.
+pthread_cond_t MIMPI_send_buffer_cond;      // Signalled when queued frames have been written.
+
+pthread_mutex_t MIMPI_any_mutex;            // Guards receives posted for any source and the number of processes which left.
+pthread_cond_t MIMPI_any_cond;              // Signalled when a receive for any source is matched or a process leaves.
+list* MIMPI_any_posted;                     // Receives posted for any source and not matched yet, oldest first.
+atomic_int MIMPI_any_pending;               // Number of receives in MIMPI_any_posted, readers skip the lock while it is 0.
+int MIMPI_peers_left;                       // Number of processes whose channels have been closed.
+atomic_uint_fast64_t MIMPI_arrivals;        // Number of messages queued so far.
+atomic_uint_fast64_t MIMPI_posts;           // Number of receives posted so far.
+atomic_int MIMPI_probes;                    // Number of threads waiting in blocking probes, woken on every queued message.
+
+void* MIMPI_shared_memory;
+size_t MIMPI_shared_memory_size;
+
+static __thread pool* MIMPI_local_pool;
+
+bool MIMPI_tracing;
+size_t MIMPI_trace_events;
+_Atomic(trace_ring*) MIMPI_trace_rings;
+atomic_int MIMPI_trace_threads;
+static __thread trace_ring* MIMPI_local_trace;
+
+
+/// @brief Reads the monotonic clock, shared by all processes of the machine.
 ///
-/// @param l - pointer to the list to be deleted.
-static void delete_list(
-    list* l
-) {
-    elem* current = l->tail;
+/// @return uint64_t:
+///     - current time in nanoseconds.
+static uint64_t monotonic_clock() {
+    struct timespec now;
+    ASSERT_SYS_OK(clock_gettime(CLOCK_MONOTONIC, &now));
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
 
-    while (current) {
-        elem* next = current->next;
-        remove_from_list(current);
-        current = next;
+
+/// @brief Returns the trace ring of the calling thread, registering one on first use.
+///
+/// Rings are pushed onto a lock-free list, so registering never blocks other threads.
+///
+/// @return trace_ring*:
+///     - pointer to the ring of the thread.
+static trace_ring* local_trace() {
+    if (MIMPI_local_trace != NULL) {
+        return MIMPI_local_trace;
     }
 
-    l->tail = NULL;
-    l->head = NULL;
-    free(l);
+    trace_ring* ring = (trace_ring*)malloc(sizeof(trace_ring) + MIMPI_trace_events * sizeof(trace_event));
+    ASSERT_MALLOC(ring);
+
+    ring->thread = atomic_fetch_add(&MIMPI_trace_threads, 1);
+    ASSERT_SPRINTF(sprintf(ring->thread_name, "thread %d", ring->thread));
+    atomic_init(&ring->written, 0);
+
+    ring->next = atomic_load(&MIMPI_trace_rings);
+    while (!atomic_compare_exchange_weak(&MIMPI_trace_rings, &ring->next, ring));
+
+    MIMPI_local_trace = ring;
+    return ring;
 }
 
 
-/// @brief Finds an element in the list.
-///
-/// @param l - pointer to the list.
-/// @param to_compare - pointer to the message to compare.
+/// @brief Names the calling thread in the trace.
 ///
-/// @return elem*:
-///     - pointer to the found element, head of a list otherwise.
-static elem* find_elem_in_list(
-    list* l,
-    Message* to_compare
+/// @param name - name of the thread.
+static void trace_thread_name(
+    const char* name
 ) {
-    elem* current = l->tail->next;
-            
-    while (current->message != NULL && current != l->head) {
-        if (compare_message(current->message, to_compare)) {
-            break;
-        }
-        
-        current = current->next;
+    if (MIMPI_tracing) {
+        trace_ring* ring = local_trace();
+        ASSERT_SPRINTF(snprintf(ring->thread_name, sizeof(ring->thread_name), "%s", name));
     }
-
-    return current;
 }
 
 
-/// @brief Adds an element to the front of the list.
+/// @brief Records an event of the calling thread, if tracing is on.
 ///
-/// @param l - pointer to the list.
-/// @param el - pointer to the element to be added.
-static void push_front(
-    list* l, 
-    elem* el
+/// @param phase - 'B' for the beginning of an operation, 'E' for its end.
+/// @param name - name of the operation, a string literal.
+/// @param peer - process communicated with, -1 if none.
+/// @param tag - tag of the operation.
+/// @param count - number of bytes at the beginning, return code at the end.
+static void trace(
+    char phase,
+    const char* name,
+    int peer,
+    int tag,
+    int count
 ) {
-    elem* last = l->head->prev;
-    last->next = el;
+    if (!MIMPI_tracing) {
+        return;
+    }
 
-    el->prev = last;
-    el->next = l->head;
+    trace_ring* ring = local_trace();
+    const size_t written = atomic_load_explicit(&ring->written, memory_order_relaxed);
 
-    l->head->prev = el;
+    ring->events[written % MIMPI_trace_events] = (trace_event) {
+        .time = monotonic_clock(), .name = name, .peer = peer, .tag = tag, .count = count, .phase = phase,
+    };
+    atomic_store_explicit(&ring->written, written + 1, memory_order_release);
 }
 
 
-/// @brief Reads data from a channel.
-///
-/// @param fd - file descriptor of the channel.
-/// @param count - number of bytes to read.
+/// @brief Writes the events of all threads to the trace of the process and releases the rings.
 ///
-/// @return Readcode*:
-///     - pointer to the Readcode containing read data and error status.
-static Readcode* read_from_channel(
-    int fd, 
-    size_t count
-) {
-    void* data = (void*)malloc(sizeof(void) * count);
-    ASSERT_MALLOC(data);
+/// Called once the helper threads have stopped. The file lists threads as
+/// `T <thread> <name>` lines and events as `<phase> <time> <thread> <name> <peer> <tag> <count>` lines,
+/// mimpirun merges the files of all processes into a single timeline.
+static void write_trace() {
+    trace_ring* ring = atomic_exchange(&MIMPI_trace_rings, NULL);
+    FILE* file = NULL;
+
+    if (MIMPI_tracing) {
+        char path[PATH_MAX];
+        if (snprintf(path, sizeof(path), TRACE_FILE_FORMAT, getenv(TRACE_DIR_VAR), MIMPI_rank) >= (int)sizeof(path)) {
+            fatal("Path of the trace in %s is too long", getenv(TRACE_DIR_VAR));
+        }
 
-    Readcode* readcode = (Readcode*)malloc(sizeof(Readcode));
-    ASSERT_MALLOC(readcode);
+        file = fopen(path, "w");
+        if (file == NULL) {
+            syserr("Opening %s failed", path);
+        }
+    }
 
-    readcode->error_occured = false;
+    while (ring != NULL) {
+        const size_t written = atomic_load_explicit(&ring->written, memory_order_acquire);
+        const size_t first = written > MIMPI_trace_events ? written - MIMPI_trace_events : 0;
 
-    int bytes_read = 0;
-    
-    while (bytes_read < count) {
-        int current_read = chrecv(fd, data + bytes_read, count - bytes_read);
+        fprintf(file, "T %d %s\n", ring->thread, ring->thread_name);
 
-        if (current_read <= 0) {
-            readcode->error_occured = true;
-            break;
+        for (size_t i = first; i < written; i++) {
+            const trace_event* event = &ring->events[i % MIMPI_trace_events];
+            fprintf(
+                file, "%c %" PRIu64 " %d %s %d %d %d\n",
+                event->phase, event->time, ring->thread, event->name, event->peer, event->tag, event->count
+            );
         }
 
-        bytes_read += current_read;
+        trace_ring* next = ring->next;
+        free(ring);
+        ring = next;
+    }
+
+    if (file != NULL) {
+        ASSERT_ZERO(fclose(file));
     }
 
-    readcode->data = data;
-    return readcode;
+    MIMPI_local_trace = NULL;
+    MIMPI_tracing = false;
 }
 
-/// @brief Writes data to a channel.
+
+/// @brief Returns the size of blocks of the given class.
 ///
-/// @param fd - file descriptor of the channel.
-/// @param count - number of bytes to write.
-/// @param data - pointer to the data to be written.
+/// @param size_class - size class of the block.
 ///
-/// @return bool:
-///     - true if the write was successful, false otherwise.
-static bool write_to_channel(
-    int fd, 
-    size_t count, 
-    const void* data
+/// @return size_t:
+///     - size of the block including its header.
+static size_t block_size(
+    int size_class
 ) {
-    int bytes_wrote = 0;
+    if (size_class == POOL_NODE_CLASS)
+        return (sizeof(block_header) + sizeof(node) + 15) & ~(size_t)15;
+
+    return (size_t)1 << (POOL_MIN_SHIFT + size_class);
+}
+
+
+/// @brief Initialises an empty pool.
+///
+/// @param p - pointer to the pool.
+static void init_pool(
+    pool* p
+) {
+    for (int i = 0; i < POOL_CLASSES; i++) {
+        p->free_blocks[i] = NULL;
+        atomic_init(&p->returned_blocks[i], NULL);
+    }
+
+    p->slabs = NULL;
+    p->slab_used = POOL_SLAB_SIZE;
+}
+
+
+/// @brief Frees all slabs of a pool at once.
+///
+/// @param p - pointer to the pool.
+static void destroy_pool(
+    pool* p
+) {
+    slab* current = p->slabs;
+
+    while (current) {
+        slab* next = current->next;
+        free(current);
+        current = next;
+    }
+
+    init_pool(p);
+}
+
+
+/// @brief Allocates a block of the given class; must be called by the pool's owner.
+///
+/// @param p - pointer to the pool.
+/// @param size_class - size class of the block.
+///
+/// @return void*:
+///     - pointer to the data of the block.
+static void* pool_alloc(
+    pool* p,
+    int size_class
+) {
+    free_block* fb = p->free_blocks[size_class];
+
+    if (fb == NULL) {
+        fb = atomic_exchange_explicit(&p->returned_blocks[size_class], NULL, memory_order_acquire);
+    }
+
+    if (fb) {
+        p->free_blocks[size_class] = fb->next;
+        return fb;
+    }
+
+    size_t size = block_size(size_class);
+
+    if (p->slab_used + size > POOL_SLAB_SIZE) {
+        slab* sl = (slab*)malloc(POOL_SLAB_SIZE);
+        ASSERT_MALLOC(sl);
+
+        sl->next = p->slabs;
+        p->slabs = sl;
+        p->slab_used = sizeof(slab);
+    }
+
+    block_header* header = (block_header*)((char*)p->slabs + p->slab_used);
+    p->slab_used += size;
+
+    *header = (block_header) {.owner = p, .size_class = size_class};
+    return header + 1;
+}
+
+
+/// @brief Returns a block to its pool, or to the system if it was not pooled.
+///
+/// @param data - pointer to the data of the block (may be NULL).
+static void pool_release(
+    void* data
+) {
+    if (data == NULL)
+        return;
+
+    block_header* header = (block_header*)data - 1;
+
+    if (header->size_class == POOL_LARGE_CLASS) {
+        free(header);
+        return;
+    }
+
+    pool* p = header->owner;
+    free_block* fb = (free_block*)data;
+
+    if (p == MIMPI_local_pool) {
+        fb->next = p->free_blocks[header->size_class];
+        p->free_blocks[header->size_class] = fb;
+        return;
+    }
+
+    _Atomic(free_block*)* returned = &p->returned_blocks[header->size_class];
+    fb->next = atomic_load_explicit(returned, memory_order_relaxed);
+
+    while (!atomic_compare_exchange_weak_explicit(returned, &fb->next, fb, memory_order_release, memory_order_relaxed));
+}
+
+
+/// @brief Allocates a payload buffer from the size class fitting it.
+///
+/// @param p - pointer to the pool of the calling thread.
+/// @param count - number of bytes of the payload.
+///
+/// @return void*:
+///     - pointer to the payload buffer.
+static void* alloc_payload(
+    pool* p,
+    size_t count
+) {
+    size_t needed = count + sizeof(block_header);
+    int size_class = 0;
+
+    while (size_class < POOL_PAYLOAD_CLASSES && block_size(size_class) < needed) {
+        size_class++;
+    }
+
+    if (size_class < POOL_PAYLOAD_CLASSES)
+        return pool_alloc(p, size_class);
+
+    block_header* header = (block_header*)malloc(needed);
+    ASSERT_MALLOC(header);
+
+    *header = (block_header) {.owner = NULL, .size_class = POOL_LARGE_CLASS};
+    return header + 1;
+}
+
+
+/// @brief Calculates the tag a group uses in place of a tag of world collectives.
+///
+/// @param comm - group the collective runs in.
+/// @param tag - MIMPI_NO_MESSAGE_TAG, MIMPI_BROADCAST_TAG or a tag of a reduction.
+///
+/// @return int:
+///     - the tag itself in the world, a tag not greater than MIMPI_FIRST_GROUP_TAG otherwise.
+static int group_tag(
+    const communicator* comm,
+    int tag
+) {
+    if (comm->id == 0) return tag;
+
+    const int offset = tag == MIMPI_NO_MESSAGE_TAG ? 0 : tag == MIMPI_BROADCAST_TAG ? 1 : 2 + MIMPI_MAX_TAG - tag;
+
+    return MIMPI_FIRST_GROUP_TAG - (comm->id - 1) * GROUP_TAGS - offset;
+}
+
+
+/// @brief Calculates the tag of world collectives a tag of a group stands for.
+///
+/// @param tag - tag of a message.
+///
+/// @return int:
+///     - the tag @ref group_tag was given, or the tag itself if it is not one of a group.
+static int world_tag(
+    int tag
+) {
+    if (tag > MIMPI_FIRST_GROUP_TAG) return tag;
+
+    const int offset = (MIMPI_FIRST_GROUP_TAG - tag) % GROUP_TAGS;
+
+    return offset == 0 ? MIMPI_NO_MESSAGE_TAG : offset == 1 ? MIMPI_BROADCAST_TAG : MIMPI_MAX_TAG - (offset - 2);
+}
+
+
+/// @brief Checks whether messages with a tag carry data after their header.
+///
+/// @param tag - tag of a message.
+///
+/// @return bool:
+///     - true if the count of the message is the size of its data, false if the message has no data.
+static bool carries_payload(
+    int tag
+) {
+    // Control frames carry what they need in their header.
+    return tag != MIMPI_DEADLOCK_TAG && tag != MIMPI_WAITING_TAG && tag != MIMPI_RECEIVED_TAG
+        && tag != MIMPI_REQUEST_TO_SEND_TAG && tag != MIMPI_CLEAR_TO_SEND_TAG && tag != MIMPI_STREAM_CREDIT_TAG
+        && tag != MIMPI_CLEARS_DONE_TAG && world_tag(tag) != MIMPI_NO_MESSAGE_TAG;
+}
+
+
+/// @brief Builds the header of a frame.
+///
+/// @param tag - tag of the message: a user tag, a tag of a collective or one of the control tags.
+/// @param count - count of the message: number of its bytes, or the count announced, waited for or credited.
+/// @param message_tag - tag of the message announced or waited for, ignored by other kinds.
+/// @param value - ticket or number of messages the kind needs, ignored by other kinds.
+///
+/// @return frame_header:
+///     - the header.
+static frame_header build_header(
+    int tag,
+    int count,
+    int message_tag,
+    int value
+) {
+    frame_kind kind = FRAME_DATA;
+
+    switch (tag) {
+        case MIMPI_DEADLOCK_TAG: kind = FRAME_DEADLOCK; break;
+        case MIMPI_WAITING_TAG: kind = FRAME_WAITING; break;
+        case MIMPI_RECEIVED_TAG: kind = FRAME_RECEIVED; break;
+        case MIMPI_REQUEST_TO_SEND_TAG: kind = FRAME_REQUEST_TO_SEND; break;
+        case MIMPI_CLEAR_TO_SEND_TAG: kind = FRAME_CLEAR_TO_SEND; break;
+        case MIMPI_RENDEZVOUS_DATA_TAG: kind = FRAME_RENDEZVOUS_DATA; break;
+        case MIMPI_STREAM_CREDIT_TAG: kind = FRAME_STREAM_CREDIT; break;
+        case MIMPI_CLEARS_DONE_TAG: kind = FRAME_CLEARS_DONE; break;
+        default: break;
+    }
+
+    const bool has_value = kind == FRAME_WAITING || kind == FRAME_RECEIVED || kind == FRAME_REQUEST_TO_SEND
+        || kind == FRAME_CLEAR_TO_SEND || kind == FRAME_RENDEZVOUS_DATA;
+
+    return (frame_header) {
+        .version_kind = FRAME_VERSION << 4 | kind,
+        .flags = (carries_payload(tag) ? FRAME_PAYLOAD : 0) | (has_value ? FRAME_VALUE : 0),
+        .reserved = 0,
+        .tag = kind == FRAME_DATA ? tag : message_tag,
+        .count = count,
+        .value = value,
+    };
+}
+
+
+/// @brief Calculates the number of bytes of a header.
+///
+/// @param header - pointer to the header, of which at least the part every frame has is known.
+///
+/// @return size_t:
+///     - size of the header including its value, if it has one.
+static size_t header_size(
+    const frame_header* header
+) {
+    return FRAME_HEADER_SIZE + (header->flags & FRAME_VALUE ? sizeof(header->value) : 0)
+        + (header->flags & FRAME_COMPRESSED ? sizeof(header->packed) : 0);
+}
+
+
+/// @brief Calculates the tag a received frame stands for.
+///
+/// @param header - pointer to the header of the frame.
+///
+/// @return int:
+///     - the tag of the header for data, the control tag of the kind otherwise.
+static int frame_tag(
+    const frame_header* header
+) {
+    static const int control_tags[FRAME_KINDS] = {
+        [FRAME_DEADLOCK] = MIMPI_DEADLOCK_TAG,
+        [FRAME_WAITING] = MIMPI_WAITING_TAG,
+        [FRAME_RECEIVED] = MIMPI_RECEIVED_TAG,
+        [FRAME_REQUEST_TO_SEND] = MIMPI_REQUEST_TO_SEND_TAG,
+        [FRAME_CLEAR_TO_SEND] = MIMPI_CLEAR_TO_SEND_TAG,
+        [FRAME_RENDEZVOUS_DATA] = MIMPI_RENDEZVOUS_DATA_TAG,
+        [FRAME_STREAM_CREDIT] = MIMPI_STREAM_CREDIT_TAG,
+        [FRAME_CLEARS_DONE] = MIMPI_CLEARS_DONE_TAG,
+    };
+    const int kind = header->version_kind & 0xF;
+
+    return kind == FRAME_DATA ? header->tag : control_tags[kind];
+}
+
+
+/// @brief Deletes a message.
+///
+/// @param message - pointer to the message to be deleted.
+static void delete_message(
+    Message* message
+) {
+    if(carries_payload(message->tag))
+        pool_release(message->data);
+    message->data = NULL;
+    free(message);
+}
+
+
+/// @brief Compares two messages.
+///
+/// @param a - pointer to the first message.
+/// @param b - pointer to the second message.
+///
+/// @return bool:
+///     - true if the messages are equal, false otherwise.
+static bool compare_message(
+    const Message* a, 
+    const Message* b
+) {
+    return (b->source == MIMPI_ANY_SOURCE || a->source == b->source) && a->count == b->count && (b->tag == MIMPI_ANY_TAG || a->tag == b->tag);
+}
+
+
+/// @brief Creates an element.
+///
+/// @param next - pointer to the next element in the list.
+/// @param prev - pointer to the previous element in the list.
+/// @param message - pointer to the associated message.
+///
+/// @return elem*:
+///     - pointer to the newly created element.
+static elem* create_elem(
+    elem* next, 
+    elem* prev, 
+    Message* message
+) {
+    elem* el = (elem*)malloc(sizeof(elem));
+    ASSERT_MALLOC(el);
+
+    *el = (elem) {.next = next, .prev = prev, .message = message};
+    return el;
+}
+
+
+/// @brief Deletes an element.
+///
+/// @param el - pointer to the element to be deleted.
+static void delete_elem(
+    elem* el
+) {
+    el->next = NULL;
+    el->prev = NULL;
+
+    if (el->pooled) {
+        pool_release(el->message->data);
+        el->message = NULL;
+        pool_release(el);
+        return;
+    }
+
+    if (el->message)
+        delete_message(el->message);
+    el->message = NULL;
+    free(el);
+}
+
+
+/// @brief Creates an element together with its message from a pool.
+///
+/// @param p - pointer to the pool of the calling thread.
+/// @param tag - identifier for the message.
+/// @param count - number of bytes in the message data.
+/// @param source - source process rank.
+/// @param data - pointer to the message data, allocated from a pool.
+///
+/// @return elem*:
+///     - pointer to the newly created element.
+static elem* create_pooled_elem(
+    pool* p,
+    int tag,
+    int count,
+    int source,
+    void* data
+) {
+    node* n = (node*)pool_alloc(p, POOL_NODE_CLASS);
+
+    n->message = (Message) {.tag = tag, .count = count, .source = source, .data = data, .received = false};
+    n->el = (elem) {.next = NULL, .prev = NULL, .message = &n->message, .pooled = true};
+    return &n->el;
+}
+
+
+/// @brief Creates a list with empty head and tail elements.
+///
+/// @return list*:
+///     - pointer to the newly created list.
+static list* create_list() {
+    list* l = (list*)malloc(sizeof(list));
+    ASSERT_MALLOC(l);
     
-    while (bytes_wrote < count) {
-        int current_wrote = chsend(fd, data + bytes_wrote, count - bytes_wrote);
-        
-        if (current_wrote <= 0) {
-            return false;
+    *l = (list) {
+        .head = create_elem(NULL, NULL, NULL), 
+        .tail = create_elem(NULL, NULL, NULL)
+    };
+
+    l->tail->next = l->head;
+    l->head->prev = l->tail;
+
+    return l;
+}
+
+
+/// @brief Unlinks an element from the list without deleting it.
+///
+/// @param el - pointer to the element to be unlinked from the list.
+static void unlink_from_list(
+    elem* el
+) {
+    elem* previous_element = el->prev;
+    elem* next_element = el->next;
+
+    if (previous_element)
+        previous_element->next = next_element;
+
+    if (next_element)
+        next_element->prev = previous_element;
+
+    el->next = NULL;
+    el->prev = NULL;
+}
+
+
+/// @brief Removes an element from the list.
+///
+/// @param el - pointer to the element to be removed from the list.
+static void remove_from_list(
+    elem* el
+) {
+    unlink_from_list(el);
+    delete_elem(el);
+}
+
+
+/// @brief Deletes a list.
+///
+/// @param l - pointer to the list to be deleted.
+static void delete_list(
+    list* l
+) {
+    elem* current = l->tail;
+
+    while (current) {
+        elem* next = current->next;
+        remove_from_list(current);
+        current = next;
+    }
+
+    l->tail = NULL;
+    l->head = NULL;
+    free(l);
+}
+
+
+/// @brief Deletes a list linking requests, which own their elements.
+///
+/// @param l - pointer to the list to be deleted.
+static void delete_request_list(
+    list* l
+) {
+    while (l->tail->next != l->head) {
+        unlink_from_list(l->tail->next);
+    }
+
+    delete_list(l);
+}
+
+
+/// @brief Adds an element to the front of the list.
+///
+/// @param l - pointer to the list.
+/// @param el - pointer to the element to be added.
+static void push_front(
+    list* l, 
+    elem* el
+) {
+    elem* last = l->head->prev;
+    last->next = el;
+
+    el->prev = last;
+    el->next = l->head;
+
+    l->head->prev = el;
+}
+
+
+/* Initial number of slots in a hash index. */
+#define INDEX_INITIAL_CAPACITY 16
+
+
+/// @brief Computes a hash of a matching key.
+///
+/// @param tag - tag of the key.
+/// @param count - count of the key.
+///
+/// @return size_t:
+///     - hash of the key.
+static size_t hash_key(
+    int tag,
+    int count
+) {
+    size_t h = (size_t)(unsigned)tag * 0x9E3779B1u ^ (size_t)(unsigned)count * 0x85EBCA77u;
+    return h ^ (h >> 15);
+}
+
+
+/// @brief Initialises an empty hash index.
+///
+/// @param idx - pointer to the index.
+static void init_index(
+    hash_index* idx
+) {
+    idx->slots = (bucket**)calloc(INDEX_INITIAL_CAPACITY, sizeof(bucket*));
+    ASSERT_MALLOC(idx->slots);
+
+    idx->capacity = INDEX_INITIAL_CAPACITY;
+    idx->size = 0;
+}
+
+
+/// @brief Frees a hash index together with its remaining buckets.
+///
+/// @param idx - pointer to the index.
+static void free_index(
+    hash_index* idx
+) {
+    for (size_t i = 0; i < idx->capacity; i++) {
+        bucket* current = idx->slots[i];
+
+        while (current) {
+            bucket* next = current->chain;
+            free(current);
+            current = next;
+        }
+    }
+
+    free(idx->slots);
+    idx->slots = NULL;
+    idx->capacity = 0;
+    idx->size = 0;
+}
+
+
+/// @brief Finds the link pointing at the bucket with the given key.
+///
+/// @param idx - pointer to the index.
+/// @param tag - tag of the key.
+/// @param count - count of the key.
+///
+/// @return bucket**:
+///     - link to the bucket with the key, link holding NULL if there is no such bucket.
+static bucket** find_slot(
+    hash_index* idx,
+    int tag,
+    int count
+) {
+    bucket** link = &idx->slots[hash_key(tag, count) & (idx->capacity - 1)];
+
+    while (*link && ((*link)->tag != tag || (*link)->count != count)) {
+        link = &(*link)->chain;
+    }
+
+    return link;
+}
+
+
+/// @brief Doubles the number of slots in the index.
+///
+/// @param idx - pointer to the index.
+static void grow_index(
+    hash_index* idx
+) {
+    size_t capacity = idx->capacity * 2;
+    bucket** slots = (bucket**)calloc(capacity, sizeof(bucket*));
+    ASSERT_MALLOC(slots);
+
+    for (size_t i = 0; i < idx->capacity; i++) {
+        bucket* current = idx->slots[i];
+
+        while (current) {
+            bucket* next = current->chain;
+            size_t slot = hash_key(current->tag, current->count) & (capacity - 1);
+
+            current->chain = slots[slot];
+            slots[slot] = current;
+            current = next;
+        }
+    }
+
+    free(idx->slots);
+    idx->slots = slots;
+    idx->capacity = capacity;
+}
+
+
+/// @brief Creates a queue of received messages with empty indices.
+///
+/// @return queue*:
+///     - pointer to the newly created queue.
+static queue* create_queue() {
+    queue* q = (queue*)malloc(sizeof(queue));
+    ASSERT_MALLOC(q);
+
+    q->arrivals = create_list();
+    q->length = 0;
+
+    for (int kind = 0; kind < MIMPI_INDEX_KINDS; kind++) {
+        init_index(&q->indices[kind]);
+    }
+
+    return q;
+}
+
+
+/// @brief Deletes a queue with all messages it holds.
+///
+/// @param q - pointer to the queue to be deleted.
+static void delete_queue(
+    queue* q
+) {
+    delete_list(q->arrivals);
+
+    for (int kind = 0; kind < MIMPI_INDEX_KINDS; kind++) {
+        free_index(&q->indices[kind]);
+    }
+
+    free(q);
+}
+
+
+/// @brief Deletes a queue, leaving messages in blocks of pools to be freed with their slabs.
+///
+/// Only elements and payloads allocated on their own are freed, the pools of the readers have to be destroyed next.
+///
+/// @param q - pointer to the queue to be deleted.
+static void drop_queue(
+    queue* q
+) {
+    elem* current = q->arrivals->tail;
+
+    while (current) {
+        elem* next = current->next;
+
+        if (!current->pooled) {
+            delete_elem(current);
+        }
+        else if (current->message->data != NULL && ((block_header*)current->message->data - 1)->size_class == POOL_LARGE_CLASS) {
+            pool_release(current->message->data);
+        }
+
+        current = next;
+    }
+
+    free(q->arrivals);
+
+    for (int kind = 0; kind < MIMPI_INDEX_KINDS; kind++) {
+        free_index(&q->indices[kind]);
+    }
+
+    free(q);
+}
+
+
+/// @brief Returns the key tag under which a message is stored in an index.
+///
+/// @param kind - kind of the index.
+/// @param tag - tag of the message.
+///
+/// @return int:
+///     - tag of the key.
+static int index_tag(
+    MIMPI_Index_kind kind,
+    int tag
+) {
+    return kind == MIMPI_ANY_TAG_INDEX ? MIMPI_ANY_TAG : tag;
+}
+
+
+/// @brief Appends an element to the queue, keeping per-key FIFO order.
+///
+/// @param q - pointer to the queue.
+/// @param el - pointer to the element to be added.
+static void queue_push(
+    queue* q,
+    elem* el
+) {
+    push_front(q->arrivals, el);
+    q->length++;
+
+    for (int kind = 0; kind < MIMPI_INDEX_KINDS; kind++) {
+        hash_index* idx = &q->indices[kind];
+        int tag = index_tag(kind, el->message->tag);
+        bucket** link = find_slot(idx, tag, el->message->count);
+
+        if (*link == NULL) {
+            bucket* b = (bucket*)malloc(sizeof(bucket));
+            ASSERT_MALLOC(b);
+
+            *b = (bucket) {.chain = NULL, .tag = tag, .count = el->message->count, .first = NULL, .last = NULL};
+            *link = b;
+
+            if (++idx->size > idx->capacity) {
+                grow_index(idx);
+            }
+
+            link = find_slot(idx, tag, el->message->count);
+        }
+
+        bucket* b = *link;
+
+        el->key_bucket[kind] = b;
+        el->key_prev[kind] = b->last;
+        el->key_next[kind] = NULL;
+
+        if (b->last)
+            b->last->key_next[kind] = el;
+        else
+            b->first = el;
+
+        b->last = el;
+    }
+}
+
+
+/// @brief Finds the oldest element in the queue matching the tag and count.
+///
+/// @param q - pointer to the queue.
+/// @param tag - tag to be matched, MIMPI_ANY_TAG matches any tag.
+/// @param count - count to be matched.
+///
+/// @return elem*:
+///     - pointer to the found element, NULL otherwise.
+static elem* queue_find(
+    queue* q,
+    int tag,
+    int count
+) {
+    MIMPI_Index_kind kind = (tag == MIMPI_ANY_TAG) ? MIMPI_ANY_TAG_INDEX : MIMPI_EXACT_INDEX;
+    bucket* b = *find_slot(&q->indices[kind], tag, count);
+
+    return b ? b->first : NULL;
+}
+
+
+/// @brief Takes an element out of the queue and its indices without deleting it.
+///
+/// @param q - pointer to the queue.
+/// @param el - pointer to the element to be taken out.
+static void queue_detach(
+    queue* q,
+    elem* el
+) {
+    for (int kind = 0; kind < MIMPI_INDEX_KINDS; kind++) {
+        bucket* b = el->key_bucket[kind];
+
+        if (el->key_prev[kind])
+            el->key_prev[kind]->key_next[kind] = el->key_next[kind];
+        else
+            b->first = el->key_next[kind];
+
+        if (el->key_next[kind])
+            el->key_next[kind]->key_prev[kind] = el->key_prev[kind];
+        else
+            b->last = el->key_prev[kind];
+
+        if (b->first == NULL) {
+            hash_index* idx = &q->indices[kind];
+            bucket** link = find_slot(idx, b->tag, b->count);
+
+            *link = b->chain;
+            idx->size--;
+            free(b);
+        }
+    }
+
+    unlink_from_list(el);
+    q->length--;
+}
+
+
+#ifdef MIMPI_STATS
+/// @brief Checks whether messages with the tag belong to deadlock detection.
+///
+/// @param tag - tag of the message.
+///
+/// @return bool:
+///     - true if the message is a report of a receive, of arrivals or of a deadlock.
+static bool is_control_tag(
+    int tag
+) {
+    return tag == MIMPI_WAITING_TAG || tag == MIMPI_RECEIVED_TAG || tag == MIMPI_DEADLOCK_TAG;
+}
+#endif
+
+
+/// @brief Writes scattered data to the channel of a destination.
+///
+/// Partial writes are resumed from the first byte not yet written.
+///
+/// @param destination - rank of the receiver.
+/// @param iov - buffers to be written, consumed while writing.
+/// @param iovcnt - number of buffers.
+///
+/// @return bool:
+///     - true if the write was successful, false otherwise.
+static bool write_to_channel(
+    int destination,
+    struct iovec* iov, 
+    int iovcnt
+) {
+    const int fd = calculate_file_descriptor(MIMPI_size, destination, MIMPI_rank) + 1;
+    peer* pr = &MIMPI_peers[destination];
+
+    while (iovcnt > 0 && iov->iov_len == 0) {
+        iov++;
+        iovcnt--;
+    }
+
+    while (iovcnt > 0) {
+        int current_wrote = chsendv(fd, iov, iovcnt);
+        STATS_ADD(MIMPI_stats.send_calls, 1);
+        
+        if (current_wrote <= 0) {
+            return false;
+        }
+
+        atomic_fetch_add(&pr->bytes_written, current_wrote);
+        size_t left = current_wrote;
+
+        while (iovcnt > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+
+    return true;
+}
+
+
+/// @brief Writes a frame to a channel, handing the pages of its payload to the pipe instead of copying them.
+///
+/// The pipe only references the payload, so the caller has to wait with chdrain until the receiver
+/// has read the written bytes of the destination up to the end of the frame before the payload may
+/// change. If the kernel cannot splice, the rest of the payload is copied as by @ref write_to_channel.
+///
+/// @param destination - rank of the receiver, whose send mutex is held by the caller.
+/// @param header - pointer to the header of the frame.
+/// @param data - payload of the frame.
+/// @param length - number of bytes in the payload.
+///
+/// @return bool:
+///     - true if the write was successful, false otherwise.
+static bool splice_to_channel(
+    int destination,
+    const frame_header* header,
+    void const* data,
+    size_t length
+) {
+    struct iovec head = {.iov_base = (void*)header, .iov_len = header_size(header)};
+    struct iovec payload = {.iov_base = (void*)data, .iov_len = length};
+
+    const int fd = calculate_file_descriptor(MIMPI_size, destination, MIMPI_rank) + 1;
+
+    if (!write_to_channel(destination, &head, 1))
+        return false;
+
+    while (payload.iov_len > 0 && atomic_load(&MIMPI_splice_supported)) {
+        int spliced = chvmsplice(fd, &payload, 1);
+        STATS_ADD(MIMPI_stats.send_calls, 1);
+
+        if (spliced < 0 && (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) {
+            atomic_store(&MIMPI_splice_supported, false);
+        }
+        else if (spliced <= 0) {
+            return false;
+        }
+        else {
+            atomic_fetch_add(&MIMPI_peers[destination].bytes_written, spliced);
+            payload.iov_base = (char*)payload.iov_base + spliced;
+            payload.iov_len -= spliced;
+        }
+    }
+
+    return write_to_channel(destination, &payload, 1);
+}
+
+
+/// @brief Writes data to the channel of the destination, or queues it for the writer thread in buffered mode.
+///
+/// Queued data is copied, a sender blocks only while queued frames take all of the
+/// send buffer. Data larger than the whole buffer waits for the buffer to empty.
+///
+/// @param destination - rank of the receiver, whose send mutex is held by the caller.
+/// @param iov - buffers to be written, consumed while writing.
+/// @param iovcnt - number of buffers.
+///
+/// @return bool:
+///     - true if the data has been written or queued, false if writing to the destination has failed.
+static bool send_to_channel(
+    int destination,
+    struct iovec* iov,
+    int iovcnt
+) {
+    if (MIMPI_send_buffer == 0) {
+        return write_to_channel(destination, iov, iovcnt);
+    }
+
+    peer* pr = &MIMPI_peers[destination];
+    size_t length = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+        length += iov[i].iov_len;
+
+    outgoing* out = (outgoing*)malloc(sizeof(outgoing) + length);
+    ASSERT_MALLOC(out);
+    out->next = NULL;
+    out->length = 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0)
+            memcpy(out->data + out->length, iov[i].iov_base, iov[i].iov_len);
+        out->length += iov[i].iov_len;
+    }
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_send_buffer_mutex));
+
+    while (!pr->out_broken && MIMPI_send_buffered > 0 && MIMPI_send_buffered + length > MIMPI_send_buffer) {
+        ASSERT_ZERO(pthread_cond_wait(&MIMPI_send_buffer_cond, &MIMPI_send_buffer_mutex));
+    }
+
+    const bool queued = !pr->out_broken;
+
+    if (queued) {
+        if (pr->out_last != NULL)
+            pr->out_last->next = out;
+        else
+            pr->out_first = out;
+        pr->out_last = out;
+        MIMPI_send_buffered += length;
+        ASSERT_ZERO(pthread_cond_signal(&pr->out_cond));
+    }
+    else {
+        free(out);
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_send_buffer_mutex));
+    return queued;
+}
+
+
+/// @brief Writes the frames queued for a destination, until told to stop when none are left.
+///
+/// Once a write fails, the rest of the frames is dropped and later sends to the destination fail.
+///
+/// @param data - pointer to the data containing the destination's rank.
+static void* write_channel(
+    void* data
+) {
+    const int destination = *((int*)data);
+    free(data);
+
+    if (MIMPI_tracing) {
+        char name[32];
+        ASSERT_SPRINTF(sprintf(name, "writer %d", destination));
+        trace_thread_name(name);
+    }
+
+    peer* pr = &MIMPI_peers[destination];
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_send_buffer_mutex));
+
+    while (true) {
+        while (pr->out_first == NULL && !MIMPI_writers_stopping) {
+            ASSERT_ZERO(pthread_cond_wait(&pr->out_cond, &MIMPI_send_buffer_mutex));
+        }
+
+        outgoing* out = pr->out_first;
+        if (out == NULL)
+            break;
+
+        // Only this thread sets the flag, so it is read without the lock.
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_send_buffer_mutex));
+
+        struct iovec iov = {.iov_base = out->data, .iov_len = out->length};
+        const bool written = !pr->out_broken && write_to_channel(destination, &iov, 1);
+
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_send_buffer_mutex));
+
+        pr->out_first = out->next;
+        if (pr->out_first == NULL)
+            pr->out_last = NULL;
+        pr->out_broken |= !written;
+        MIMPI_send_buffered -= out->length;
+        ASSERT_ZERO(pthread_cond_broadcast(&MIMPI_send_buffer_cond));
+        free(out);
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_send_buffer_mutex));
+    return NULL;
+}
+
+
+/// @brief Writes the frames coalesced for the destination.
+///
+/// @param destination - rank of the receiver, whose send mutex is held by the caller.
+///
+/// @return bool:
+///     - true if the write was successful, false otherwise.
+static bool write_batch(
+    int destination
+) {
+    peer* pr = &MIMPI_peers[destination];
+    if (pr->batch_used == 0)
+        return true;
+
+    struct iovec iov = {.iov_base = pr->batch, .iov_len = pr->batch_used};
+
+    pr->batch_used = 0;
+    return send_to_channel(destination, &iov, 1);
+}
+
+
+/// @brief Compresses the payload of a frame, if that makes it smaller.
+///
+/// @param header - pointer to the header of the frame, marked compressed if the payload is.
+/// @param data - payload of the frame.
+/// @param length - number of bytes in the payload.
+///
+/// @return void*:
+///     - the compressed payload of `header->packed` bytes, to be freed by the caller.
+///     - NULL if the payload is to be sent as it is.
+static void* compress_payload(
+    frame_header* header,
+    void const* data,
+    size_t length
+) {
+#ifdef MIMPI_COMPRESSION
+    uLongf packed = compressBound(length);
+    void* buffer = malloc(packed);
+    ASSERT_MALLOC(buffer);
+
+    // Payloads which do not shrink, like already compressed ones, are not worth inflating.
+    if (compress2(buffer, &packed, data, length, Z_BEST_SPEED) != Z_OK || packed >= length) {
+        free(buffer);
+        return NULL;
+    }
+
+    header->flags |= FRAME_COMPRESSED | FRAME_VALUE;
+    header->packed = packed;
+    return buffer;
+#else
+    return NULL;
+#endif
+}
+
+
+/// @brief Inflates a compressed payload which has been read completely.
+///
+/// @param sender - rank of the sender.
+/// @param destination - buffer of the payload, of `count` bytes.
+/// @param count - number of bytes of the payload.
+/// @param packed - compressed payload.
+/// @param packed_count - number of bytes of the compressed payload.
+static void decompress_payload(
+    int sender,
+    void* destination,
+    size_t count,
+    void const* packed,
+    size_t packed_count
+) {
+#ifdef MIMPI_COMPRESSION
+    uLongf inflated = count;
+
+    if (uncompress(destination, &inflated, packed, packed_count) != Z_OK || inflated != count)
+        fatal("Compressed payload of %zu bytes from %d is corrupt", count, sender);
+#else
+    fatal("Compressed payload from %d, but compression is not compiled in", sender);
+#endif
+}
+
+
+/// @brief Writes a single frame to the channel of the destination.
+///
+/// Frames fitting in the batch of the destination may be coalesced with others
+/// and written later, frames are never reordered. Payloads from the compression
+/// threshold on go compressed.
+///
+/// @param destination - rank of the receiver.
+/// @param header - pointer to the header of the frame.
+/// @param data - payload of the frame, of `count` bytes if the header has FRAME_PAYLOAD.
+/// @param coalesce - flag whether the frame may be coalesced.
+///
+/// @return bool:
+///     - true if the write was successful (or the frame was coalesced), false otherwise.
+static bool write_frame(
+    int destination,
+    const frame_header* header,
+    void const* data,
+    bool coalesce
+) {
+    const int fd_num = calculate_file_descriptor(MIMPI_size, destination, MIMPI_rank) + 1;
+    peer* pr = &MIMPI_peers[destination];
+    size_t length = header->flags & FRAME_PAYLOAD ? (size_t)header->count : 0;
+    frame_header compressed;
+    void* packed = NULL;
+    bool written = true;
+    bool spliced = false;
+    size_t spliced_end = 0;     // Bytes written to the channel up to the end of the spliced frame.
+
+    if (MIMPI_compress_threshold > 0 && length >= MIMPI_compress_threshold) {
+        compressed = *header;
+        packed = compress_payload(&compressed, data, length);
+
+        if (packed != NULL) {
+            header = &compressed;
+            data = packed;
+            length = compressed.packed;
+        }
+    }
+
+    const size_t head = header_size(header);
+    const size_t frame = head + length;
+
+    STATS_ADD(pr->stats.messages_sent, 1);
+    STATS_ADD(pr->stats.bytes_sent, length);
+    STATS_ADD(MIMPI_stats.control_sent, is_control_tag(frame_tag(header)));
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->send_mutex));
+
+    if (coalesce && pr->batch != NULL && frame <= MIMPI_coalesce_size) {
+        if (frame > MIMPI_coalesce_size - pr->batch_used) {
+            written = write_batch(destination);
+        }
+
+        memcpy(pr->batch + pr->batch_used, header, head);
+        if (length > 0)
+            memcpy(pr->batch + pr->batch_used + head, data, length);
+        pr->batch_used += frame;
+    }
+    else if (MIMPI_splice_threshold > 0 && length >= MIMPI_splice_threshold && atomic_load(&MIMPI_splice_supported)
+             && pr->send_pipe_size > 0) { // Only pipes can be spliced into, not TCP channels.
+        written = write_batch(destination) && splice_to_channel(destination, header, data, length);
+        spliced = true;
+        spliced_end = atomic_load(&pr->bytes_written);
+    }
+    else {
+        struct iovec iov[2] = {
+            {.iov_base = (void*)header, .iov_len = head},
+            {.iov_base = (void*)data, .iov_len = length},
+        };
+
+        written = write_batch(destination) && send_to_channel(destination, iov, 2);
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->send_mutex));
+
+    // Other senders may write to the channel while this one waits for its spliced payload to be read,
+    // their frames come after it, so they do not prolong the wait.
+    if (spliced && written)
+        written = chdrain(fd_num, &pr->bytes_written, spliced_end) == 0;
+
+    free(packed);
+    return written;
+}
+
+
+/// @brief Writes the frames coalesced for all destinations, ignoring processes which have left.
+static void flush_batches() {
+    if (MIMPI_coalesce_size > 0)
+        MIMPI_Flush();
+}
+
+
+/* Number of bytes processed at once by reduction kernels. */
+#define REDUCE_VECTOR_SIZE 32
+
+
+/* Reduction kernels are compiled for AVX2 and for the baseline ISA, the best one is picked at load time. */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define REDUCE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define REDUCE_KERNEL
+#endif
+
+
+/* One step of a reduction over whole vectors (vector) and over single elements (scalar). */
+#define REDUCE_SUM_VECTOR(x, y, mask) ((x) + (y))
+#define REDUCE_SUM_SCALAR(x, y) ((x) + (y))
+#define REDUCE_PROD_VECTOR(x, y, mask) ((x) * (y))
+#define REDUCE_PROD_SCALAR(x, y) ((x) * (y))
+#define REDUCE_MAX_VECTOR(x, y, mask) REDUCE_SELECT((x) > (y), x, y, mask)
+#define REDUCE_MAX_SCALAR(x, y) MAX(x, y)
+#define REDUCE_MIN_VECTOR(x, y, mask) REDUCE_SELECT((x) < (y), x, y, mask)
+#define REDUCE_MIN_SCALAR(x, y) MIN(x, y)
+
+/* Picks lanes of x where the comparison holds and lanes of y elsewhere. */
+#define REDUCE_SELECT(comparison, x, y, mask) \
+    ((__typeof__(x))((((mask)(comparison)) & (mask)(x)) | (~((mask)(comparison)) & (mask)(y))))
+
+
+/* Defines a kernel combining `count` elements of `in` into `inout` with the given operation. */
+#define DEFINE_REDUCE_KERNEL(name, type, mask_type, OP)                                      \
+    static REDUCE_KERNEL void name(                                                          \
+        void* inout,                                                                         \
+        const void* in,                                                                      \
+        size_t count                                                                         \
+    ) {                                                                                      \
+        typedef type vector __attribute__((vector_size(REDUCE_VECTOR_SIZE)));                \
+        typedef mask_type mask __attribute__((vector_size(REDUCE_VECTOR_SIZE), unused));     \
+        const size_t lanes = REDUCE_VECTOR_SIZE / sizeof(type);                              \
+        type* a = inout;                                                                     \
+        const type* b = in;                                                                  \
+        size_t i = 0;                                                                        \
+                                                                                             \
+        for (; i + lanes <= count; i += lanes) {                                             \
+            vector x, y;                                                                     \
+            memcpy(&x, a + i, sizeof(vector));                                               \
+            memcpy(&y, b + i, sizeof(vector));                                               \
+            x = OP##_VECTOR(x, y, mask);                                                     \
+            memcpy(a + i, &x, sizeof(vector));                                               \
+        }                                                                                    \
+                                                                                             \
+        for (; i < count; i++) {                                                             \
+            a[i] = OP##_SCALAR(a[i], b[i]);                                                  \
+        }                                                                                    \
+    }
+
+/* Defines kernels of all operations for the given type. */
+#define DEFINE_REDUCE_KERNELS(name, type, mask_type)                                         \
+    DEFINE_REDUCE_KERNEL(reduce_max_##name, type, mask_type, REDUCE_MAX)                     \
+    DEFINE_REDUCE_KERNEL(reduce_min_##name, type, mask_type, REDUCE_MIN)                     \
+    DEFINE_REDUCE_KERNEL(reduce_sum_##name, type, mask_type, REDUCE_SUM)                     \
+    DEFINE_REDUCE_KERNEL(reduce_prod_##name, type, mask_type, REDUCE_PROD)
+
+DEFINE_REDUCE_KERNELS(u8, uint8_t, int8_t)
+DEFINE_REDUCE_KERNELS(i32, int32_t, int32_t)
+DEFINE_REDUCE_KERNELS(i64, int64_t, int64_t)
+DEFINE_REDUCE_KERNELS(f32, float, int32_t)
+DEFINE_REDUCE_KERNELS(f64, double, int64_t)
+
+
+/* Kernel combining `count` elements of one buffer into another. */
+typedef void (*reduce_kernel)(void* inout, const void* in, size_t count);
+
+
+/* Kernels indexed by datatype and operation. */
+static const reduce_kernel MIMPI_REDUCE_KERNELS[MIMPI_DATATYPES][MIMPI_OPS] = {
+    [MIMPI_UINT8] = {reduce_max_u8, reduce_min_u8, reduce_sum_u8, reduce_prod_u8},
+    [MIMPI_INT32] = {reduce_max_i32, reduce_min_i32, reduce_sum_i32, reduce_prod_i32},
+    [MIMPI_INT64] = {reduce_max_i64, reduce_min_i64, reduce_sum_i64, reduce_prod_i64},
+    [MIMPI_FLOAT] = {reduce_max_f32, reduce_min_f32, reduce_sum_f32, reduce_prod_f32},
+    [MIMPI_DOUBLE] = {reduce_max_f64, reduce_min_f64, reduce_sum_f64, reduce_prod_f64},
+};
+
+
+/* Sizes of elements of every datatype. */
+static const int MIMPI_DATATYPE_SIZES[MIMPI_DATATYPES] = {
+    [MIMPI_UINT8] = sizeof(uint8_t),
+    [MIMPI_INT32] = sizeof(int32_t),
+    [MIMPI_INT64] = sizeof(int64_t),
+    [MIMPI_FLOAT] = sizeof(float),
+    [MIMPI_DOUBLE] = sizeof(double),
+};
+
+
+/// @brief Calculates the tag of messages carrying partial results of a reduction.
+///
+/// @param datatype - type of the reduced elements.
+/// @param op - reduction operation.
+///
+/// @return int:
+///     - tag not greater than MIMPI_MAX_TAG (byte-wise reductions keep their old tags).
+static int reduce_tag(
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+) {
+    return MIMPI_MAX_TAG - (int)(datatype * MIMPI_OPS + op);
+}
+
+
+/// @brief Checks whether messages with the tag carry partial results of a reduction.
+///
+/// @param tag - tag of the message.
+///
+/// @return bool:
+///     - true if the tag was returned by @ref reduce_tag.
+static bool is_reduce_tag(
+    int tag
+) {
+    tag = world_tag(tag);
+
+    return tag <= MIMPI_MAX_TAG && tag >= MIMPI_LAST_REDUCE_TAG;
+}
+
+
+/// @brief Handles a reduce operation based on the tag.
+///
+/// @param received_data - pointer to the data received.
+/// @param count - number of bytes in the data.
+/// @param tag - tag of the reduction, as returned by @ref reduce_tag, or the one a group uses in its place.
+/// @param data - pointer to the data to be applied in the reduce operation.
+static void handle_reduce_operation(
+    void* received_data,
+    int count,
+    int tag,
+    void* data
+) {
+    const int encoded = MIMPI_MAX_TAG - world_tag(tag);
+    const MIMPI_Datatype datatype = encoded / MIMPI_OPS;
+    const MIMPI_Op op = encoded % MIMPI_OPS;
+
+    MIMPI_REDUCE_KERNELS[datatype][op](data, received_data, count / MIMPI_DATATYPE_SIZES[datatype]);
+}
+
+
+/// @brief Determines the greatest power of 2 not exceeding the given rank.
+///
+/// @param rank - rank of the process.
+///
+/// @return int:
+///     - power of 2 associated with the rank.
+static int get_power(
+    int rank
+) {
+    if (rank <= 1) return rank;
+
+    int power = 1;
+    while (power <= rank / 2) {
+        power *= 2;
+    }
+
+    return power;
+}
+
+
+/// @brief Computes the place of a process in the binomial tree rooted at the root.
+///
+/// The tree is the one rooted at 0 with the root and 0 swapped.
+///
+/// @param plan - pointer to the schedule to be filled.
+/// @param root - rank of the root process.
+/// @param world_rank - rank of the current process.
+/// @param world_size - total number of processes.
+static void build_schedule(
+    schedule* plan,
+    int root,
+    int world_rank,
+    int world_size
+) {
+    int receive_from = world_rank - get_power(world_rank);
+    int power = get_power(world_rank) * 2;
+    int start_from = world_rank + power;
+
+    if (world_rank == root) {
+        power = 1;
+        start_from = 1;
+    }
+    else if (world_rank == 0) {
+        receive_from = root - get_power(root);
+        power = get_power(root) * 2;
+        start_from = root + power;
+    }
+
+    plan->children_count = 0;
+
+    while (start_from < world_size) {
+        plan->children[plan->children_count++] = (start_from == root) ? 0 : start_from;
+
+        start_from += power;
+        power *= 2;
+    }
+
+    if (world_rank == root) {
+        plan->parent = -1;
+    }
+    else if (receive_from == root) {
+        plan->parent = 0;
+    }
+    else if (receive_from == 0) {
+        plan->parent = root;
+    }
+    else {
+        plan->parent = receive_from;
+    }
+}
+
+
+/// @brief Computes the place of a process in the tree of the given arity rooted at 0.
+///
+/// Children of process i are processes k * i + 1 up to k * i + k.
+///
+/// @param plan - pointer to the schedule to be filled.
+/// @param arity - maximal number of children of a process.
+/// @param world_rank - rank of the current process.
+/// @param world_size - total number of processes.
+static void build_kary_schedule(
+    schedule* plan,
+    int arity,
+    int world_rank,
+    int world_size
+) {
+    plan->parent = world_rank > 0 ? (world_rank - 1) / arity : -1;
+    plan->children_count = 0;
+
+    for (long child = (long)arity * world_rank + 1; child <= (long)arity * world_rank + arity && child < world_size; child++) {
+        plan->children[plan->children_count++] = child;
+    }
+}
+
+
+/// @brief Computes the place of a process in the two-level tree of a group spread over several nodes.
+///
+/// Leaders of nodes (the root in its own node, the lowest rank in the others) form
+/// a binomial tree rooted at the root, and processes of every node a binomial tree
+/// rooted at its leader. A message then crosses between nodes once for every node,
+/// and leaders serve other nodes before their own.
+///
+/// @param plan - pointer to the schedule to be filled.
+/// @param root - rank of the root process.
+/// @param comm - group the tree spans.
+/// @param node - node of every process of the group.
+/// @param lowest - lowest rank of the node of every process of the group.
+static void build_hierarchical_schedule(
+    schedule* plan,
+    int root,
+    const communicator* comm,
+    const int* node,
+    const int* lowest
+) {
+    const int me = comm->rank;
+    const int leader = node[me] == node[root] ? root : lowest[me];
+
+    // Trees are built over positions in these lists, the root of each one goes first.
+    int* leaders = (int*)malloc(comm->size * sizeof(int));
+    int* members = (int*)malloc(comm->size * sizeof(int));
+    ASSERT_MALLOC(leaders);
+    ASSERT_MALLOC(members);
+
+    int leader_count = 1, member_count = 1, leader_position = 0, member_position = 0;
+    leaders[0] = root;
+    members[0] = leader;
+
+    for (int i = 0; i < comm->size; i++) {
+        if (i == lowest[i] && node[i] != node[root]) {
+            leader_position = i == me ? leader_count : leader_position;
+            leaders[leader_count++] = i;
+        }
+        if (node[i] == node[me] && i != leader) {
+            member_position = i == me ? member_count : member_position;
+            members[member_count++] = i;
+        }
+    }
+
+    schedule inner;
+    build_schedule(&inner, 0, member_position, member_count);
+
+    plan->parent = inner.parent >= 0 ? members[inner.parent] : -1;
+    plan->children_count = 0;
+
+    if (me == leader) {
+        schedule outer;
+        build_schedule(&outer, 0, leader_position, leader_count);
+
+        plan->parent = outer.parent >= 0 ? leaders[outer.parent] : -1;
+        for (int i = 0; i < outer.children_count; i++) {
+            plan->children[plan->children_count++] = leaders[outer.children[i]];
+        }
+    }
+
+    for (int i = 0; i < inner.children_count; i++) {
+        plan->children[plan->children_count++] = members[inner.children[i]];
+    }
+
+    free(leaders);
+    free(members);
+}
+
+
+/// @brief Plans trees of collectives of a group, once its rank and size are known.
+///
+/// A group spread over several nodes (see @ref NODES_VAR) also gets two-level trees,
+/// which barriers, broadcasts and reductions follow. Gathers and scatters keep to binomial
+/// trees, whose subtrees they compute the sizes of.
+///
+/// @param comm - group to be planned.
+static void plan_group(
+    communicator* comm
+) {
+    // Trees of group functions depend only on the root, so they are planned once for every root.
+    comm->schedules = (schedule*)malloc(comm->size * sizeof(schedule));
+    ASSERT_MALLOC(comm->schedules);
+
+    int* node = (int*)malloc(comm->size * sizeof(int));
+    int* lowest = (int*)malloc(comm->size * sizeof(int));
+    ASSERT_MALLOC(node);
+    ASSERT_MALLOC(lowest);
+
+    bool spread = false;
+
+    for (int i = 0; i < comm->size; i++) {
+        node[i] = MIMPI_nodes != NULL ? MIMPI_nodes[comm->ranks[i]] : 0;
+        lowest[i] = i;
+
+        for (int j = 0; j < i && lowest[i] == i; j++) {
+            lowest[i] = node[j] == node[i] ? j : i;
+        }
+        spread |= node[i] != node[0];
+    }
+
+    comm->node_schedules = NULL;
+    if (spread) {
+        comm->node_schedules = (schedule*)malloc(comm->size * sizeof(schedule));
+        ASSERT_MALLOC(comm->node_schedules);
+    }
+
+    for (int root = 0; root < comm->size; root++) {
+        build_schedule(&comm->schedules[root], root, comm->rank, comm->size);
+
+        if (spread) {
+            build_hierarchical_schedule(&comm->node_schedules[root], root, comm, node, lowest);
+        }
+    }
+
+    free(node);
+    free(lowest);
+
+    if (MIMPI_barrier_algorithm == BARRIER_KARY) {
+        build_kary_schedule(&comm->barrier_tree, MIMPI_barrier_arity, comm->rank, comm->size);
+    }
+}
+
+
+/// @brief Sends data to a process of a group, under the tag the group uses in place of the given one.
+///
+/// @param comm - group of the processes.
+/// @param data - data to be sent.
+/// @param count - number of bytes of data.
+/// @param rank - rank of the receiver in the group.
+/// @param tag - tag of world collectives.
+///
+/// @return MIMPI_Retcode:
+///     - result of @ref MIMPI_Send.
+static MIMPI_Retcode group_send(
+    const communicator* comm,
+    void const* data,
+    int count,
+    int rank,
+    int tag
+) {
+    return MIMPI_Send(data, count, comm->ranks[rank], group_tag(comm, tag));
+}
+
+
+/// @brief Receives data from a process of a group, under the tag the group uses in place of the given one.
+///
+/// @param comm - group of the processes.
+/// @param data - place for the data.
+/// @param count - number of bytes of data.
+/// @param rank - rank of the sender in the group.
+/// @param tag - tag of world collectives.
+///
+/// @return MIMPI_Retcode:
+///     - result of @ref MIMPI_Recv.
+static MIMPI_Retcode group_recv(
+    const communicator* comm,
+    void* data,
+    int count,
+    int rank,
+    int tag
+) {
+    return MIMPI_Recv(data, count, comm->ranks[rank], group_tag(comm, tag));
+}
+
+
+/// @brief Passes messages up (gathering) or down (releasing) a tree.
+///
+/// @param comm - group the tree spans.
+/// @param data - pointer to the data for communication.
+/// @param count - number of bytes in the data.
+/// @param plan - place of the process in the tree.
+/// @param tag - identifier to be passed in communication.
+/// @param begin - flag whether messages go up to the root, rather than down from it.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode walk_tree(
+    const communicator* comm,
+    void* data,
+    int count,
+    const schedule* plan,
+    int tag,
+    bool begin
+) {
+    if (begin) {
+        for (int i = 0; i < plan->children_count; i++) {
+            HANDLE_REMOTE_FINISHED(group_recv(comm, data, count, plan->children[i], tag));
+        }
+
+        if (plan->parent >= 0) {
+            HANDLE_REMOTE_FINISHED(group_send(comm, data, count, plan->parent, tag));
+        }
+    }
+    else {
+        if (plan->parent >= 0) {
+            HANDLE_REMOTE_FINISHED(group_recv(comm, data, count, plan->parent, tag));
+        }
+
+        for (int i = 0; i < plan->children_count; i++) {
+            HANDLE_REMOTE_FINISHED(group_send(comm, data, count, plan->children[i], tag));
+        }
+    }
+
+    flush_batches();
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Finds the place of the process in the tree group functions rooted at a process use.
+///
+/// @param comm - group the function runs in.
+/// @param root - rank of the root process.
+///
+/// @return const schedule*:
+///     - the place of the process in the tree.
+static const schedule* tree_plan(
+    const communicator* comm,
+    int root
+) {
+    return comm->node_schedules != NULL ? &comm->node_schedules[root] : &comm->schedules[root];
+}
+
+
+/// @brief Handles communication loop for group functions.
+///
+/// @param comm - group the function runs in.
+/// @param data - pointer to the data for communication.
+/// @param count - number of bytes in the data.
+/// @param root - rank of the root process.
+/// @param tag - identifier to be passed in communication.
+/// @param begin - flag indicating the start of the communication loop.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode communication_loop(
+    const communicator* comm,
+    void* data, 
+    int count, 
+    int root, 
+    int tag, 
+    bool begin
+) { 
+    return walk_tree(comm, data, count, tree_plan(comm, root), tag, begin);
+}
+
+
+/// @brief Translates a rank among the power-of-two group of an allreduce into a rank among all its processes.
+///
+/// The first 2 * extra processes are paired up and only the odd one of each pair
+/// joins the group, the remaining processes join it directly.
+///
+/// @param group_rank - rank in the group.
+/// @param extra - number of processes exceeding the power of two.
+///
+/// @return int:
+///     - rank in the world, or in the group the allreduce runs in.
+static int allreduce_world_rank(
+    int group_rank,
+    int extra
+) {
+    return group_rank < extra ? 2 * group_rank + 1 : group_rank + extra;
+}
+
+
+/// @brief Reduces the buffer among a power-of-two group by recursive doubling.
+///
+/// Every process exchanges its whole partial result with a partner in each of log(power) rounds.
+///
+/// @param comm - group the allreduce runs in.
+/// @param buffer - partial result, replaced with the final one.
+/// @param bytes - size of the buffer.
+/// @param tag - tag of the reduction.
+/// @param group_rank - rank in the group.
+/// @param power - size of the group.
+/// @param extra - number of processes exceeding the power of two.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode allreduce_recursive_doubling(
+    const communicator* comm,
+    char* buffer,
+    int bytes,
+    int tag,
+    int group_rank,
+    int power,
+    int extra
+) {
+    for (int distance = 1; distance < power; distance *= 2) {
+        const int partner = allreduce_world_rank(group_rank ^ distance, extra);
+
+        HANDLE_REMOTE_FINISHED(group_send(comm, buffer, bytes, partner, tag));
+        HANDLE_REMOTE_FINISHED(group_recv(comm, buffer, bytes, partner, tag));
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Reduces the buffer among a power-of-two group by reduce-scatter and allgather.
+///
+/// Recursive halving leaves every process with its own fully reduced block,
+/// then recursive doubling collects all blocks, so every process sends about twice the buffer.
+///
+/// @param comm - group the allreduce runs in.
+/// @param buffer - partial result, replaced with the final one.
+/// @param count - number of elements in the buffer (not less than @p power).
+/// @param element_size - size of a single element.
+/// @param tag - tag of the reduction.
+/// @param group_rank - rank in the group.
+/// @param power - size of the group.
+/// @param extra - number of processes exceeding the power of two.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode allreduce_rabenseifner(
+    const communicator* comm,
+    char* buffer,
+    int count,
+    int element_size,
+    int tag,
+    int group_rank,
+    int power,
+    int extra
+) {
+    int parent_lo[32], parent_hi[32];
+    int lo = 0, hi = count, level = 0;
+
+    for (int distance = power / 2; distance >= 1; distance /= 2, level++) {
+        const int partner = allreduce_world_rank(group_rank ^ distance, extra);
+        const int mid = lo + (hi - lo) / 2;
+        const bool lower = (group_rank & distance) == 0;
+
+        const int send_lo = lower ? mid : lo, send_hi = lower ? hi : mid;
+        const int keep_lo = lower ? lo : mid, keep_hi = lower ? mid : hi;
+
+        HANDLE_REMOTE_FINISHED(group_send(comm, buffer + send_lo * element_size, (send_hi - send_lo) * element_size, partner, tag));
+        HANDLE_REMOTE_FINISHED(group_recv(comm, buffer + keep_lo * element_size, (keep_hi - keep_lo) * element_size, partner, tag));
+
+        parent_lo[level] = lo;
+        parent_hi[level] = hi;
+        lo = keep_lo;
+        hi = keep_hi;
+    }
+
+    for (int distance = 1; distance < power; distance *= 2) {
+        const int partner = allreduce_world_rank(group_rank ^ distance, extra);
+        level--;
+
+        const int other_lo = lo == parent_lo[level] ? hi : parent_lo[level];
+        const int other_hi = lo == parent_lo[level] ? parent_hi[level] : lo;
+
+        // Partners exchange blocks at once, so neither send may wait for the partner's receive.
+        MIMPI_Request send;
+        HANDLE_REMOTE_FINISHED(MIMPI_Isend(buffer + lo * element_size, (hi - lo) * element_size, comm->ranks[partner], group_tag(comm, MIMPI_BROADCAST_TAG), &send));
+        MIMPI_Retcode received = group_recv(comm, buffer + other_lo * element_size, (other_hi - other_lo) * element_size, partner, MIMPI_BROADCAST_TAG);
+        HANDLE_REMOTE_FINISHED(MIMPI_Wait(&send));
+        HANDLE_REMOTE_FINISHED(received);
+
+        lo = parent_lo[level];
+        hi = parent_hi[level];
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Checks whether messages with the tag carry user data that can be delivered in place.
+///
+/// @param tag - tag of the message.
+///
+/// @return bool:
+///     - true if the payload is copied verbatim into the receiver's buffer.
+static bool is_plain_data_tag(
+    int tag
+) {
+    return tag >= MIMPI_ANY_TAG || world_tag(tag) == MIMPI_BROADCAST_TAG;
+}
+
+
+/// @brief Checks whether a message is announced first and sent only once a receive matches it.
+///
+/// @param count - number of bytes in the message data.
+/// @param tag - identifier of the message.
+///
+/// @return bool:
+///     - true if the message is sent by rendezvous, false if it is sent eagerly.
+static bool sent_by_rendezvous(
+    int count,
+    int tag
+) {
+    return count > MIMPI_eager_limit && is_plain_data_tag(tag);
+}
+
+
+/// @brief Queues a write for the rendezvous thread.
+///
+/// Readers must never block on writes, or two processes could block each other,
+/// so answers to announcements and the data of announced messages are written by a separate thread.
+///
+/// @param destination - rank of the process written to.
+/// @param tag - control tag of the frame written if there is no send.
+/// @param ticket - ticket of the announced message.
+/// @param send - send whose data is to be written, NULL to write a control frame.
+static void queue_rendezvous_job(
+    int destination,
+    int tag,
+    int ticket,
+    request* send
+) {
+    rendezvous_job* job = (rendezvous_job*)malloc(sizeof(rendezvous_job));
+    ASSERT_MALLOC(job);
+    *job = (rendezvous_job) {.next = NULL, .destination = destination, .tag = tag, .ticket = ticket, .send = send};
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+
+    // Clears would come after the notice that there are no more of them.
+    if (MIMPI_rendezvous_stopping || (tag == MIMPI_CLEAR_TO_SEND_TAG && MIMPI_clears_done)) {
+        free(job);
+    }
+    else {
+        if (MIMPI_rendezvous_last != NULL)
+            MIMPI_rendezvous_last->next = job;
+        else
+            MIMPI_rendezvous_first = job;
+        MIMPI_rendezvous_last = job;
+
+        ASSERT_ZERO(pthread_cond_signal(&MIMPI_rendezvous_cond));
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+}
+
+
+/// @brief Finds the request with the ticket in a list of requests.
+///
+/// @param l - pointer to the list linking requests by their posted elements.
+/// @param ticket - ticket of the announced message.
+///
+/// @return request*:
+///     - pointer to the found request, NULL otherwise.
+static request* find_ticket(
+    list* l,
+    int ticket
+) {
+    for (elem* current = l->tail->next; current != l->head; current = current->next) {
+        request* req = (request*)current->message;
+
+        if (req->ticket == ticket)
+            return req;
+    }
+
+    return NULL;
+}
+
+
+/// @brief Frees a send which has returned before its data was written, together with the copy of the data.
+///
+/// @param pr - peer the message is sent to, locked by the caller.
+/// @param req - pointer to the request describing the send, not linked into any list.
+static void free_detached(
+    peer* pr,
+    request* req
+) {
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+    MIMPI_rendezvous_buffered -= req->message.count;
+    ASSERT_ZERO(pthread_cond_broadcast(&MIMPI_rendezvous_buffer_cond));
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+
+    free(req->message.data);
+    free(req);
+    pr->detached_sends--;
+}
+
+
+/// @brief Frees the sends which have returned before their data was written, and will not be cleared any more.
+///
+/// @param pr - peer which has left or stopped clearing, locked by the caller.
+static void drop_detached(
+    peer* pr
+) {
+    elem* current = pr->announced_sends->tail->next;
+
+    while (current != pr->announced_sends->head) {
+        request* req = (request*)current->message;
+        current = current->next;
+
+        if (req->detached) {
+            unlink_from_list(&req->posted);
+            free_detached(pr, req);
+        }
+    }
+}
+
+
+/// @brief Matches a receive with an announced message and asks its sender for the data.
+///
+/// @param pr - peer the message comes from, locked by the caller.
+/// @param req - pointer to the request describing the receive.
+/// @param el - element of the announced message, deleted.
+static void clear_receive(
+    peer* pr,
+    request* req,
+    elem* el
+) {
+    req->ticket = el->message->ticket;
+    req->matched_tag = el->message->tag;
+    delete_elem(el);
+
+    push_front(pr->cleared, &req->posted);
+    queue_rendezvous_job(req->message.source, MIMPI_CLEAR_TO_SEND_TAG, req->ticket, NULL);
+}
+
+
+/// @brief Finds the oldest receive in a list of posted receives matched by a message.
+///
+/// @param posted - list of posted receives, oldest first.
+/// @param message - pointer to the message.
+///
+/// @return elem*:
+///     - pointer to the element of the posted receive, NULL if none matches.
+static elem* find_posted_in(
+    list* posted,
+    Message* message
+) {
+    for (elem* current = posted->tail->next; current != posted->head; current = current->next) {
+        if (compare_message(message, current->message))
+            return current;
+    }
+
+    return NULL;
+}
+
+
+/// @brief Finds the oldest posted receive matched by a message.
+///
+/// @param pr - peer the message comes from, locked by the caller.
+/// @param message - pointer to the message.
+///
+/// @return elem*:
+///     - pointer to the element of the posted receive, NULL if none matches.
+static elem* find_posted(
+    peer* pr,
+    Message* message
+) {
+    return find_posted_in(pr->posted, message);
+}
+
+
+/// @brief Takes the oldest receive matched by a message, posted on its source or for any source.
+///
+/// A receive for any source taken is bound to the source of the message.
+///
+/// @param pr - peer the message comes from, locked by the caller.
+/// @param message - pointer to the message.
+/// @param in_place - flag whether the receive is only taken if the message can be read into its buffer.
+///
+/// @return request*:
+///     - pointer to the taken receive, NULL if none matches.
+static request* take_posted(
+    peer* pr,
+    Message* message,
+    bool in_place
+) {
+    elem* el = find_posted(pr, message);
+    request* req = el != NULL ? (request*)el->message : NULL;
+
+    if (atomic_load(&MIMPI_any_pending) > 0) {
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+
+        elem* any = find_posted_in(MIMPI_any_posted, message);
+        request* any_req = any != NULL ? (request*)any->message : NULL;
+
+        if (any_req != NULL && (req == NULL || any_req->posted_order < req->posted_order)) {
+            if (in_place && any_req->message.data == NULL) {
+                any_req = NULL;
+            }
+            else {
+                unlink_from_list(any);
+                any_req->message.source = message->source;
+                atomic_fetch_sub(&MIMPI_any_pending, 1);
+                ASSERT_ZERO(pthread_cond_broadcast(&MIMPI_any_cond));
+            }
+
+            ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+            return any_req;
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+    }
+
+    if (req == NULL || (in_place && req->message.data == NULL))
+        return NULL;
+
+    unlink_from_list(el);
+    return req;
+}
+
+
+/// @brief Wakes up receives posted on a process, blocked or spinning.
+///
+/// @param pr - peer the receives are posted on, locked by the caller.
+static void wake_receivers(
+    peer* pr
+) {
+    atomic_fetch_add_explicit(&pr->wakeups, 1, memory_order_release);
+    ASSERT_ZERO(pthread_cond_broadcast(&pr->cond));
+}
+
+
+/// @brief Claims a posted receive for a message whose header has just arrived.
+///
+/// When successful, the caller must read the payload into the buffer of the
+/// returned receive and then call @ref complete_claimed.
+///
+/// @param sender - rank of the sender.
+/// @param count - number of bytes in the message data.
+/// @param tag - identifier of the message.
+///
+/// @return Message*:
+///     - pointer to the claimed receive, NULL if none could be claimed.
+static Message* claim_posted(
+    int sender,
+    int count,
+    int tag
+) {
+    peer* pr = &MIMPI_peers[sender];
+    if (!is_plain_data_tag(tag))
+        return NULL;
+
+    Message arrived = {.tag = tag, .count = count, .source = sender};
+    Message* claimed = NULL;
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    request* req = take_posted(pr, &arrived, true);
+    if (req != NULL) {
+        claimed = &req->message;
+        claimed->claimed = true;
+        req->matched_tag = tag;
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+    return claimed;
+}
+
+
+/// @brief Claims the receive cleared for the data of an announced message which has started to arrive.
+///
+/// @param sender - rank of the sender.
+/// @param ticket - ticket of the announced message.
+///
+/// @return Message*:
+///     - pointer to the claimed receive.
+static Message* claim_cleared(
+    int sender,
+    int ticket
+) {
+    peer* pr = &MIMPI_peers[sender];
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    request* req = find_ticket(pr->cleared, ticket);
+    if (req == NULL)
+        fatal("Data of message %d from %d arrived uncleared", ticket, sender);
+
+    unlink_from_list(&req->posted);
+    req->message.claimed = true;
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+    return &req->message;
+}
+
+
+/// @brief Wakes up the receiver after its buffer has been filled in place.
+///
+/// @param sender - rank of the sender.
+/// @param claimed - pointer to the receive returned by @ref claim_posted.
+/// @param tag - tag of the frame the data came in.
+static void complete_claimed(
+    int sender,
+    Message* claimed,
+    int tag
+) {
+    peer* pr = &MIMPI_peers[sender];
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    if (tag >= MIMPI_ANY_TAG)
+        pr->arrived++;
+    claimed->received = true;
+    wake_receivers(pr);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+}
+
+
+/// @brief Fails the receive the user thread is blocked on because of a deadlock.
+///
+/// @param pr - peer the receive is posted on, locked by the caller.
+///
+/// @return bool:
+///     - true if a receive has been failed, false otherwise.
+static bool fail_blocked(
+    peer* pr
+) {
+    request* blocked = pr->blocked;
+
+    if (blocked == NULL || blocked->message.received || blocked->message.claimed || blocked->ticket != NO_TICKET)
+        return false;
+
+    unlink_from_list(&blocked->posted);
+    blocked->result = MIMPI_ERROR_DEADLOCK_DETECTED;
+    blocked->message.received = true;
+    return true;
+}
+
+
+/// @brief Drops messages known to have arrived from the log of messages sent to a process.
+///
+/// @param pr - peer the messages were sent to, locked by the caller.
+/// @param arrived - number of the first messages sent which the process has read.
+static void forget_arrived(
+    peer* pr,
+    int arrived
+) {
+    pr->logged = MIN(pr->logged, pr->sent - arrived);
+}
+
+
+/// @brief Finds a message among the ones in the sent log of a process.
+///
+/// @param pr - peer the messages were sent to, locked by the caller.
+/// @param tag - identifier of the message, MIMPI_ANY_TAG for any.
+/// @param count - number of bytes in the message data.
+///
+/// @return bool:
+///     - true if such a message is in the log.
+static bool find_sent(
+    const peer* pr,
+    int tag,
+    int count
+) {
+    // Records are placed by the number of the message, modulo the capacity.
+    for (unsigned int number = pr->sent - pr->logged; number != (unsigned int)pr->sent; number++) {
+        const sent_record* record = &pr->sent_log[number & (pr->sent_capacity - 1)];
+
+        if (record->count == count && (tag == MIMPI_ANY_TAG || record->tag == tag)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/// @brief Queues or otherwise handles a message read completely from a channel.
+///
+/// @param sender - rank of the sender.
+/// @param header - pointer to the header of the frame.
+/// @param tag - tag the frame stands for, see @ref frame_tag.
+/// @param message_data - pooled payload of the message (NULL if it has none).
+static void dispatch_message(
+    int sender,
+    const frame_header* header,
+    int tag,
+    void* message_data
+) {
+    peer* pr = &MIMPI_peers[sender];
+    const bool waiting_tag = tag == MIMPI_WAITING_TAG, receive_tag = tag == MIMPI_RECEIVED_TAG;
+    const bool clear_tag = tag == MIMPI_CLEAR_TO_SEND_TAG, announced = tag == MIMPI_REQUEST_TO_SEND_TAG;
+    const int arrived = waiting_tag || receive_tag ? (int)header->value : 0;
+    const int count = header->count;
+
+    // Reports and announcements are about the message of the header.
+    if (waiting_tag || announced) {
+        tag = header->tag;
+    }
+
+    elem *el = create_pooled_elem(&pr->pool, tag, count, sender, message_data);
+    Message *message = el->message;
+    message->announced = announced;
+    message->ticket = announced ? (int)header->value : 0;
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+    
+    if (clear_tag) {
+        const int ticket = header->value;
+        request* send = find_ticket(pr->announced_sends, ticket);
+
+        if (send != NULL) {
+            unlink_from_list(&send->posted);
+            send->message.claimed = true;
+            queue_rendezvous_job(sender, MIMPI_RENDEZVOUS_DATA_TAG, ticket, send);
+        }
+
+        delete_elem(el);
+    }
+    else if (tag == MIMPI_CLEARS_DONE_TAG) {
+        pr->stopped_clearing = true;
+        drop_detached(pr);
+        wake_receivers(pr);
+
+        delete_elem(el);
+    }
+    else if (tag == MIMPI_DEADLOCK_TAG) {
+        fail_blocked(pr);
+        push_front(pr->others_recv, el);
+
+        wake_receivers(pr);
+    }
+    else if (waiting_tag) {
+        // Messages sent after the first ones the receiver has read are still on their way to it.
+        forget_arrived(pr, arrived);
+
+        if (!find_sent(pr, tag, count)) {
+            push_front(pr->others_recv, el);
+
+            if (fail_blocked(pr)) {
+                wake_receivers(pr);
+            }
+        }
+        else {
+            delete_elem(el);
+        }
+    }
+    else if (receive_tag) {
+        forget_arrived(pr, arrived);
+        delete_elem(el);
+    }
+    else {
+        if (tag >= MIMPI_ANY_TAG)
+            pr->arrived++;
+
+        request* req = take_posted(pr, message, false);
+
+        if (req != NULL) {
+            if (announced) {
+                clear_receive(pr, req, el);
+            }
+            else {
+                req->found = el;
+                req->matched_tag = tag;
+                req->message.received = true;
+
+                wake_receivers(pr);
+            }
+        }
+        else {
+            message->arrival = atomic_fetch_add(&MIMPI_arrivals, 1);
+            queue_push(pr->received_messages, el);
+            STATS_MAX(pr->stats.unexpected_high_water, pr->received_messages->length);
+
+            if (atomic_load(&MIMPI_probes) > 0) {
+                ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+                ASSERT_ZERO(pthread_cond_broadcast(&MIMPI_any_cond));
+                ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+            }
+        }
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+}
+
+
+/// @brief Prepares the buffer for the payload of a message whose header has been read.
+///
+/// @param sender - rank of the sender.
+///
+/// @return bool:
+///     - true if a payload has to be read, false if the message is already complete.
+static bool start_payload(
+    int sender
+) {
+    peer* pr = &MIMPI_peers[sender];
+    reader* r = &pr->reader;
+
+    if (r->header.version_kind >> 4 != FRAME_VERSION || (r->header.version_kind & 0xF) >= FRAME_KINDS) {
+        fatal("Frame of unknown version or kind %#x from %d", r->header.version_kind, sender);
+    }
+
+    const int count = r->header.count;
+    const int tag = frame_tag(&r->header);
+    r->count = count;
+    r->tag = tag;
+
+    if (tag == MIMPI_RENDEZVOUS_DATA_TAG) {
+        r->claimed = claim_cleared(sender, r->header.value);
+        r->count = r->claimed->count;
+        r->payload = r->claimed->data;
+    }
+    else {
+        r->claimed = claim_posted(sender, count, tag);
+
+        if (r->claimed != NULL) {
+            r->payload = r->claimed->data;
+        }
+        else if (r->header.flags & FRAME_PAYLOAD) {
+            r->payload = alloc_payload(&pr->pool, count);
+        }
+        else {
+            return false;
+        }
+    }
+
+    // A compressed payload is read aside and inflated into its buffer once complete.
+    if (r->header.flags & FRAME_COMPRESSED) {
+        r->unpacked = r->payload;
+        r->payload = alloc_payload(&pr->pool, r->header.packed);
+        r->count = r->header.packed;
+    }
+
+    return r->count > 0;
+}
+
+
+/// @brief Hands over a completely read message and prepares the reader for the next one.
+///
+/// @param sender - rank of the sender.
+static void finish_message(
+    int sender
+) {
+    peer* pr = &MIMPI_peers[sender];
+    reader* r = &pr->reader;
+
+    STATS_ADD(pr->stats.messages_received, 1);
+    STATS_ADD(pr->stats.bytes_received, r->payload_read);
+    STATS_ADD(MIMPI_stats.control_received, is_control_tag(r->tag));
+
+    if (r->unpacked != NULL) {
+        const size_t count = r->claimed != NULL ? (size_t)r->claimed->count : (size_t)r->header.count;
+
+        decompress_payload(sender, r->unpacked, count, r->payload, r->payload_read);
+        pool_release(r->payload);
+        r->payload = r->unpacked;
+        r->unpacked = NULL;
+    }
+
+    trace('B', "dispatch", sender, r->tag, r->payload_read);
+
+    if (r->claimed != NULL) {
+        complete_claimed(sender, r->claimed, r->tag);
+    }
+    else {
+        dispatch_message(sender, &r->header, r->tag, r->payload);
+    }
+
+    trace('E', "dispatch", sender, 0, 0);
+
+    r->header_read = 0;
+    r->payload = NULL;
+    r->payload_read = 0;
+    r->claimed = NULL;
+}
+
+
+/// @brief Marks the sender as having left once its channel has been closed.
+///
+/// @param sender - rank of the sender.
+static void close_reader(
+    int sender
+) {
+    peer* pr = &MIMPI_peers[sender];
+    reader* r = &pr->reader;
+
+    if (r->unpacked != NULL) {
+        pool_release(r->payload);
+        r->payload = r->unpacked;
+        r->unpacked = NULL;
+    }
+
+    if (r->claimed == NULL)
+        pool_release(r->payload);
+    r->payload = NULL;
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+    
+    pr->already_left = true;
+    drop_detached(pr);
+    wake_receivers(pr);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+
+    MIMPI_peers_left++;
+    ASSERT_ZERO(pthread_cond_broadcast(&MIMPI_any_cond));
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+}
+
+
+/// @brief Reads and handles messages from a channel for as long as data is available.
+///
+/// On a blocking channel, returns only once the channel has been closed.
+///
+/// @param sender - rank of the sender.
+///
+/// @return bool:
+///     - true if the channel would block, false if it has been closed.
+static bool advance_reader(
+    int sender
+) {
+    reader* r = &MIMPI_peers[sender].reader;
+    MIMPI_local_pool = &MIMPI_peers[sender].pool;
+
+    while (true) {
+        // The flags, known once the part every frame has is read, tell whether a value follows.
+        const size_t head = r->header_read < FRAME_HEADER_SIZE ? FRAME_HEADER_SIZE : header_size(&r->header);
+        const bool in_header = r->header_read < head;
+        char* destination = in_header
+            ? (char*)&r->header + r->header_read
+            : (char*)r->payload + r->payload_read;
+        const size_t left = in_header
+            ? head - r->header_read
+            : (size_t)r->count - r->payload_read;
+
+        int current_read;
+
+        if (r->consumed < r->buffered) {
+            current_read = MIN(left, r->buffered - r->consumed);
+            memcpy(destination, r->buffer + r->consumed, current_read);
+            r->consumed += current_read;
+        }
+        else if (!MIMPI_read_ahead || (!in_header && left >= READ_AHEAD_SIZE)) {
+            // A read delay is charged for the bytes asked for, so reads then ask only for what the frame still needs.
+            current_read = chrecv(r->fd, destination, left);
+            STATS_ADD(MIMPI_stats.recv_calls, 1);
+        }
+        else {
+            // Small messages are parsed out of one greedy read instead of taking a read each.
+            current_read = chrecv(r->fd, r->buffer, READ_AHEAD_SIZE);
+            STATS_ADD(MIMPI_stats.recv_calls, 1);
+
+            if (current_read > 0) {
+                r->buffered = current_read;
+                r->consumed = 0;
+                continue;
+            }
+        }
+
+        if (current_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+
+        if (current_read < 0 && errno == EINTR && !atomic_load(&MIMPI_readers_stopping)) {
+            continue;
+        }
+
+        if (current_read <= 0) {
+            close_reader(sender);
+            return false;
+        }
+
+        if (in_header) {
+            r->header_read += current_read;
+
+            if (r->header_read >= FRAME_HEADER_SIZE && r->header_read == header_size(&r->header) && !start_payload(sender)) {
+                finish_message(sender);
+            }
+        }
+        else {
+            r->payload_read += current_read;
+
+            if (r->payload_read == (size_t)r->count) {
+                finish_message(sender);
+            }
+        }
+    }
+}
+
+
+/// @brief Handles communication through a channel in a helper thread.
+///
+/// @param data - pointer to the data containing the sender's rank.
+static void* handle_channel(
+    void* data
+) {
+    const int sender = *((int*)data);
+    free(data);
+
+    if (MIMPI_tracing) {
+        char name[32];
+        ASSERT_SPRINTF(sprintf(name, "reader %d", sender));
+        trace_thread_name(name);
+    }
+
+    advance_reader(sender);
+
+    ASSERT_SYS_OK(chclose(MIMPI_peers[sender].reader.fd));
+    return NULL;
+}
+
+
+/// @brief Handles communication through all channels in a single epoll-driven thread.
+static void* progress_engine(
+    void* unused
+) {
+    struct epoll_event events[PROGRESS_EVENTS];
+    int open_channels = MIMPI_World_size() - 1;
+
+    trace_thread_name("progress");
+
+    while (open_channels > 0) {
+        int ready = epoll_wait(MIMPI_epoll_fd, events, PROGRESS_EVENTS, -1);
+
+        if (ready == -1 && errno == EINTR) {
+            if (atomic_load(&MIMPI_readers_stopping))
+                break;
+            continue;
+        }
+        ASSERT_SYS_OK(ready);
+
+        for (int i = 0; i < ready; i++) {
+            const int sender = events[i].data.u32;
+
+            if (!advance_reader(sender)) {
+                ASSERT_SYS_OK(chclose(MIMPI_peers[sender].reader.fd));
+                open_channels--;
+            }
+        }
+    }
+
+    // A fast MIMPI_Finalize stops the engine before all peers have left.
+    for (int sender = 0; open_channels > 0 && sender < MIMPI_World_size(); sender++) {
+        if (sender == MIMPI_World_rank() || MIMPI_peers[sender].already_left) continue;
+
+        ASSERT_SYS_OK(chclose(MIMPI_peers[sender].reader.fd));
+    }
+
+    return NULL;
+}
+
+
+/// @brief Does nothing, the signal only interrupts the read a reader waits in.
+///
+/// @param signal - number of the signal.
+static void interrupt_reader(
+    int signal
+) {
+    (void)signal;
+}
+
+
+/// @brief Writes answers to announcements and data of announced messages.
+///
+/// @param data - unused.
+static void* rendezvous_writer(
+    void* data
+) {
+    trace_thread_name("rendezvous");
+
+    while (true) {
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+
+        while (MIMPI_rendezvous_first == NULL && !MIMPI_rendezvous_stopping) {
+            ASSERT_ZERO(pthread_cond_wait(&MIMPI_rendezvous_cond, &MIMPI_rendezvous_mutex));
+        }
+
+        rendezvous_job* job = MIMPI_rendezvous_first;
+        if (job != NULL) {
+            MIMPI_rendezvous_first = job->next;
+            if (MIMPI_rendezvous_first == NULL)
+                MIMPI_rendezvous_last = NULL;
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+
+        if (job == NULL)
+            return NULL;
+
+        if (job->send == NULL) {
+            const frame_header header = build_header(job->tag, 0, 0, job->ticket);
+            write_frame(job->destination, &header, NULL, false);
+        }
+        else {
+            request* send = job->send;
+            peer* pr = &MIMPI_peers[job->destination];
+            const bool queued = send->ticket == NO_TICKET;
+            const frame_header header = queued
+                ? build_header(send->message.tag, send->message.count, 0, 0)
+                : build_header(MIMPI_RENDEZVOUS_DATA_TAG, send->message.count, 0, job->ticket);
+            bool const written = write_frame(job->destination, &header, send->message.data, false);
+
+            ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+            if (queued) {
+                atomic_fetch_sub(&pr->queued_sends, 1);
+            }
+            if (send->detached) {
+                free_detached(pr, send);
+            }
+            else {
+                send->result = written ? MIMPI_SUCCESS : MIMPI_ERROR_REMOTE_FINISHED;
+                send->message.received = true;
+            }
+            wake_receivers(pr);
+            ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+        }
+
+        free(job);
+    }
+}
+
+
+/// @brief Maps the rings created by mimpirun and attaches them to channels of the process.
+///
+/// TCP channels (to ranks placed on other hosts) have no capacity of a pipe and keep carrying their data.
+static void attach_shared_memory() {
+    const int world_size = MIMPI_World_size();
+    const int world_rank = MIMPI_World_rank();
+    const int memory_fd = shared_memory_descriptor(world_size);
+    const size_t ring_size = strtoull(getenv(SHM_RING_SIZE_VAR), NULL, 10);
+
+    MIMPI_shared_memory_size = (size_t)world_size * (world_size - 1) * chringsize(ring_size);
+    MIMPI_shared_memory = mmap(NULL, MIMPI_shared_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    if (MIMPI_shared_memory == MAP_FAILED) {
+        syserr("mmap of rings failed");
+    }
+    ASSERT_SYS_OK(close(memory_fd));
+
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        if (MIMPI_peers[i].send_pipe_size == 0) continue;
+
+        char* memory = MIMPI_shared_memory;
+        chattach(
+            calculate_file_descriptor(world_size, world_rank, i),
+            memory + shared_memory_offset(world_size, world_rank, i, ring_size),
+            ring_size
+        );
+        chattach(
+            calculate_file_descriptor(world_size, i, world_rank) + 1,
+            memory + shared_memory_offset(world_size, i, world_rank, ring_size),
+            ring_size
+        );
+    }
+}
+
+
+/// @brief Makes helper threads run on the CPUs listed in @ref HELPER_CPUS_VAR, if any.
+///
+/// @param attr - pointer to the attributes the helper threads are created with.
+static void set_helper_affinity(
+    pthread_attr_t* attr
+) {
+    const char* list = getenv(HELPER_CPUS_VAR);
+    if (list == NULL) {
+        return;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    for (const char* cpu = list; *cpu != '\0'; cpu = strchr(cpu, ',') ? strchr(cpu, ',') + 1 : "") {
+        const int number = atoi(cpu);
+        if (number >= 0 && number < CPU_SETSIZE) {
+            CPU_SET(number, &cpus);
+        }
+    }
+
+    if (CPU_COUNT(&cpus) > 0) {
+        ASSERT_ZERO(pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus));
+    }
+}
+
+
+void MIMPI_Init(
+    bool enable_deadlock_detection
+) {
+    channels_init();
+
+    char pid_rank[40];
+    ASSERT_SPRINTF(sprintf(pid_rank, "MIMPI_PID_RANK %d", getpid()));
+
+    MIMPI_rank = atoi(getenv(pid_rank));
+    MIMPI_size = atoi(getenv("MIMPI_SIZE"));
+    MIMPI_deadlock_enabled = enable_deadlock_detection;
+
+    const int world_size = MIMPI_World_size();
+    const int world_rank = MIMPI_World_rank();
+
+    MIMPI_peers = (peer*)calloc(world_size, sizeof(peer));
+#ifdef MIMPI_STATS
+    memset(&MIMPI_stats, 0, sizeof(MIMPI_stats));
+#endif
+    ASSERT_MALLOC(MIMPI_peers);
+
+    const char* barrier = getenv(BARRIER_ALGORITHM_VAR);
+    MIMPI_barrier_algorithm = BARRIER_BINOMIAL;
+
+    if (barrier != NULL && strcmp(barrier, "dissemination") == 0) {
+        MIMPI_barrier_algorithm = BARRIER_DISSEMINATION;
+    }
+    else if (barrier != NULL && sscanf(barrier, "kary:%d", &MIMPI_barrier_arity) == 1) {
+        const int max_arity = sizeof(MIMPI_world.barrier_tree.children) / sizeof(int);
+        if (MIMPI_barrier_arity < 2 || MIMPI_barrier_arity > max_arity) {
+            fatal("Arity of %s must be between 2 and %d, got %s", BARRIER_ALGORITHM_VAR, max_arity, barrier);
+        }
+
+        MIMPI_barrier_algorithm = BARRIER_KARY;
+    }
+    else if (barrier != NULL && strcmp(barrier, "binomial") != 0) {
+        fatal("Unknown %s %s, expected binomial, dissemination or kary:K", BARRIER_ALGORITHM_VAR, barrier);
+    }
+
+    const char* nodes = getenv(NODES_VAR);
+    MIMPI_nodes = NULL;
+
+    if (nodes != NULL) {
+        MIMPI_nodes = (int*)malloc(world_size * sizeof(int));
+        ASSERT_MALLOC(MIMPI_nodes);
+
+        char* end = (char*)nodes;
+        for (int i = 0; i < world_size; i++) {
+            const char* start = end + (i > 0 && *end == ',');
+            MIMPI_nodes[i] = (int)strtol(start, &end, 10);
+
+            if (end == start) {
+                fatal("%s lists fewer than %d nodes: %s", NODES_VAR, world_size, nodes);
+            }
+        }
+    }
+
+    MIMPI_world = (communicator) {.id = 0, .rank = world_rank, .size = world_size};
+    MIMPI_world.ranks = (int*)malloc(world_size * sizeof(int));
+    ASSERT_MALLOC(MIMPI_world.ranks);
+
+    for (int i = 0; i < world_size; i++) {
+        MIMPI_world.ranks[i] = i;
+    }
+
+    plan_group(&MIMPI_world);
+    MIMPI_next_group_id = 1;
+
+    MIMPI_staging = NULL;
+    MIMPI_staging_size = 0;
+
+    if (enable_deadlock_detection) {
+        for (int i = 0; i < world_size; i++) {
+            if (i == world_rank) continue;
+
+            MIMPI_peers[i].others_recv = create_list();
+            MIMPI_peers[i].sent_log = (sent_record*)malloc(SENT_LOG_INITIAL_CAPACITY * sizeof(sent_record));
+            ASSERT_MALLOC(MIMPI_peers[i].sent_log);
+            MIMPI_peers[i].sent_capacity = SENT_LOG_INITIAL_CAPACITY;
+        }
+    }
+
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        MIMPI_peers[i].posted = create_list();
+        MIMPI_peers[i].blocked = NULL;
+        MIMPI_peers[i].cleared = create_list();
+        MIMPI_peers[i].announced_sends = create_list();
+        MIMPI_peers[i].next_ticket = 0;
+        MIMPI_peers[i].received_messages = create_queue();
+        MIMPI_peers[i].reader.fd = calculate_file_descriptor(world_size, world_rank, i);
+        chlink(MIMPI_peers[i].reader.fd, i, world_rank);
+        chlink(calculate_file_descriptor(world_size, i, world_rank) + 1, world_rank, i);
+        // Capacities are set by mimpirun, the kernel may have refused some.
+        MIMPI_peers[i].send_pipe_size = MAX(fcntl(calculate_file_descriptor(world_size, i, world_rank) + 1, F_GETPIPE_SZ), 0);
+        MIMPI_peers[i].recv_pipe_size = MAX(fcntl(MIMPI_peers[i].reader.fd, F_GETPIPE_SZ), 0);
+        MIMPI_peers[i].reader.buffer = (char*)malloc(READ_AHEAD_SIZE);
+        ASSERT_MALLOC(MIMPI_peers[i].reader.buffer);
+        MIMPI_peers[i].reader.buffered = 0;
+        MIMPI_peers[i].reader.consumed = 0;
+        init_pool(&MIMPI_peers[i].pool);
+        ASSERT_ZERO(pthread_mutex_init(&MIMPI_peers[i].mutex, NULL));
+        ASSERT_ZERO(pthread_mutex_init(&MIMPI_peers[i].send_mutex, NULL));
+        MIMPI_peers[i].batch = NULL;
+        MIMPI_peers[i].batch_used = 0;
+        ASSERT_ZERO(pthread_cond_init(&MIMPI_peers[i].cond, NULL));
+        atomic_init(&MIMPI_peers[i].wakeups, 0);
+        atomic_init(&MIMPI_peers[i].queued_sends, 0);
+        atomic_init(&MIMPI_peers[i].bytes_written, 0);
+    }
+
+    if (shared_memory_transport() && world_size > 1) {
+        attach_shared_memory();
+    }
+
+    const char* engine = getenv(PROGRESS_ENGINE_VAR);
+    MIMPI_use_epoll = engine != NULL && strcmp(engine, "epoll") == 0;
+
+    const char* bcast_segment = getenv(BCAST_SEGMENT_VAR);
+    MIMPI_bcast_segment = bcast_segment != NULL ? atoi(bcast_segment) : BCAST_DEFAULT_SEGMENT;
+
+    const char* reduce_segment = getenv(REDUCE_SEGMENT_VAR);
+    MIMPI_reduce_segment = reduce_segment != NULL ? atoi(reduce_segment) : REDUCE_DEFAULT_SEGMENT;
+
+    const char* relaxed_collectives = getenv(RELAXED_COLLECTIVES_VAR);
+    MIMPI_relaxed_collectives = relaxed_collectives != NULL && atoi(relaxed_collectives) == 1;
+
+    const char* trace_events = getenv(TRACE_EVENTS_VAR);
+    MIMPI_tracing = getenv(TRACE_DIR_VAR) != NULL;
+    MIMPI_trace_events = trace_events != NULL && atoll(trace_events) > 0 ? (size_t)atoll(trace_events) : TRACE_DEFAULT_EVENTS;
+    atomic_init(&MIMPI_trace_rings, NULL);
+    atomic_init(&MIMPI_trace_threads, 0);
+    trace_thread_name("main");
+
+    const char* eager_limit = getenv(EAGER_LIMIT_VAR);
+    MIMPI_eager_limit = eager_limit != NULL && atoi(eager_limit) >= 0 ? atoi(eager_limit) : INT_MAX;
+
+    const char* read_delay = getenv(CHANNELS_READ_DELAY_VAR);
+    MIMPI_read_ahead = read_delay == NULL || atoi(read_delay) <= 0;
+
+    const char* deadlock_timeout = getenv(DEADLOCK_TIMEOUT_VAR);
+    MIMPI_deadlock_timeout = deadlock_timeout != NULL && atoi(deadlock_timeout) >= 0
+        ? atoi(deadlock_timeout) : DEADLOCK_DEFAULT_TIMEOUT;
+
+    const char* fast_finalize = getenv(FAST_FINALIZE_VAR);
+    MIMPI_fast_finalize = fast_finalize != NULL && atoi(fast_finalize) == 1;
+    atomic_init(&MIMPI_readers_stopping, false);
+
+    // Without SA_RESTART, the signal makes a read of a reader fail with EINTR.
+    if (MIMPI_fast_finalize) {
+        struct sigaction action = {.sa_handler = interrupt_reader, .sa_flags = 0};
+        ASSERT_SYS_OK(sigemptyset(&action.sa_mask));
+        ASSERT_SYS_OK(sigaction(FAST_FINALIZE_SIGNAL, &action, &MIMPI_previous_action));
+    }
+
+    const char* spin_time = getenv(SPIN_TIME_VAR);
+    MIMPI_spin_ns = spin_time != NULL && atol(spin_time) > 0 ? atol(spin_time) * 1000 : 0;
+
+    // A receive spinning on the only CPU allowed would just keep the readers from completing it.
+    cpu_set_t allowed;
+    ASSERT_SYS_OK(sched_getaffinity(0, sizeof(allowed), &allowed));
+    if (CPU_COUNT(&allowed) < 2)
+        MIMPI_spin_ns = 0;
+
+    const char* send_buffer = getenv(SEND_BUFFER_VAR);
+    MIMPI_send_buffer = send_buffer != NULL && atoll(send_buffer) > 0 ? (size_t)atoll(send_buffer) : 0;
+    MIMPI_send_buffered = 0;
+    MIMPI_writers_stopping = false;
+    ASSERT_ZERO(pthread_mutex_init(&MIMPI_send_buffer_mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&MIMPI_send_buffer_cond, NULL));
+
+    // Rings of the shared memory transport copy data anyway, and queued frames are copies already.
+    const char* splice_threshold = getenv(SPLICE_THRESHOLD_VAR);
+    MIMPI_splice_threshold = splice_threshold != NULL && atoi(splice_threshold) > 0 ? (size_t)atoi(splice_threshold) : 0;
+    if (MIMPI_shared_memory != NULL || MIMPI_send_buffer > 0)
+        MIMPI_splice_threshold = 0;
+    atomic_init(&MIMPI_splice_supported, true);
+
+    const char* compress_threshold = getenv(COMPRESS_THRESHOLD_VAR);
+    MIMPI_compress_threshold = compress_threshold != NULL && atoi(compress_threshold) > 0 ? (size_t)atoi(compress_threshold) : 0;
+
+    const char* coalesce_size = getenv(COALESCE_SIZE_VAR);
+    MIMPI_coalesce_size = coalesce_size != NULL && atoi(coalesce_size) > 0 ? atoi(coalesce_size) : 0;
+
+    for (int i = 0; i < world_size && MIMPI_coalesce_size > 0; i++) {
+        if (i == world_rank) continue;
+
+        MIMPI_peers[i].batch = (char*)malloc(MIMPI_coalesce_size);
+        ASSERT_MALLOC(MIMPI_peers[i].batch);
+    }
+
+    pthread_attr_t attr;
+    ASSERT_ZERO(pthread_attr_init(&attr));
+    ASSERT_ZERO(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE));
+    set_helper_affinity(&attr);
+
+    ASSERT_ZERO(pthread_mutex_init(&MIMPI_rendezvous_mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&MIMPI_rendezvous_cond, NULL));
+    MIMPI_rendezvous_first = NULL;
+    MIMPI_rendezvous_last = NULL;
+    MIMPI_rendezvous_stopping = false;
+    MIMPI_clears_done = false;
+
+    const char* rendezvous_buffer = getenv(RENDEZVOUS_BUFFER_VAR);
+    MIMPI_rendezvous_buffer = rendezvous_buffer != NULL && atoll(rendezvous_buffer) >= 0
+        ? (size_t)atoll(rendezvous_buffer) : RENDEZVOUS_DEFAULT_BUFFER;
+    MIMPI_rendezvous_buffered = 0;
+    ASSERT_ZERO(pthread_cond_init(&MIMPI_rendezvous_buffer_cond, NULL));
+
+    ASSERT_ZERO(pthread_mutex_init(&MIMPI_any_mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&MIMPI_any_cond, NULL));
+    MIMPI_any_posted = create_list();
+    atomic_init(&MIMPI_any_pending, 0);
+    MIMPI_peers_left = 0;
+    atomic_init(&MIMPI_arrivals, 0);
+    atomic_init(&MIMPI_posts, 0);
+    atomic_init(&MIMPI_probes, 0);
+
+    // All processes share the limit, so without one no message is ever announced, and
+    // only eager non-blocking sends need the thread, unless writer threads take all writes.
+    MIMPI_rendezvous_running = MIMPI_eager_limit < INT_MAX || MIMPI_send_buffer == 0;
+    if (MIMPI_rendezvous_running) {
+        ASSERT_ZERO(pthread_create(&MIMPI_rendezvous_thread, &attr, rendezvous_writer, NULL));
+    }
+
+    for (int i = 0; i < world_size && MIMPI_send_buffer > 0; i++) {
+        if (i == world_rank) continue;
+
+        int* destination = malloc(sizeof(int));
+        ASSERT_MALLOC(destination);
+
+        *destination = i;
+        ASSERT_ZERO(pthread_cond_init(&MIMPI_peers[i].out_cond, NULL));
+        ASSERT_ZERO(pthread_create(&MIMPI_peers[i].writer, &attr, write_channel, destination));
+    }
+
+    if (MIMPI_use_epoll) {
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        ASSERT_SYS_OK(epoll_fd);
+        MIMPI_epoll_fd = move_descriptor(world_size, epoll_fd);
+
+        for (int i = 0; i < world_size; i++) {
+            if (i == world_rank) continue;
+
+            const int fd = MIMPI_peers[i].reader.fd;
+            ASSERT_SYS_OK(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK));
+
+            struct epoll_event event = {.events = EPOLLIN, .data.u32 = i};
+            ASSERT_SYS_OK(epoll_ctl(MIMPI_epoll_fd, EPOLL_CTL_ADD, fd, &event));
+        }
+
+        ASSERT_ZERO(pthread_create(&MIMPI_progress_thread, &attr, progress_engine, NULL));
+    }
+    else {
+        for (int worker = 0; worker < world_size; worker++) {
+            if (worker == world_rank) {
+                continue;
+            }
+
+            int* worker_id = malloc(sizeof(int));
+            ASSERT_MALLOC(worker_id);
+
+            *worker_id = worker;
+            ASSERT_ZERO(pthread_create(&MIMPI_peers[worker].thread, &attr, handle_channel, worker_id));
+        }
+    }
+
+    ASSERT_ZERO(pthread_attr_destroy(&attr));
+}
+
+
+/// @brief Reads the counters of communication with one process.
+///
+/// @param rank - rank of the process, other than the calling one.
+/// @param stats - statistics to be filled.
+static void read_peer_stats(
+    int rank,
+    MIMPI_Peer_stats* stats
+) {
+    *stats = (MIMPI_Peer_stats) {
+        .send_pipe_size = MIMPI_peers[rank].send_pipe_size, .recv_pipe_size = MIMPI_peers[rank].recv_pipe_size
+    };
+
+#ifdef MIMPI_STATS
+    peer_stats* counters = &MIMPI_peers[rank].stats;
+
+    stats->messages_sent = atomic_load_explicit(&counters->messages_sent, memory_order_relaxed);
+    stats->bytes_sent = atomic_load_explicit(&counters->bytes_sent, memory_order_relaxed);
+    stats->messages_received = atomic_load_explicit(&counters->messages_received, memory_order_relaxed);
+    stats->bytes_received = atomic_load_explicit(&counters->bytes_received, memory_order_relaxed);
+    stats->unexpected_high_water = atomic_load_explicit(&counters->unexpected_high_water, memory_order_relaxed);
+#endif
+}
+
+
+MIMPI_Retcode MIMPI_Get_stats(
+    MIMPI_Stats* stats
+) {
+    *stats = (MIMPI_Stats) {0};
+
+    for (int i = 0; i < MIMPI_size; i++) {
+        if (i == MIMPI_rank) continue;
+
+        MIMPI_Peer_stats peer_stats;
+        read_peer_stats(i, &peer_stats);
+
+        stats->messages_sent += peer_stats.messages_sent;
+        stats->bytes_sent += peer_stats.bytes_sent;
+        stats->messages_received += peer_stats.messages_received;
+        stats->bytes_received += peer_stats.bytes_received;
+        stats->unexpected_high_water = MAX(stats->unexpected_high_water, peer_stats.unexpected_high_water);
+
+        // TCP channels report no capacity.
+        if (peer_stats.send_pipe_size > 0 && (stats->min_pipe_size == 0 || peer_stats.send_pipe_size < stats->min_pipe_size))
+            stats->min_pipe_size = peer_stats.send_pipe_size;
+        if (peer_stats.recv_pipe_size > 0 && (stats->min_pipe_size == 0 || peer_stats.recv_pipe_size < stats->min_pipe_size))
+            stats->min_pipe_size = peer_stats.recv_pipe_size;
+    }
+
+#ifdef MIMPI_STATS
+    stats->recv_wait_ns = atomic_load_explicit(&MIMPI_stats.recv_wait_ns, memory_order_relaxed);
+    stats->send_calls = atomic_load_explicit(&MIMPI_stats.send_calls, memory_order_relaxed);
+    stats->recv_calls = atomic_load_explicit(&MIMPI_stats.recv_calls, memory_order_relaxed);
+    stats->control_sent = atomic_load_explicit(&MIMPI_stats.control_sent, memory_order_relaxed);
+    stats->control_received = atomic_load_explicit(&MIMPI_stats.control_received, memory_order_relaxed);
+#endif
+
+    return MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Get_peer_stats(
+    int rank,
+    MIMPI_Peer_stats* stats
+) {
+    CHECK_RANK_ERROR(rank);
+    CHECK_SELF_OP_ERROR(rank);
+
+    read_peer_stats(rank, stats);
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Writes the statistics of the process as JSON to the directory named by @ref STATS_OUTPUT_VAR, if any.
+static void write_stats() {
+    const char* directory = getenv(STATS_OUTPUT_VAR);
+    if (directory == NULL) {
+        return;
+    }
+
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/mimpi_stats.%d.json", directory, MIMPI_rank) >= (int)sizeof(path)) {
+        fatal("Path of statistics in %s is too long", directory);
+    }
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        syserr("Opening %s failed", path);
+    }
+
+    MIMPI_Stats stats;
+    MIMPI_Get_stats(&stats);
+
+    fprintf(file, "{\"rank\": %d, \"size\": %d, ", MIMPI_rank, MIMPI_size);
+    fprintf(
+        file,
+        "\"messages_sent\": %" PRIu64 ", \"bytes_sent\": %" PRIu64 ", "
+        "\"messages_received\": %" PRIu64 ", \"bytes_received\": %" PRIu64 ", "
+        "\"unexpected_high_water\": %" PRIu64 ", \"recv_wait_ns\": %" PRIu64 ", "
+        "\"send_calls\": %" PRIu64 ", \"recv_calls\": %" PRIu64 ", "
+        "\"control_sent\": %" PRIu64 ", \"control_received\": %" PRIu64 ", "
+        "\"min_pipe_size\": %" PRIu64 ", \"peers\": [",
+        stats.messages_sent, stats.bytes_sent, stats.messages_received, stats.bytes_received,
+        stats.unexpected_high_water, stats.recv_wait_ns, stats.send_calls, stats.recv_calls,
+        stats.control_sent, stats.control_received, stats.min_pipe_size
+    );
+
+    for (int i = 0, written = 0; i < MIMPI_size; i++) {
+        if (i == MIMPI_rank) continue;
+
+        MIMPI_Peer_stats peer_stats;
+        read_peer_stats(i, &peer_stats);
+
+        fprintf(
+            file,
+            "%s{\"rank\": %d, \"messages_sent\": %" PRIu64 ", \"bytes_sent\": %" PRIu64 ", "
+            "\"messages_received\": %" PRIu64 ", \"bytes_received\": %" PRIu64 ", "
+            "\"unexpected_high_water\": %" PRIu64 ", "
+            "\"send_pipe_size\": %" PRIu64 ", \"recv_pipe_size\": %" PRIu64 "}",
+            written++ > 0 ? ", " : "", i, peer_stats.messages_sent, peer_stats.bytes_sent,
+            peer_stats.messages_received, peer_stats.bytes_received, peer_stats.unexpected_high_water,
+            peer_stats.send_pipe_size, peer_stats.recv_pipe_size
+        );
+    }
+
+    fprintf(file, "]}\n");
+    ASSERT_ZERO(fclose(file));
+}
+
+
+/// @brief Waits for a reader to leave, interrupting it until it does.
+///
+/// A reader may miss the signal when it comes between reads, so it is sent again after a while.
+///
+/// @param thread - the reader (or the progress engine).
+static void stop_reader(
+    pthread_t thread
+) {
+    while (true) {
+        struct timespec deadline;
+        ASSERT_SYS_OK(clock_gettime(CLOCK_REALTIME, &deadline));
+        deadline.tv_nsec += FAST_FINALIZE_RETRY_US * 1000;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+
+        const int joined = pthread_timedjoin_np(thread, NULL, &deadline);
+        if (joined != ETIMEDOUT) {
+            ASSERT_ZERO(joined);
+            return;
+        }
+
+        ASSERT_ZERO(pthread_kill(thread, FAST_FINALIZE_SIGNAL));
+    }
+}
+
+
+/// @brief Makes all readers leave at once, instead of when their peers close their channels.
+static void stop_readers() {
+    const int world_size = MIMPI_World_size();
+    const int world_rank = MIMPI_World_rank();
+
+    atomic_store(&MIMPI_readers_stopping, true);
+
+    if (MIMPI_use_epoll) {
+        ASSERT_ZERO(pthread_kill(MIMPI_progress_thread, FAST_FINALIZE_SIGNAL));
+        stop_reader(MIMPI_progress_thread);
+        return;
+    }
+
+    for (int worker = 0; worker < world_size; worker++) {
+        if (worker == world_rank) continue;
+
+        ASSERT_ZERO(pthread_kill(MIMPI_peers[worker].thread, FAST_FINALIZE_SIGNAL));
+    }
+
+    for (int worker = 0; worker < world_size; worker++) {
+        if (worker == world_rank) continue;
+
+        stop_reader(MIMPI_peers[worker].thread);
+    }
+}
+
+
+/// @brief Waits until blocking sends which have returned before their data was written make no more progress.
+///
+/// Every peer is told first that its announced messages will not be cleared any more,
+/// so that processes finalizing at the same time do not wait for each other's clears.
+/// Messages the receiver has left or stopped clearing before clearing them are dropped.
+static void finish_detached_sends() {
+    const int world_size = MIMPI_World_size();
+    const int world_rank = MIMPI_World_rank();
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+    MIMPI_clears_done = true;
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+
+    // The notice follows the clears queued so far to each peer.
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        queue_rendezvous_job(i, MIMPI_CLEARS_DONE_TAG, 0, NULL);
+    }
+
+    flush_batches();
+
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        peer* pr = &MIMPI_peers[i];
+        ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+        while (true) {
+            // Sends may have been announced after the process has stopped clearing.
+            if (pr->already_left || pr->stopped_clearing)
+                drop_detached(pr);
+
+            // Sends cleared already are being written by the rendezvous thread.
+            if (pr->detached_sends == 0)
+                break;
+
+            ASSERT_ZERO(pthread_cond_wait(&pr->cond, &pr->mutex));
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+    }
+}
+
+
+void MIMPI_Finalize() {
+    const int world_size = MIMPI_World_size();
+    const int world_rank = MIMPI_World_rank();
+
+    if (MIMPI_eager_limit < INT_MAX) {
+        finish_detached_sends();
+    }
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+    MIMPI_rendezvous_stopping = true;
+    ASSERT_ZERO(pthread_cond_signal(&MIMPI_rendezvous_cond));
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+
+    if (MIMPI_rendezvous_running) {
+        ASSERT_ZERO(pthread_join(MIMPI_rendezvous_thread, NULL));
+    }
+
+    flush_batches();
+
+    // Frames still queued are written before the channels are closed.
+    if (MIMPI_send_buffer > 0) {
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_send_buffer_mutex));
+        MIMPI_writers_stopping = true;
+
+        for (int i = 0; i < world_size; i++) {
+            if (i == world_rank) continue;
+
+            ASSERT_ZERO(pthread_cond_signal(&MIMPI_peers[i].out_cond));
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_send_buffer_mutex));
+
+        for (int i = 0; i < world_size; i++) {
+            if (i == world_rank) continue;
+
+            ASSERT_ZERO(pthread_join(MIMPI_peers[i].writer, NULL));
+            ASSERT_ZERO(pthread_cond_destroy(&MIMPI_peers[i].out_cond));
+        }
+    }
+
+    ASSERT_ZERO(pthread_cond_destroy(&MIMPI_send_buffer_cond));
+    ASSERT_ZERO(pthread_mutex_destroy(&MIMPI_send_buffer_mutex));
+
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        int fd_num = calculate_file_descriptor(world_size, i, world_rank) + 1;
+        ASSERT_SYS_OK(chclose(fd_num));
+    }
+    
+    if (MIMPI_fast_finalize) {
+        stop_readers();
+        ASSERT_SYS_OK(sigaction(FAST_FINALIZE_SIGNAL, &MIMPI_previous_action, NULL));
+
+        if (MIMPI_use_epoll) {
+            ASSERT_SYS_OK(close(MIMPI_epoll_fd));
+        }
+    }
+    else if (MIMPI_use_epoll) {
+        ASSERT_ZERO(pthread_join(MIMPI_progress_thread, NULL));
+        ASSERT_SYS_OK(close(MIMPI_epoll_fd));
+    }
+    else {
+        for (int worker = 0; worker < world_size; worker++) {
+            if (worker == world_rank) continue;
+
+            ASSERT_ZERO(pthread_join(MIMPI_peers[worker].thread, NULL));
+        }
+    }
+
+    write_stats();
+    write_trace();
+    channels_finalize();
+
+    if (MIMPI_shared_memory != NULL) {
+        ASSERT_SYS_OK(munmap(MIMPI_shared_memory, MIMPI_shared_memory_size));
+        MIMPI_shared_memory = NULL;
+    }
+
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        if (MIMPI_fast_finalize) {
+            drop_queue(MIMPI_peers[i].received_messages);
+        }
+        else {
+            delete_queue(MIMPI_peers[i].received_messages);
+        }
+
+        // Operations never waited for belong to their requests, so they are only unlinked.
+        delete_request_list(MIMPI_peers[i].posted);
+        delete_request_list(MIMPI_peers[i].cleared);
+        delete_request_list(MIMPI_peers[i].announced_sends);
+    }
+
+    delete_request_list(MIMPI_any_posted);
+    ASSERT_ZERO(pthread_cond_destroy(&MIMPI_any_cond));
+    ASSERT_ZERO(pthread_mutex_destroy(&MIMPI_any_mutex));
+
+    if (MIMPI_deadlock_enabled) {
+        for (int i = 0; i < world_size; i++) {
+            if (i == world_rank) continue;
+
+            delete_list(MIMPI_peers[i].others_recv);
+            free(MIMPI_peers[i].sent_log);
+        }
+    }
+
+    for (int i = 0; i < world_size; i++) {
+        if (i == world_rank) continue;
+
+        destroy_pool(&MIMPI_peers[i].pool);
+        ASSERT_ZERO(pthread_cond_destroy(&MIMPI_peers[i].cond));
+        ASSERT_ZERO(pthread_mutex_destroy(&MIMPI_peers[i].mutex));
+        ASSERT_ZERO(pthread_mutex_destroy(&MIMPI_peers[i].send_mutex));
+        free(MIMPI_peers[i].batch);
+        free(MIMPI_peers[i].reader.buffer);
+    }
+
+    ASSERT_ZERO(pthread_cond_destroy(&MIMPI_rendezvous_cond));
+    ASSERT_ZERO(pthread_cond_destroy(&MIMPI_rendezvous_buffer_cond));
+    ASSERT_ZERO(pthread_mutex_destroy(&MIMPI_rendezvous_mutex));
+
+    free(MIMPI_peers);
+    MIMPI_peers = NULL;
+
+    free(MIMPI_world.schedules);
+    free(MIMPI_world.node_schedules);
+    free(MIMPI_world.ranks);
+    MIMPI_world.schedules = NULL;
+    MIMPI_world.node_schedules = NULL;
+    MIMPI_world.ranks = NULL;
+    free(MIMPI_nodes);
+    MIMPI_nodes = NULL;
+    free(MIMPI_staging);
+    MIMPI_staging = NULL;
+}
+
+
+int MIMPI_World_size() {
+    return MIMPI_size;
+}
+
+
+int MIMPI_World_rank() {
+    return MIMPI_rank;
+}
+
+
+/// @brief Sends a control frame, which carries everything it needs in its header.
+///
+/// @param destination - rank of the receiver.
+/// @param tag - control tag of the frame.
+/// @param count - count of the message announced or waited for, or the count of the frame.
+/// @param message_tag - tag of the message announced or waited for.
+/// @param value - ticket or number of messages read, as the kind needs.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, MIMPI_ERROR_REMOTE_FINISHED if the destination has left.
+static MIMPI_Retcode send_control(
+    int destination,
+    int tag,
+    int count,
+    int message_tag,
+    int value
+) {
+    const frame_header header = build_header(tag, count, message_tag, value);
+    // The sender blocks right after reporting a receive, so the report cannot wait in a batch.
+    const bool coalesce = tag != MIMPI_WAITING_TAG && tag != MIMPI_DEADLOCK_TAG;
+
+    return write_frame(destination, &header, NULL, coalesce) ? MIMPI_SUCCESS : MIMPI_ERROR_REMOTE_FINISHED;
+}
+
+
+/// @brief Records a message sent to the destination for deadlock detection.
+///
+/// The log only grows (doubling), so that recording does not allocate once it has room.
+///
+/// @param destination - rank of the receiver.
+/// @param count - number of bytes in the message data.
+/// @param tag - identifier of the message.
+static void track_send(
+    int destination,
+    int count,
+    int tag
+) {
+    peer* pr = &MIMPI_peers[destination];
+
+    if (MIMPI_deadlock_enabled && tag >= MIMPI_ANY_TAG) {
+        ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+        Message* msg = pr->others_recv->tail->next->message;
+
+        if (msg != NULL && msg->count == count && msg->tag == tag) {
+            remove_from_list(pr->others_recv->tail->next);
+        }
+
+        if (pr->logged == pr->sent_capacity) {
+            sent_record* grown = (sent_record*)malloc(2 * pr->sent_capacity * sizeof(sent_record));
+            ASSERT_MALLOC(grown);
+
+            for (unsigned int number = pr->sent - pr->logged; number != (unsigned int)pr->sent; number++) {
+                grown[number & (2 * pr->sent_capacity - 1)] = pr->sent_log[number & (pr->sent_capacity - 1)];
+            }
+
+            free(pr->sent_log);
+            pr->sent_log = grown;
+            pr->sent_capacity *= 2;
+        }
+
+        pr->sent_log[(unsigned int)pr->sent & (pr->sent_capacity - 1)] = (sent_record) {.count = count, .tag = tag};
+        pr->sent++;
+        pr->logged++;
+
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+    }
+}
+
+
+/// @brief Waits until the rendezvous thread has written the eager non-blocking sends queued to a process.
+///
+/// Messages to the process keep the order they were sent in, as a send written by its caller
+/// could otherwise overtake a queued one.
+///
+/// @param pr - peer messages are sent to.
+static void wait_queued_sends(
+    peer* pr
+) {
+    if (atomic_load(&pr->queued_sends) == 0)
+        return;
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    while (atomic_load(&pr->queued_sends) > 0) {
+        ASSERT_ZERO(pthread_cond_wait(&pr->cond, &pr->mutex));
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+}
+
+
+/// @brief Queues an eager non-blocking send for the rendezvous thread, which writes it while the caller goes on.
+///
+/// @param req - pointer to the request describing the send, completed once the data has been written.
+/// @param data - data to be sent, which must stay valid until the send completes.
+/// @param count - number of bytes of data to be sent.
+/// @param destination - rank of the receiver.
+/// @param tag - identifier of the message.
+static void queue_eager_send(
+    request* req,
+    void const* data,
+    int count,
+    int destination,
+    int tag
+) {
+    // The data is in use until written, even if the receiver leaves meanwhile.
+    *req = (request) {
+        .message = {
+            .tag = tag, .count = count, .source = destination, .data = (void*)data, .received = false, .claimed = true
+        },
+        .found = NULL, .buffer = NULL, .is_send = true, .ticket = NO_TICKET, .result = MIMPI_SUCCESS
+    };
+    req->posted = (elem) {.next = NULL, .prev = NULL, .message = &req->message};
+
+    track_send(destination, count, tag);
+
+    atomic_fetch_add(&MIMPI_peers[destination].queued_sends, 1);
+    queue_rendezvous_job(destination, tag, NO_TICKET, req);
+}
+
+
+/// @brief Announces a message to be sent by rendezvous.
+///
+/// The data is written by the rendezvous thread once the receiver clears the message.
+/// A detached request is freed by whoever finishes with it, the caller must not touch it afterwards.
+///
+/// @param req - pointer to the request describing the send.
+/// @param data - data to be sent, which must stay valid until the send completes.
+/// @param count - number of bytes of data to be sent.
+/// @param destination - rank of the receiver.
+/// @param tag - identifier of the message.
+/// @param detached - whether the request and the data are allocated, and left to the rendezvous.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if the message has been announced.
+///     - MIMPI_ERROR_REMOTE_FINISHED if the receiver has left.
+static MIMPI_Retcode start_rendezvous(
+    request* req,
+    void const* data,
+    int count,
+    int destination,
+    int tag,
+    bool detached
+) {
+    peer* pr = &MIMPI_peers[destination];
+
+    // The announcement must not overtake eager messages queued before.
+    wait_queued_sends(pr);
+
+    *req = (request) {
+        .message = {
+            .tag = tag, .count = count, .source = destination, .data = (void*)data, .received = false, .claimed = false
+        },
+        .found = NULL, .buffer = NULL, .is_send = true, .result = MIMPI_SUCCESS, .detached = detached
+    };
+    req->posted = (elem) {.next = NULL, .prev = NULL, .message = &req->message};
+
+    track_send(destination, count, tag);
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+    const int ticket = req->ticket = pr->next_ticket++;
+    push_front(pr->announced_sends, &req->posted);
+    pr->detached_sends += detached;
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+    if (send_control(destination, MIMPI_REQUEST_TO_SEND_TAG, count, tag, ticket) != MIMPI_SUCCESS) {
+        ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+        // Nothing is cleared without the announcement, so the request is still announced.
+        unlink_from_list(&req->posted);
+        if (detached) {
+            free_detached(pr, req);
+        }
+        else {
+            req->result = MIMPI_ERROR_REMOTE_FINISHED;
+            req->message.received = true;
+        }
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+        return MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Checks whether a send cannot make any more progress.
+///
+/// @param pr - peer the message is sent to, locked by the caller.
+/// @param req - pointer to the request describing the send.
+///
+/// @return bool:
+///     - true if the data has been written, or the receiver has left or stopped clearing before clearing it.
+static bool send_done(
+    peer* pr,
+    request* req
+) {
+    return req->message.received || ((pr->already_left || pr->stopped_clearing) && !req->message.claimed);
+}
+
+
+/// @brief Waits for a send to complete.
+///
+/// @param req - pointer to the request describing the send.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if the data has been written.
+///     - MIMPI_ERROR_REMOTE_FINISHED if the receiver has left.
+static MIMPI_Retcode wait_send(
+    request* req
+) {
+    peer* pr = &MIMPI_peers[req->message.source];
+
+    if (req->ticket != NO_TICKET)
+        flush_batches();
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    while (!send_done(pr, req)) {
+        ASSERT_ZERO(pthread_cond_wait(&pr->cond, &pr->mutex));
+    }
+
+    if (!req->message.received) {
+        unlink_from_list(&req->posted);
+        req->result = MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+    return req->result;
+}
+
+
+/// @brief Reserves memory for a copy of a blocking send by rendezvous, waiting for earlier copies to be written.
+///
+/// @param count - number of bytes of the copy.
+///
+/// @return bool:
+///     - true if the memory has been reserved, false if the copy would not fit even with no other ones.
+static bool reserve_copy(
+    int count
+) {
+    if ((size_t)count > MIMPI_rendezvous_buffer)
+        return false;
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+
+    if (MIMPI_rendezvous_buffered + count > MIMPI_rendezvous_buffer) {
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+        flush_batches();
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_rendezvous_mutex));
+    }
+
+    while (MIMPI_rendezvous_buffered + count > MIMPI_rendezvous_buffer) {
+        ASSERT_ZERO(pthread_cond_wait(&MIMPI_rendezvous_buffer_cond, &MIMPI_rendezvous_mutex));
+    }
+
+    MIMPI_rendezvous_buffered += count;
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_rendezvous_mutex));
+    return true;
+}
+
+
+/// @brief Sends data to the destination, see @ref MIMPI_Send.
+///
+/// @param data - data to be sent.
+/// @param count - number of bytes of data.
+/// @param destination - rank of the receiver.
+/// @param tag - tag of the message.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode send_message(
+    void const *data,
+    int count,
+    int destination,
+    int tag
+) {
+    CHECK_RANK_ERROR(destination);
+    CHECK_SELF_OP_ERROR(destination);
+
+    if (sent_by_rendezvous(count, tag)) {
+        // Within the budget, the send returns once the message is announced, the rendezvous thread writes a copy of the data.
+        if (reserve_copy(count)) {
+            request* req = (request*)malloc(sizeof(request));
+            void* copy = malloc(count);
+            ASSERT_MALLOC(req);
+            ASSERT_MALLOC(copy);
+            memcpy(copy, data, count);
+
+            return start_rendezvous(req, copy, count, destination, tag, true);
+        }
+
+        request req;
+        start_rendezvous(&req, data, count, destination, tag, false);
+
+        return wait_send(&req);
+    }
+
+    wait_queued_sends(&MIMPI_peers[destination]);
+    track_send(destination, count, tag);
+
+    const frame_header header = build_header(tag, count, 0, 0);
+
+    if (!write_frame(destination, &header, data, true)) {
+        return MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Matches a receive with a message taken out of the queue of its source.
+///
+/// @param pr - peer the message comes from, locked by the caller.
+/// @param req - pointer to the request describing the receive.
+/// @param el - element of the message.
+static void match_queued(
+    peer* pr,
+    request* req,
+    elem* el
+) {
+    if (el->message->announced) {
+        clear_receive(pr, req, el);
+    }
+    else {
+        req->found = el;
+        req->matched_tag = el->message->tag;
+        req->message.received = true;
+    }
+}
+
+
+/// @brief Posts a receive for any source, matching it with the earliest message already received if possible.
+///
+/// Once posted, the receive is visible to all readers, so a message arriving later is
+/// either matched with it by its reader or is already queued when its source is searched.
+///
+/// @param req - pointer to the request describing the receive, its source is not known yet.
+static void post_any_receive(
+    request* req
+) {
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+
+    push_front(MIMPI_any_posted, &req->posted);
+    atomic_fetch_add(&MIMPI_any_pending, 1);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+
+    while (true) {
+        // Queues keep messages in the order of arrival, so only the oldest match of every source is compared.
+        int earliest = -1;
+        uint64_t earliest_arrival = UINT64_MAX;
+
+        for (int i = 0; i < MIMPI_size; i++) {
+            if (i == MIMPI_rank) continue;
+
+            peer* pr = &MIMPI_peers[i];
+            ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+            elem* el = queue_find(pr->received_messages, req->message.tag, req->message.count);
+            if (el != NULL && el->message->arrival < earliest_arrival) {
+                earliest = i;
+                earliest_arrival = el->message->arrival;
+            }
+
+            ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+        }
+
+        if (earliest < 0)
+            return;
+
+        peer* pr = &MIMPI_peers[earliest];
+        ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+        elem* el = queue_find(pr->received_messages, req->message.tag, req->message.count);
+        bool matched = false, bound = false;
+
+        if (el != NULL) {
+            ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+
+            // A reader may have matched the receive with a new message in the meantime.
+            bound = req->message.source != MIMPI_ANY_SOURCE;
+            if (!bound) {
+                unlink_from_list(&req->posted);
+                atomic_fetch_sub(&MIMPI_any_pending, 1);
+                req->message.source = earliest;
+                matched = true;
+            }
+
+            ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+        }
+
+        if (matched) {
+            queue_detach(pr->received_messages, el);
+            match_queued(pr, req, el);
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+        if (matched || bound)
+            return;
+    }
+}
+
+
+/// @brief Describes a receive which has not been matched yet.
+///
+/// @param req - pointer to the request describing the receive.
+/// @param data - place where received data is to be put.
+/// @param count - number of bytes of data to be received.
+/// @param source - rank of the process the data comes from, or MIMPI_ANY_SOURCE.
+/// @param tag - identifier of the message.
+static void init_receive(
+    request* req,
+    void* data,
+    int count,
+    int source,
+    int tag
+) {
+    *req = (request) {
+        .message = {
+            .tag = tag, .count = count, .source = source, .received = false, .claimed = false,
+            .data = is_plain_data_tag(tag) ? data : NULL
+        },
+        .found = NULL, .buffer = data, .is_send = false, .ticket = NO_TICKET, .result = MIMPI_SUCCESS,
+        .any_source = source == MIMPI_ANY_SOURCE, .posted_order = atomic_fetch_add(&MIMPI_posts, 1), .matched_tag = tag
+    };
+    req->posted = (elem) {.next = NULL, .prev = NULL, .message = &req->message};
+}
+
+
+/// @brief Posts a receive, matching it with a message already received if possible.
+///
+/// @param req - pointer to the request describing the receive.
+/// @param data - place where received data is to be put.
+/// @param count - number of bytes of data to be received.
+/// @param source - rank of the process the data comes from, or MIMPI_ANY_SOURCE.
+/// @param tag - identifier of the message.
+static void post_receive(
+    request* req,
+    void* data,
+    int count,
+    int source,
+    int tag
+) {
+    init_receive(req, data, count, source, tag);
+
+    if (req->any_source) {
+        post_any_receive(req);
+        return;
+    }
+
+    peer* pr = &MIMPI_peers[source];
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    elem* elem_found = queue_find(pr->received_messages, tag, count);
+
+    if (elem_found != NULL) {
+        queue_detach(pr->received_messages, elem_found);
+        match_queued(pr, req, elem_found);
+    }
+    else {
+        push_front(pr->posted, &req->posted);
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+}
+
+
+/// @brief Checks whether a posted receive cannot make any more progress.
+///
+/// @param pr - peer the receive is posted on, locked by the caller.
+/// @param req - pointer to the request describing the receive.
+///
+/// @return bool:
+///     - true if the receive has been matched or its peer has left.
+static bool receive_done(
+    peer* pr,
+    request* req
+) {
+    return req->message.received || pr->already_left;
+}
+
+
+/// @brief Reports the number of messages read from a process back to it.
+///
+/// @param pr - peer the messages come from, locked by the caller.
+/// @param source - rank of the process.
+static void acknowledge_arrivals(
+    peer* pr,
+    int source
+) {
+    int arrived = pr->arrived;
+    pr->acknowledged = arrived;
+
+    send_control(source, MIMPI_RECEIVED_TAG, 0, 0, arrived);
+}
+
+
+/// @brief Removes the oldest receive the peer reported to be waiting on, if any.
+///
+/// @param pr - peer the receive comes from, locked by the caller.
+static void remove_first_others_recv(
+    peer* pr
+) {
+    elem* first_on_list = pr->others_recv->tail->next;
+
+    if (first_on_list->message != NULL)
+        remove_from_list(first_on_list);
+}
+
+
+/// @brief Fails a receive whose source already waits for a message from this process.
+///
+/// @param pr - peer the receive is posted on, locked by the caller.
+/// @param req - pointer to the request describing the receive.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_ERROR_DEADLOCK_DETECTED if the source waits, MIMPI_SUCCESS otherwise.
+static MIMPI_Retcode detect_deadlock(
+    peer* pr,
+    request* req
+) {
+    elem* first_on_list = pr->others_recv->tail->next;
+    Message* msg = first_on_list->message;
+
+    if (msg == NULL || msg->tag < MIMPI_ANY_TAG)
+        return MIMPI_SUCCESS;
+
+    unlink_from_list(&req->posted);
+    remove_from_list(first_on_list);
+
+    send_control(req->message.source, MIMPI_DEADLOCK_TAG, MIMPI_DEFAULT_COUNT, 0, 0);
+    return MIMPI_ERROR_DEADLOCK_DETECTED;
+}
+
+
+/// @brief Reports a receive about to block to its source.
+///
+/// Along with the receive goes the number of messages read from the source,
+/// so that it knows which of the matching messages it sent are still on their way.
+///
+/// @param pr - peer the receive is posted on, locked by the caller.
+/// @param req - pointer to the request describing the receive.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if the report has been sent.
+///     - MIMPI_ERROR_REMOTE_FINISHED if the source has left.
+static MIMPI_Retcode report_waiting(
+    peer* pr,
+    request* req
+) {
+    pr->acknowledged = pr->arrived;
+
+    if (send_control(req->message.source, MIMPI_WAITING_TAG, req->message.count, req->message.tag, pr->arrived)
+        == MIMPI_ERROR_REMOTE_FINISHED) {
+        unlink_from_list(&req->posted);
+        remove_first_others_recv(pr);
+        return MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Finds the oldest queued message of a peer matched by a probe.
+///
+/// Unlike receives, probes match messages of any count up to a limit.
+///
+/// @param pr - peer the messages come from, locked by the caller.
+/// @param tag - tag to be matched, MIMPI_ANY_TAG matches any tag of a user message.
+/// @param max_count - greatest count to be matched.
+///
+/// @return elem*:
+///     - pointer to the element of the found message, NULL if none matches.
+static elem* find_probed(
+    peer* pr,
+    int tag,
+    int max_count
+) {
+    list* arrivals = pr->received_messages->arrivals;
+
+    for (elem* current = arrivals->tail->next; current != arrivals->head; current = current->next) {
+        const Message* m = current->message;
+
+        if ((tag == MIMPI_ANY_TAG ? m->tag > MIMPI_ANY_TAG : m->tag == tag) && m->count <= max_count)
+            return current;
+    }
+
+    return NULL;
+}
+
+
+/// @brief Looks once for the oldest queued message matched by a probe, optionally receiving it.
+///
+/// @param source - rank of the sender, or MIMPI_ANY_SOURCE.
+/// @param tag - tag to be matched, MIMPI_ANY_TAG matches any tag of a user message.
+/// @param max_count - greatest count to be matched.
+/// @param found - place for the flag whether a message has been found.
+/// @param status - place for the description of the found message, may be NULL.
+/// @param take - receive the found message is matched with, NULL to leave the message queued.
+/// @param data - place where the data of the taken message is to be put.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if a message has been found or may still arrive.
+///     - MIMPI_ERROR_REMOTE_FINISHED if no message has been found and all probed processes have left.
+static MIMPI_Retcode probe_once(
+    int source,
+    int tag,
+    int max_count,
+    bool* found,
+    MIMPI_Status* status,
+    request* take,
+    void* data
+) {
+    const int first = source == MIMPI_ANY_SOURCE ? 0 : source;
+    const int last = source == MIMPI_ANY_SOURCE ? MIMPI_size - 1 : source;
+    *found = false;
+
+    while (true) {
+        int earliest = -1, probed = 0, left = 0;
+        uint64_t earliest_arrival = UINT64_MAX;
+
+        for (int i = first; i <= last; i++) {
+            if (i == MIMPI_rank) continue;
+
+            peer* pr = &MIMPI_peers[i];
+            ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+            elem* el = find_probed(pr, tag, max_count);
+            if (el != NULL && el->message->arrival < earliest_arrival) {
+                earliest = i;
+                earliest_arrival = el->message->arrival;
+            }
+
+            probed++;
+            left += pr->already_left;
+
+            ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+        }
+
+        // Messages of a process are all queued before it is known to have left.
+        if (earliest < 0)
+            return left == probed ? MIMPI_ERROR_REMOTE_FINISHED : MIMPI_SUCCESS;
+
+        peer* pr = &MIMPI_peers[earliest];
+        ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+        // Another thread may have received the message in the meantime.
+        elem* el = find_probed(pr, tag, max_count);
+        if (el == NULL || el->message->arrival != earliest_arrival) {
+            ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+            continue;
+        }
+
+        if (status != NULL)
+            *status = (MIMPI_Status) {.source = earliest, .tag = el->message->tag, .count = el->message->count};
+
+        if (take != NULL) {
+            init_receive(take, data, el->message->count, earliest, tag);
+            queue_detach(pr->received_messages, el);
+            match_queued(pr, take, el);
+        }
+
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+        *found = true;
+        return MIMPI_SUCCESS;
+    }
+}
+
+
+/// @brief Waits for a queued message matched by a probe, optionally receiving it.
+///
+/// @param source - rank of the sender, or MIMPI_ANY_SOURCE.
+/// @param tag - tag to be matched, MIMPI_ANY_TAG matches any tag of a user message.
+/// @param max_count - greatest count to be matched.
+/// @param status - place for the description of the found message, may be NULL.
+/// @param take - receive the found message is matched with, NULL to leave the message queued.
+/// @param data - place where the data of the taken message is to be put.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if a message has been found.
+///     - MIMPI_ERROR_REMOTE_FINISHED if all probed processes have left without sending a matching message.
+static MIMPI_Retcode wait_probe(
+    int source,
+    int tag,
+    int max_count,
+    MIMPI_Status* status,
+    request* take,
+    void* data
+) {
+    MIMPI_Retcode ret = MIMPI_SUCCESS;
+    bool found = false;
+
+    // Whatever is awaited may depend on messages still in batches.
+    flush_batches();
+
+    // Readers check for probes after queueing, so a message queued after a count was taken is always noticed.
+    atomic_fetch_add(&MIMPI_probes, 1);
+
+    while (ret == MIMPI_SUCCESS && !found) {
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+        const int peers_left = MIMPI_peers_left;
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+        const uint64_t arrivals = atomic_load(&MIMPI_arrivals);
+
+        ret = probe_once(source, tag, max_count, &found, status, take, data);
+
+        if (ret == MIMPI_SUCCESS && !found) {
+            ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+
+            while (atomic_load(&MIMPI_arrivals) == arrivals && MIMPI_peers_left == peers_left) {
+                ASSERT_ZERO(pthread_cond_wait(&MIMPI_any_cond, &MIMPI_any_mutex));
+            }
+
+            ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+        }
+    }
+
+    atomic_fetch_sub(&MIMPI_probes, 1);
+    return ret;
+}
+
+
+/// @brief Waits until a receive for any source is matched with a message.
+///
+/// @param req - pointer to the request describing the receive.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if the receive has been matched, its source is known then.
+///     - MIMPI_ERROR_REMOTE_FINISHED if all other processes have left without sending a matching message.
+static MIMPI_Retcode wait_any_source(
+    request* req
+) {
+    MIMPI_Retcode ret = MIMPI_SUCCESS;
+
+    // Whatever is awaited may depend on messages still in batches.
+    flush_batches();
+
+    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+
+    while (req->message.source == MIMPI_ANY_SOURCE && MIMPI_peers_left < MIMPI_size - 1) {
+        ASSERT_ZERO(pthread_cond_wait(&MIMPI_any_cond, &MIMPI_any_mutex));
+    }
+
+    if (req->message.source == MIMPI_ANY_SOURCE) {
+        unlink_from_list(&req->posted);
+        atomic_fetch_sub(&MIMPI_any_pending, 1);
+        ret = MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+    return ret;
+}
+
+
+/// @brief Lets the processor know the thread is spinning.
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+
+/// @brief Spins for up to MIMPI_spin_ns nanoseconds, waiting for a posted receive to complete.
+///
+/// The lock is released while spinning, readers signalling the peer only bump a counter the
+/// receive watches, so a message arriving in time costs no wake-up of a sleeping thread.
+///
+/// @param pr - peer the receive is posted on, locked by the caller and locked again on return.
+/// @param req - pointer to the request describing the receive.
+static void spin_receive(
+    peer* pr,
+    request* req
+) {
+    struct timespec now;
+    ASSERT_SYS_OK(clock_gettime(CLOCK_MONOTONIC, &now));
+    const int64_t deadline = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec + MIMPI_spin_ns;
+    unsigned int seen = atomic_load_explicit(&pr->wakeups, memory_order_relaxed);
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+    for (;;) {
+        for (int i = 0; i < SPIN_CLOCK_INTERVAL; i++) {
+            if (atomic_load_explicit(&pr->wakeups, memory_order_acquire) != seen)
+                break;
+            cpu_relax();
+        }
+
+        if (atomic_load_explicit(&pr->wakeups, memory_order_acquire) != seen) {
+            ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+            if (receive_done(pr, req))
+                return;
+            seen = atomic_load_explicit(&pr->wakeups, memory_order_relaxed);
+            ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+        }
+
+        ASSERT_SYS_OK(clock_gettime(CLOCK_MONOTONIC, &now));
+        if ((int64_t)now.tv_sec * 1000000000 + now.tv_nsec >= deadline)
+            break;
+    }
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+}
+
+
+/// @brief Waits for a posted receive to complete and delivers its data.
+///
+/// @param req - pointer to the request describing the receive.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS if the data has been delivered.
+///     - MIMPI_ERROR_REMOTE_FINISHED if the source has left without sending it.
+///     - MIMPI_ERROR_DEADLOCK_DETECTED if the receive would never complete.
+static MIMPI_Retcode wait_receive(
+    request* req
+) {
+    if (req->any_source) {
+        HANDLE_REMOTE_FINISHED(wait_any_source(req));
+    }
+
+    const int source = req->message.source;
+    const int count = req->message.count;
+    const int tag = req->message.tag;
+    peer* pr = &MIMPI_peers[source];
+
+    // Whatever is awaited may depend on messages still in batches.
+    flush_batches();
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+
+    // In low-latency mode a receive spins a while before blocking, arrivals then need not wake it up.
+    if (MIMPI_spin_ns > 0 && !receive_done(pr, req))
+        spin_receive(pr, req);
+
+    if (!receive_done(pr, req)) {
+        STATS_CLOCK(blocked_since);
+
+        // Data of a cleared message is already on its way, so the receive cannot take part in a deadlock.
+        // Receives for any source took no part in the wait-for graph before they were matched, nor do they now.
+        if (MIMPI_deadlock_enabled && tag >= MIMPI_ANY_TAG && req->ticket == NO_TICKET && !req->any_source) {
+            MIMPI_Retcode ret = detect_deadlock(pr, req);
+
+            // Most receives complete soon, those do not have to be reported at all.
+            if (ret == MIMPI_SUCCESS && MIMPI_deadlock_timeout > 0) {
+                struct timespec deadline;
+                ASSERT_SYS_OK(clock_gettime(CLOCK_REALTIME, &deadline));
+                deadline.tv_sec += MIMPI_deadlock_timeout / 1000;
+                deadline.tv_nsec += (long)(MIMPI_deadlock_timeout % 1000) * 1000000;
+                if (deadline.tv_nsec >= 1000000000) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000;
+                }
+
+                int wait_ret = 0;
+                while (!receive_done(pr, req) && wait_ret != ETIMEDOUT) {
+                    wait_ret = pthread_cond_timedwait(&pr->cond, &pr->mutex, &deadline);
+                    ASSERT_ZERO(wait_ret == ETIMEDOUT ? 0 : wait_ret);
+                }
+
+                if (!receive_done(pr, req))
+                    ret = detect_deadlock(pr, req);
+            }
+
+            if (ret == MIMPI_SUCCESS && !receive_done(pr, req))
+                ret = report_waiting(pr, req);
+
+            if (ret != MIMPI_SUCCESS) {
+                ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+                STATS_SINCE(MIMPI_stats.recv_wait_ns, blocked_since);
+                return ret;
+            }
+        }
+
+        pr->blocked = req;
+
+        while (!receive_done(pr, req)) {
+            ASSERT_ZERO(pthread_cond_wait(&pr->cond, &pr->mutex));
+        }
+
+        // Other threads may block on the same source, only the latest receive is checked for deadlocks.
+        if (pr->blocked == req)
+            pr->blocked = NULL;
+
+        STATS_SINCE(MIMPI_stats.recv_wait_ns, blocked_since);
+    }
+
+    if (req->result == MIMPI_ERROR_DEADLOCK_DETECTED) {
+        remove_first_others_recv(pr);
+
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+        return MIMPI_ERROR_DEADLOCK_DETECTED;
+    }
+
+    if (!req->message.received) {
+        unlink_from_list(&req->posted);
+        ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+        return MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    if (MIMPI_deadlock_enabled && tag >= MIMPI_ANY_TAG && pr->arrived - pr->acknowledged >= ARRIVAL_ACK_BATCH) {
+        acknowledge_arrivals(pr, source);
+    }
+
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+    elem* elem_found = req->found;
+    req->found = NULL;
+
+    if (elem_found) {
+        if (is_reduce_tag(tag)) {
+            handle_reduce_operation(elem_found->message->data, count, tag, req->buffer);
+        }
+        else if (carries_payload(tag)) {
+            memcpy(req->buffer, elem_found->message->data, count);
+        }
+
+        delete_elem(elem_found);
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Send(
+    void const *data,
+    int count,
+    int destination,
+    int tag
+) {
+    trace('B', "MIMPI_Send", destination, tag, count);
+    MIMPI_Retcode ret = send_message(data, count, destination, tag);
+    trace('E', "MIMPI_Send", destination, tag, ret);
+
+    return ret;
+}
+
+
+/// @brief Fills the status of a completed receive.
+///
+/// @param req - pointer to the request describing the receive.
+/// @param status - place for the status, may be NULL.
+static void fill_status(
+    const request* req,
+    MIMPI_Status* status
+) {
+    if (status == NULL)
+        return;
+
+    *status = (MIMPI_Status) {.source = req->message.source, .tag = req->matched_tag, .count = req->message.count};
+}
+
+
+/// @brief Receives data from the source, see @ref MIMPI_Recv_status.
+///
+/// @param data - place for the data.
+/// @param count - number of bytes of data.
+/// @param source - rank of the sender, or MIMPI_ANY_SOURCE.
+/// @param tag - tag of the message.
+/// @param status - place for the status of the receive, may be NULL.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode receive_message(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    if (source != MIMPI_ANY_SOURCE) {
+        CHECK_RANK_ERROR(source);
+        CHECK_SELF_OP_ERROR(source);
+    }
+
+    request req;
+    post_receive(&req, data, count, source, tag);
+
+    MIMPI_Retcode ret = wait_receive(&req);
+    if (ret == MIMPI_SUCCESS)
+        fill_status(&req, status);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Recv(
+    void *data,
+    int count,
+    int source,
+    int tag
+) {
+    return MIMPI_Recv_status(data, count, source, tag, NULL);
+}
+
+
+MIMPI_Retcode MIMPI_Recv_status(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    trace('B', "MIMPI_Recv", source, tag, count);
+    MIMPI_Retcode ret = receive_message(data, count, source, tag, status);
+    trace('E', "MIMPI_Recv", source, tag, ret);
+
+    return ret;
+}
+
+
+/// @brief Receives a message of any size up to the given one, see @ref MIMPI_Recv_up_to.
+///
+/// @param data - place for the data.
+/// @param max_count - greatest number of bytes of data.
+/// @param source - rank of the sender, or MIMPI_ANY_SOURCE.
+/// @param tag - tag of the message.
+/// @param status - place for the status of the receive, may be NULL.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode receive_up_to(
+    void *data,
+    int max_count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    if (source != MIMPI_ANY_SOURCE) {
+        CHECK_RANK_ERROR(source);
+        CHECK_SELF_OP_ERROR(source);
+    }
+
+    request req;
+    MIMPI_Retcode ret = wait_probe(source, tag, max_count, NULL, &req, data);
+
+    if (ret == MIMPI_SUCCESS)
+        ret = wait_receive(&req);
+    if (ret == MIMPI_SUCCESS)
+        fill_status(&req, status);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Recv_up_to(
+    void *data,
+    int max_count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    trace('B', "MIMPI_Recv_up_to", source, tag, max_count);
+    MIMPI_Retcode ret = receive_up_to(data, max_count, source, tag, status);
+    trace('E', "MIMPI_Recv_up_to", source, tag, ret);
+
+    return ret;
+}
+
+
+/// @brief Sends data to one process while receiving from another, see @ref MIMPI_Sendrecv.
+///
+/// The receive is posted before sending, so the peer's message, even an announced one, is cleared
+/// while the send of the calling process blocks, which it does on a full channel, or for a message
+/// sent by rendezvous whose copy does not fit in the memory for copies.
+///
+/// @param send_data - data to be sent.
+/// @param send_count - number of bytes of data to be sent.
+/// @param destination - rank of the receiver.
+/// @param send_tag - tag of the message sent.
+/// @param recv_data - place for the data received.
+/// @param recv_count - number of bytes of data to be received.
+/// @param source - rank of the sender, or MIMPI_ANY_SOURCE.
+/// @param recv_tag - tag of the message received.
+/// @param status - place for the status of the receive, may be NULL.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, the error of the send or else of the receive otherwise.
+static MIMPI_Retcode exchange_messages(
+    void const *send_data,
+    int send_count,
+    int destination,
+    int send_tag,
+    void *recv_data,
+    int recv_count,
+    int source,
+    int recv_tag,
+    MIMPI_Status *status
+) {
+    CHECK_RANK_ERROR(destination);
+    CHECK_SELF_OP_ERROR(destination);
+    if (source != MIMPI_ANY_SOURCE) {
+        CHECK_RANK_ERROR(source);
+        CHECK_SELF_OP_ERROR(source);
+    }
+
+    request req;
+    post_receive(&req, recv_data, recv_count, source, recv_tag);
+
+    // The receive is waited for even if the send fails, as it is posted already.
+    const MIMPI_Retcode send_ret = send_message(send_data, send_count, destination, send_tag);
+    const MIMPI_Retcode recv_ret = wait_receive(&req);
+
+    if (recv_ret == MIMPI_SUCCESS)
+        fill_status(&req, status);
+
+    return send_ret != MIMPI_SUCCESS ? send_ret : recv_ret;
+}
+
+
+MIMPI_Retcode MIMPI_Sendrecv(
+    void const *send_data,
+    int send_count,
+    int destination,
+    int send_tag,
+    void *recv_data,
+    int recv_count,
+    int source,
+    int recv_tag,
+    MIMPI_Status *status
+) {
+    trace('B', "MIMPI_Sendrecv", destination, send_tag, send_count);
+    MIMPI_Retcode ret = exchange_messages(send_data, send_count, destination, send_tag,
+                                          recv_data, recv_count, source, recv_tag, status);
+    trace('E', "MIMPI_Sendrecv", source, recv_tag, ret);
+
+    return ret;
+}
+
+
+/// @brief Sends a stream produced chunk by chunk, see @ref MIMPI_Send_stream.
+///
+/// Every chunk but the empty last one is acknowledged by a credit once received, and a
+/// chunk is only sent after the previous one has been, so the receiver queues at most one.
+///
+/// @param producer - function putting the data of the stream into chunks.
+/// @param context - argument passed to the producer.
+/// @param destination - rank of the receiver.
+/// @param tag - tag of the stream.
+/// @param buffer - place for a chunk.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode send_stream(
+    MIMPI_Stream_producer producer,
+    void *context,
+    int destination,
+    int tag,
+    char *buffer
+) {
+    bool credited = true;
+    int count;
+
+    do {
+        count = producer(context, buffer, STREAM_CHUNK_SIZE);
+        if (count < 0 || count > STREAM_CHUNK_SIZE)
+            fatal("Producer of a stream returned %d, expected at most %d bytes", count, STREAM_CHUNK_SIZE);
+
+        // The next chunk is produced while the previous one is on its way.
+        if (!credited)
+            HANDLE_REMOTE_FINISHED(receive_message(NULL, tag, destination, MIMPI_STREAM_CREDIT_TAG, NULL));
+
+        HANDLE_REMOTE_FINISHED(send_message(buffer, count, destination, tag));
+        credited = false;
+    } while (count > 0);
+
+    return MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Send_stream(
+    MIMPI_Stream_producer producer,
+    void *context,
+    int destination,
+    int tag
+) {
+    CHECK_RANK_ERROR(destination);
+    CHECK_SELF_OP_ERROR(destination);
+
+    char* buffer = (char*)malloc(STREAM_CHUNK_SIZE);
+    ASSERT_MALLOC(buffer);
+
+    trace('B', "MIMPI_Send_stream", destination, tag, 0);
+    MIMPI_Retcode ret = send_stream(producer, context, destination, tag, buffer);
+    trace('E', "MIMPI_Send_stream", destination, tag, ret);
+
+    free(buffer);
+    return ret;
+}
+
+
+/// @brief Receives a stream chunk by chunk, see @ref MIMPI_Recv_stream.
+///
+/// @param consumer - function taking the data of the stream out of chunks.
+/// @param context - argument passed to the consumer.
+/// @param source - rank of the sender.
+/// @param tag - tag of the stream.
+/// @param buffer - place for a chunk.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode receive_stream(
+    MIMPI_Stream_consumer consumer,
+    void *context,
+    int source,
+    int tag,
+    char *buffer
+) {
+    while (true) {
+        MIMPI_Status status = {.count = 0};
+        MIMPI_Retcode ret = receive_up_to(buffer, STREAM_CHUNK_SIZE, source, tag, &status);
+
+        if (ret != MIMPI_SUCCESS || status.count == 0)
+            return ret;
+
+        // The next chunk is on its way while this one is consumed.
+        HANDLE_REMOTE_FINISHED(send_message(NULL, tag, source, MIMPI_STREAM_CREDIT_TAG));
+        consumer(context, buffer, status.count);
+    }
+}
+
+
+MIMPI_Retcode MIMPI_Recv_stream(
+    MIMPI_Stream_consumer consumer,
+    void *context,
+    int source,
+    int tag
+) {
+    CHECK_RANK_ERROR(source);
+    CHECK_SELF_OP_ERROR(source);
+
+    char* buffer = (char*)malloc(STREAM_CHUNK_SIZE);
+    ASSERT_MALLOC(buffer);
+
+    trace('B', "MIMPI_Recv_stream", source, tag, 0);
+    MIMPI_Retcode ret = receive_stream(consumer, context, source, tag, buffer);
+    trace('E', "MIMPI_Recv_stream", source, tag, ret);
+
+    free(buffer);
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Probe(
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    if (source != MIMPI_ANY_SOURCE) {
+        CHECK_RANK_ERROR(source);
+        CHECK_SELF_OP_ERROR(source);
+    }
+
+    trace('B', "MIMPI_Probe", source, tag, 0);
+    MIMPI_Retcode ret = wait_probe(source, tag, INT_MAX, status, NULL, NULL);
+    trace('E', "MIMPI_Probe", source, tag, ret);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Iprobe(
+    int source,
+    int tag,
+    bool *found,
+    MIMPI_Status *status
+) {
+    *found = false;
+    if (source != MIMPI_ANY_SOURCE) {
+        CHECK_RANK_ERROR(source);
+        CHECK_SELF_OP_ERROR(source);
+    }
+
+    flush_batches();
+    return probe_once(source, tag, INT_MAX, found, status, NULL, NULL);
+}
+
+
+MIMPI_Retcode MIMPI_Isend(
+    void const *data,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Request *request_ptr
+) {
+    *request_ptr = MIMPI_REQUEST_NULL;
+    CHECK_RANK_ERROR(destination);
+    CHECK_SELF_OP_ERROR(destination);
+
+    request* req = (request*)malloc(sizeof(request));
+    ASSERT_MALLOC(req);
+
+    if (sent_by_rendezvous(count, tag)) {
+        start_rendezvous(req, data, count, destination, tag, false);
+    }
+    else if (count >= ISEND_QUEUE_THRESHOLD && MIMPI_rendezvous_running && MIMPI_send_buffer == 0) {
+        queue_eager_send(req, data, count, destination, tag);
+    }
+    else {
+        // Small messages, and those copied to writer threads anyway, are not worth handing over.
+        // Reader threads drain every channel into their pools, so an eager send never waits
+        // for a matching receive and can be completed at once.
+        *req = (request) {
+            .message = {.source = destination, .received = true},
+            .is_send = true, .ticket = NO_TICKET, .result = MIMPI_Send(data, count, destination, tag)
+        };
+    }
+
+    *request_ptr = req;
+    return MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Irecv(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Request *request_ptr
+) {
+    *request_ptr = MIMPI_REQUEST_NULL;
+    if (source != MIMPI_ANY_SOURCE) {
+        CHECK_RANK_ERROR(source);
+        CHECK_SELF_OP_ERROR(source);
+    }
+
+    request* req = (request*)malloc(sizeof(request));
+    ASSERT_MALLOC(req);
+
+    post_receive(req, data, count, source, tag);
+
+    *request_ptr = req;
+    return MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Wait(
+    MIMPI_Request *request_ptr
+) {
+    return MIMPI_Wait_status(request_ptr, NULL);
+}
+
+
+MIMPI_Retcode MIMPI_Wait_status(
+    MIMPI_Request *request_ptr,
+    MIMPI_Status *status
+) {
+    request* req = *request_ptr;
+    if (req == MIMPI_REQUEST_NULL)
+        return MIMPI_SUCCESS;
+
+    // Persistent collectives complete in MIMPI_Start and stay until freed.
+    if (req->planned != NULL)
+        return req->result;
+
+    MIMPI_Retcode ret = req->is_send ? wait_send(req) : wait_receive(req);
+    if (ret == MIMPI_SUCCESS && !req->is_send)
+        fill_status(req, status);
+
+    free(req);
+    *request_ptr = MIMPI_REQUEST_NULL;
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Test(
+    MIMPI_Request *request_ptr,
+    bool *completed
+) {
+    request* req = *request_ptr;
+    *completed = true;
+
+    if (req == MIMPI_REQUEST_NULL || req->planned != NULL)
+        return MIMPI_Wait(request_ptr);
+
+    flush_batches();
+
+    if (req->any_source) {
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_any_mutex));
+        bool unbound = req->message.source == MIMPI_ANY_SOURCE;
+        bool failed = unbound && MIMPI_peers_left == MIMPI_size - 1;
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_any_mutex));
+
+        // Waiting reports the failure of a receive nobody is left to match.
+        if (unbound) {
+            *completed = failed;
+            return failed ? MIMPI_Wait(request_ptr) : MIMPI_SUCCESS;
         }
-    
-        bytes_wrote += current_wrote;
     }
 
-    return true;
+    peer* pr = &MIMPI_peers[req->message.source];
+
+    ASSERT_ZERO(pthread_mutex_lock(&pr->mutex));
+    *completed = req->is_send ? send_done(pr, req) : receive_done(pr, req);
+    ASSERT_ZERO(pthread_mutex_unlock(&pr->mutex));
+
+    // A completed operation stays completed, so waiting for it does not block.
+    return *completed ? MIMPI_Wait(request_ptr) : MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Waitall(
+    int count,
+    MIMPI_Request *requests
+) {
+    MIMPI_Retcode ret = MIMPI_SUCCESS;
+
+    for (int i = 0; i < count; i++) {
+        MIMPI_Retcode op_ret = MIMPI_Wait(&requests[i]);
+
+        if (ret == MIMPI_SUCCESS)
+            ret = op_ret;
+    }
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Flush() {
+    MIMPI_Retcode ret = MIMPI_SUCCESS;
+
+    for (int i = 0; i < MIMPI_size && MIMPI_coalesce_size > 0; i++) {
+        if (i == MIMPI_rank) continue;
+
+        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_peers[i].send_mutex));
+
+        if (!write_batch(i))
+            ret = MIMPI_ERROR_REMOTE_FINISHED;
+
+        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_peers[i].send_mutex));
+    }
+
+    return ret;
+}
+
+
+/// @brief Synchronises all processes of a group, see @ref MIMPI_Barrier.
+///
+/// @param comm - group to be synchronised.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode barrier(
+    const communicator* comm
+) {
+    if (MIMPI_barrier_algorithm == BARRIER_DISSEMINATION) {
+        // After the round with distance d, a process has heard, directly or not, from the 2d processes behind it.
+        for (int distance = 1; distance < comm->size; distance *= 2) {
+            const int ahead = (comm->rank + distance) % comm->size;
+            const int behind = (comm->rank - distance + comm->size) % comm->size;
+
+            HANDLE_REMOTE_FINISHED(group_send(comm, NULL, MIMPI_DEFAULT_COUNT, ahead, MIMPI_NO_MESSAGE_TAG));
+            HANDLE_REMOTE_FINISHED(group_recv(comm, NULL, MIMPI_DEFAULT_COUNT, behind, MIMPI_NO_MESSAGE_TAG));
+        }
+
+        return MIMPI_SUCCESS;
+    }
+
+    if (MIMPI_barrier_algorithm == BARRIER_KARY) {
+        HANDLE_REMOTE_FINISHED(walk_tree(comm, NULL, MIMPI_DEFAULT_COUNT, &comm->barrier_tree, MIMPI_NO_MESSAGE_TAG, true));
+
+        return walk_tree(comm, NULL, MIMPI_DEFAULT_COUNT, &comm->barrier_tree, MIMPI_NO_MESSAGE_TAG, false);
+    }
+
+    HANDLE_REMOTE_FINISHED(communication_loop(comm, NULL, MIMPI_DEFAULT_COUNT, 0, MIMPI_NO_MESSAGE_TAG, true));
+
+    return communication_loop(comm, NULL, MIMPI_DEFAULT_COUNT, 0, MIMPI_NO_MESSAGE_TAG, false);
+}
+
+
+MIMPI_Retcode MIMPI_Barrier() {
+    trace('B', "MIMPI_Barrier", -1, 0, 0);
+    MIMPI_Retcode ret = barrier(&MIMPI_world);
+    trace('E', "MIMPI_Barrier", -1, 0, ret);
+
+    return ret;
+}
+
+
+/// @brief Broadcasts data from the root to all processes of a group.
+///
+/// @param comm - group the broadcast runs in.
+/// @param data - data of the root, place for them in other processes.
+/// @param count - number of bytes of data.
+/// @param root - rank of the process whose data are broadcast.
+/// @param synchronise - flag whether the call has to be a synchronisation point.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode broadcast(
+    const communicator* comm,
+    void *data,
+    int count,
+    int root,
+    bool synchronise
+) {
+    CHECK_GROUP_RANK_ERROR(comm, root);
+
+    if (synchronise) {
+        HANDLE_REMOTE_FINISHED(communication_loop(comm, NULL, MIMPI_DEFAULT_COUNT, root, MIMPI_NO_MESSAGE_TAG, true));
+    }
+
+    // Data go down the tree in segments, so that a process forwards a segment
+    // to its children while the next one is already on the way from its parent.
+    const int segment = MIMPI_bcast_segment > 0 ? MIMPI_bcast_segment : count;
+    int offset = 0;
+
+    do {
+        const int length = MIN(segment, count - offset);
+
+        HANDLE_REMOTE_FINISHED(communication_loop(comm, (char*)data + offset, length, root, MIMPI_BROADCAST_TAG, false));
+
+        offset += length;
+    } while (offset < count);
+
+    return MIMPI_SUCCESS;
+}
+
+
+/// @brief Returns the staging buffer reductions of the process combine data in.
+///
+/// The buffer only grows, so that repeated reductions do not allocate.
+///
+/// @param bytes - number of bytes needed.
+///
+/// @return void*:
+///     - pointer to the buffer of at least @p bytes bytes.
+static void* reduce_staging(
+    size_t bytes
+) {
+    if (bytes > MIMPI_staging_size) {
+        free(MIMPI_staging);
+
+        MIMPI_staging = malloc(bytes);
+        ASSERT_MALLOC(MIMPI_staging);
+        MIMPI_staging_size = bytes;
+    }
+
+    return MIMPI_staging;
+}
+
+
+/// @brief Reduces typed data from all processes of a group to the root.
+///
+/// @param comm - group the reduction runs in.
+/// @param send_data - data to be reduced.
+/// @param recv_data - place for the result in the root.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param root - rank of the process who is to hold the result.
+/// @param staging - buffer of at least count elements to combine data in, NULL for the one of the process.
+/// @param synchronise - flag whether the call has to be a synchronisation point.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode reduce(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root,
+    void* staging,
+    bool synchronise
+) {
+    CHECK_GROUP_RANK_ERROR(comm, root);
+
+    const int element_size = MIMPI_DATATYPE_SIZES[datatype];
+    const int bytes = count * element_size;
+    if (send_data == MIMPI_IN_PLACE)
+        send_data = recv_data;
+
+    // The root combines data right in its result, leaves only pass their own data on.
+    // Other processes combine data in a staging buffer, as their own data must stay intact.
+    void* memory = comm->rank == root ? recv_data
+        : tree_plan(comm, root)->children_count == 0 ? (void*)send_data
+        : staging != NULL ? staging : reduce_staging(bytes);
+
+    if (memory != send_data) {
+        memcpy(memory, send_data, bytes);
+    }
+
+    // Data go up the tree in segments of whole elements, so that a process combines a segment
+    // from its children while the previous one is on the way to its parent.
+    const int segment = MIMPI_reduce_segment > 0 ? MAX(MIMPI_reduce_segment / element_size, 1) * element_size : bytes;
+    int offset = 0;
+
+    do {
+        const int length = MIN(segment, bytes - offset);
+
+        HANDLE_REMOTE_FINISHED(communication_loop(comm, (char*)memory + offset, length, root, reduce_tag(datatype, op), true));
+
+        offset += length;
+    } while (offset < bytes);
+
+    if (!synchronise) {
+        return MIMPI_SUCCESS;
+    }
+
+    return communication_loop(comm, NULL, MIMPI_DEFAULT_COUNT, root, MIMPI_NO_MESSAGE_TAG, false);
+}
+
+
+MIMPI_Retcode MIMPI_Bcast(
+    void *data,
+    int count,
+    int root
+) {
+    trace('B', "MIMPI_Bcast", root, 0, count);
+    MIMPI_Retcode ret = broadcast(&MIMPI_world, data, count, root, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Bcast", root, 0, ret);
+
+    return ret;
 }
 
 
-/// @brief Handles a reduce operation based on the tag.
+MIMPI_Retcode MIMPI_Bcast_nosync(
+    void *data,
+    int count,
+    int root
+) {
+    trace('B', "MIMPI_Bcast_nosync", root, 0, count);
+    MIMPI_Retcode ret = broadcast(&MIMPI_world, data, count, root, false);
+    trace('E', "MIMPI_Bcast_nosync", root, 0, ret);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+) {
+    trace('B', "MIMPI_Reduce", root, 0, count);
+    MIMPI_Retcode ret = reduce(&MIMPI_world, send_data, recv_data, count, MIMPI_UINT8, op, root, NULL, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Reduce", root, 0, ret);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Reduce_nosync(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+) {
+    trace('B', "MIMPI_Reduce_nosync", root, 0, count);
+    MIMPI_Retcode ret = reduce(&MIMPI_world, send_data, recv_data, count, MIMPI_UINT8, op, root, NULL, false);
+    trace('E', "MIMPI_Reduce_nosync", root, 0, ret);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Reduce_typed(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root
+) {
+    trace('B', "MIMPI_Reduce_typed", root, 0, count);
+    MIMPI_Retcode ret = reduce(&MIMPI_world, send_data, recv_data, count, datatype, op, root, NULL, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Reduce_typed", root, 0, ret);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Allreduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    return MIMPI_Allreduce_typed(send_data, recv_data, count, MIMPI_UINT8, op);
+}
+
+
+/// @brief Reduces typed data from all processes of a group and makes the result available to all of them.
 ///
-/// @param received_data - pointer to the data received.
-/// @param count - number of bytes in the data.
-/// @param tag - operation tag specified in MIMPI_Tags.
-/// @param data - pointer to the data to be applied in the reduce operation.
-static void handle_reduce_operation(
-    void* received_data,
+/// @param comm - group the allreduce runs in.
+/// @param send_data - data to be reduced.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode allreduce(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
     int count,
-    int tag,
-    void* data
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
 ) {
-    u_int8_t* dataInt = (u_int8_t*)data;
-    u_int8_t* messageDataInt = (u_int8_t*)received_data;
+    const int world_rank = comm->rank;
+    const int world_size = comm->size;
+    const int element_size = MIMPI_DATATYPE_SIZES[datatype];
+    const int bytes = count * element_size;
+    const int tag = reduce_tag(datatype, op);
+    char* buffer = recv_data;
+
+    if (send_data != MIMPI_IN_PLACE && recv_data != send_data) {
+        memcpy(buffer, send_data, bytes);
+    }
 
-    if (tag == MIMPI_MAX_TAG) {
-        for (int i = 0; i < count; i++) {
-            dataInt[i] = MAX(dataInt[i], messageDataInt[i]);
+    // Processes beyond the greatest power of two first hand their data over to a neighbour.
+    const int power = get_power(world_size);
+    const int extra = world_size - power;
+    const bool paired = world_rank < 2 * extra;
+    int group_rank = world_rank - extra;
+
+    if (paired) {
+        if (world_rank % 2 == 0) {
+            HANDLE_REMOTE_FINISHED(group_send(comm, buffer, bytes, world_rank + 1, tag));
+            group_rank = -1;
+        }
+        else {
+            HANDLE_REMOTE_FINISHED(group_recv(comm, buffer, bytes, world_rank - 1, tag));
+            group_rank = world_rank / 2;
         }
     }
-    else if (tag == MIMPI_MIN_TAG) {
-        for (int i = 0; i < count; i++) {
-            dataInt[i] = MIN(dataInt[i], messageDataInt[i]);
-        }   
-    }
-    else if (tag == MIMPI_SUM_TAG) {
-        for (int i = 0; i < count; i++) {
-            dataInt[i] += messageDataInt[i];
+
+    if (group_rank >= 0) {
+        if (bytes >= ALLREDUCE_LARGE_SIZE && count >= power) {
+            HANDLE_REMOTE_FINISHED(allreduce_rabenseifner(comm, buffer, count, element_size, tag, group_rank, power, extra));
+        }
+        else {
+            HANDLE_REMOTE_FINISHED(allreduce_recursive_doubling(comm, buffer, bytes, tag, group_rank, power, extra));
         }
     }
-    else {
-        for (int i = 0; i < count; i++) {
-            dataInt[i] *= messageDataInt[i];
+
+    if (paired) {
+        if (world_rank % 2 == 0) {
+            HANDLE_REMOTE_FINISHED(group_recv(comm, buffer, bytes, world_rank + 1, MIMPI_BROADCAST_TAG));
+        }
+        else {
+            HANDLE_REMOTE_FINISHED(group_send(comm, buffer, bytes, world_rank - 1, MIMPI_BROADCAST_TAG));
         }
     }
 
-    memcpy(data, dataInt, count);
+    flush_batches();
+    return MIMPI_SUCCESS;
+}
+
+
+MIMPI_Retcode MIMPI_Allreduce_typed(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+) {
+    return allreduce(&MIMPI_world, send_data, recv_data, count, datatype, op);
 }
 
 
-/// @brief Determines the power of 2 corresponding to the given rank.
+/// @brief Maps ranks between the world and the binomial tree rooted at 0, which swaps the root and 0.
 ///
-/// @param rank - rank of the process.
+/// @param rank - rank in the world or in the tree, the mapping is its own inverse.
+/// @param root - rank of the root process.
 ///
 /// @return int:
-///     - power of 2 associated with the rank.
-static int get_power(
-    int rank
+///     - rank on the other side of the mapping.
+static int tree_rank(
+    int rank,
+    int root
 ) {
-    if (rank <= 1) return rank;
-    if (rank <= 3) return 2;
-    if (rank <= 7) return 4;
-    return 8;
+    return rank == root ? 0 : rank == 0 ? root : rank;
 }
 
 
-/// @brief Handles communication loop for group functions.
+/// @brief Counts processes in the subtree of a process in the binomial tree rooted at 0.
 ///
-/// @param data - pointer to the data for communication.
-/// @param count - number of bytes in the data.
+/// The subtree of rank r > 0 holds the ranks congruent to r modulo twice the power of r.
+///
+/// @param rank - rank in the tree.
+/// @param size - total number of processes.
+///
+/// @return int:
+///     - number of processes in the subtree, including the process itself.
+static int subtree_size(
+    int rank,
+    int size
+) {
+    if (rank == 0) return size;
+
+    const int modulus = 2 * get_power(rank);
+
+    return (size - rank + modulus - 1) / modulus;
+}
+
+
+/// @brief Moves blocks of a subtree between preorder, in which gather and scatter pass them, and rank order.
+///
+/// @param preorder - blocks of the subtree, the process first, followed by subtrees of its children.
+/// @param ranked - blocks of all processes ordered by rank in the world.
+/// @param count - number of bytes of a single block.
+/// @param rank - rank in the tree of the process heading the subtree.
 /// @param root - rank of the root process.
-/// @param tag - identifier to be passed in communication.
-/// @param world_rank - rank of the current process.
-/// @param world_size - total number of processes.
-/// @param begin - flag indicating the start of the communication loop.
+/// @param size - number of processes in the group.
+/// @param position - index in @p preorder of the block of the process, advanced past the subtree.
+/// @param to_ranked - flag whether blocks move from @p preorder to @p ranked, rather than the other way.
+static void permute_blocks(
+    char* preorder,
+    char* ranked,
+    int count,
+    int rank,
+    int root,
+    int size,
+    int* position,
+    bool to_ranked
+) {
+    char* block = ranked + (size_t)tree_rank(rank, root) * count;
+    char* packed = preorder + (size_t)(*position)++ * count;
+
+    if (to_ranked) {
+        memcpy(block, packed, count);
+    }
+    else {
+        memcpy(packed, block, count);
+    }
+
+    // Children come in the order of build_schedule.
+    int power = rank == 0 ? 1 : get_power(rank) * 2;
+
+    for (int child = rank + power; child < size; child += power, power *= 2) {
+        permute_blocks(preorder, ranked, count, child, root, size, position, to_ranked);
+    }
+}
+
+
+/// @brief Collects a block from every process in the root, among processes of a group.
+///
+/// @param comm - group the gather runs in.
+/// @param send_data - block of the process.
+/// @param recv_data - place for all blocks in the root.
+/// @param count - number of bytes of a single block.
+/// @param root - rank of the process who is to hold the blocks.
+/// @param synchronise - flag whether the call has to be a synchronisation point.
 ///
 /// @return MIMPI_Retcode:
 ///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
-static MIMPI_Retcode communication_loop(
-    void* data, 
-    int count, 
-    int root, 
-    int tag, 
-    int world_rank, 
-    int world_size, 
-    bool begin
-) { 
-    int receive_from = world_rank - get_power(world_rank);
-    int power = get_power(world_rank) * 2;
-    int start_from = world_rank + power;
+static MIMPI_Retcode gather(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root,
+    bool synchronise
+) {
+    CHECK_GROUP_RANK_ERROR(comm, root);
 
-    if (world_rank == root) {
-        power = 1;
-        start_from = 1;
-    }
-    else if (world_rank == 0) {
-        receive_from = root - get_power(root);
-        power = get_power(root) * 2;
-        start_from = root + power;
+    const schedule* plan = &comm->schedules[root];
+    const int blocks = subtree_size(tree_rank(comm->rank, root), comm->size);
+
+    // Leaves send their block right away, others assemble their subtree in preorder first.
+    char* buffer = (char*)send_data;
+
+    if (blocks > 1 || plan->parent < 0) {
+        buffer = reduce_staging((size_t)blocks * count);
+        memcpy(buffer, send_data, count);
     }
 
-    if (begin) {
-        while (start_from < world_size) {
-            int helper = (start_from == root) ? 0 : start_from;
+    int offset = 1;
 
-            HANDLE_REMOTE_FINISHED(MIMPI_Recv(data, count, helper, tag));
+    for (int i = 0; i < plan->children_count; i++) {
+        const int child_blocks = subtree_size(tree_rank(plan->children[i], root), comm->size);
 
-            start_from += power;
-            power *= 2;
-        }
-        
-        if (world_rank != root) {
-            if (receive_from == root) {
-                receive_from = 0;
-            } 
-            else if (receive_from == 0) {
-                receive_from = root;
-            }
+        HANDLE_REMOTE_FINISHED(group_recv(comm, buffer + (size_t)offset * count, child_blocks * count, plan->children[i], MIMPI_BROADCAST_TAG));
+        offset += child_blocks;
+    }
 
-            HANDLE_REMOTE_FINISHED(MIMPI_Send(data, count, receive_from, tag));
-        }
+    if (plan->parent >= 0) {
+        HANDLE_REMOTE_FINISHED(group_send(comm, buffer, blocks * count, plan->parent, MIMPI_BROADCAST_TAG));
     }
     else {
-        if (world_rank != root) {
-            if (receive_from == root) {
-                receive_from = 0;
-            } 
-            else if (receive_from == 0) {
-                receive_from = root;
-            }
+        int position = 0;
+        permute_blocks(buffer, recv_data, count, 0, root, comm->size, &position, true);
+    }
 
-            HANDLE_REMOTE_FINISHED(MIMPI_Recv(data, count, receive_from, tag));
-        }
+    flush_batches();
+
+    if (!synchronise) {
+        return MIMPI_SUCCESS;
+    }
 
-        while (start_from < world_size) {
-            int helper = (start_from == root) ? 0 : start_from;
+    return communication_loop(comm, NULL, MIMPI_DEFAULT_COUNT, root, MIMPI_NO_MESSAGE_TAG, false);
+}
 
-            HANDLE_REMOTE_FINISHED(MIMPI_Send(data, count, helper, tag));
 
-            start_from += power;
-            power *= 2;
-        }
+/// @brief Hands every process its block of the data of the root, among processes of a group.
+///
+/// @param comm - group the scatter runs in.
+/// @param send_data - blocks of all processes in the root.
+/// @param recv_data - place for the block of the process.
+/// @param count - number of bytes of a single block.
+/// @param root - rank of the process whose data are scattered.
+/// @param synchronise - flag whether the call has to be a synchronisation point.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode scatter(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root,
+    bool synchronise
+) {
+    CHECK_GROUP_RANK_ERROR(comm, root);
+
+    if (synchronise) {
+        HANDLE_REMOTE_FINISHED(communication_loop(comm, NULL, MIMPI_DEFAULT_COUNT, root, MIMPI_NO_MESSAGE_TAG, true));
+    }
+
+    const schedule* plan = &comm->schedules[root];
+    const int blocks = subtree_size(tree_rank(comm->rank, root), comm->size);
+
+    // Leaves receive their block right in place, others get their whole subtree in preorder.
+    if (blocks == 1 && plan->parent >= 0) {
+        return group_recv(comm, recv_data, count, plan->parent, MIMPI_BROADCAST_TAG);
+    }
+
+    char* buffer = reduce_staging((size_t)blocks * count);
+
+    if (plan->parent >= 0) {
+        HANDLE_REMOTE_FINISHED(group_recv(comm, buffer, blocks * count, plan->parent, MIMPI_BROADCAST_TAG));
+    }
+    else {
+        int position = 0;
+        permute_blocks(buffer, (char*)send_data, count, 0, root, comm->size, &position, false);
+    }
+
+    int offset = 1;
+
+    for (int i = 0; i < plan->children_count; i++) {
+        const int child_blocks = subtree_size(tree_rank(plan->children[i], root), comm->size);
+
+        HANDLE_REMOTE_FINISHED(group_send(comm, buffer + (size_t)offset * count, child_blocks * count, plan->children[i], MIMPI_BROADCAST_TAG));
+        offset += child_blocks;
     }
 
+    memcpy(recv_data, buffer, count);
+
+    flush_batches();
     return MIMPI_SUCCESS;
 }
 
 
-/// @brief Handles communication through a channel in a helper thread.
+MIMPI_Retcode MIMPI_Gather(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+) {
+    trace('B', "MIMPI_Gather", root, 0, count);
+    MIMPI_Retcode ret = gather(&MIMPI_world, send_data, recv_data, count, root, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Gather", root, 0, ret);
+
+    return ret;
+}
+
+
+MIMPI_Retcode MIMPI_Scatter(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+) {
+    trace('B', "MIMPI_Scatter", root, 0, count);
+    MIMPI_Retcode ret = scatter(&MIMPI_world, send_data, recv_data, count, root, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Scatter", root, 0, ret);
+
+    return ret;
+}
+
+
+/// @brief Collects a block from every process of a group in all of them.
 ///
-/// @param data - pointer to the data containing the sender's rank.
-static void* handle_channel(
-    void* data
+/// @param comm - group the allgather runs in.
+/// @param send_data - block of the process.
+/// @param recv_data - place for all blocks.
+/// @param count - number of bytes of a single block.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode allgather(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
+    int count
 ) {
-    const int sender = *((int*)data);
-    free(data);
-    
-    const int receiver = MIMPI_World_rank();
-    const int world_size = MIMPI_World_size();
-    const int fd_num = calculate_file_descriptor(world_size, receiver, sender);
-    int count, tag;
-
-    while(true) {                
-        Readcode* readcode = read_from_channel(fd_num, METADATA_SIZE);
-
-        if (readcode->error_occured) {
-            ASSERT_ZERO(pthread_mutex_lock(&MIMPI_mutex));
-            
-            MIMPI_already_left[sender] = true;
-            if (MIMPI_waiting->source == sender) {
-                ASSERT_ZERO(pthread_cond_signal(&MIMPI_cond));
-            }
+    // Every process waits for the result, which holds blocks of all of them, so neither pass needs to synchronise.
+    HANDLE_REMOTE_FINISHED(gather(comm, send_data, recv_data, count, 0, false));
 
-            if (readcode->data)
-                free(readcode->data);
-                
-            readcode->data = NULL;
-            free(readcode);
-            ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-            break;
-        }
-        else {
-            void* info = readcode->data;
-            memcpy(&count, info, sizeof(int));
-            memcpy(&tag, info + sizeof(int), sizeof(int));
-            free(info);
+    return broadcast(comm, recv_data, comm->size * count, 0, false);
+}
+
+
+/// @brief Sends a separate block from every process of a group to every process of it.
+///
+/// @param comm - group the exchange runs in.
+/// @param send_data - blocks for all processes.
+/// @param recv_data - place for the blocks from all processes.
+/// @param count - number of bytes of a single block.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode alltoall(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
+    int count
+) {
+    const int rank = comm->rank;
+    const int size = comm->size;
+    const int tag = group_tag(comm, MIMPI_BROADCAST_TAG);
+    const bool pairwise = get_power(size) == size;
+
+    memcpy((char*)recv_data + (size_t)rank * count, (char const*)send_data + (size_t)rank * count, count);
+
+    MIMPI_Request* requests = malloc(2 * (size - 1) * sizeof(MIMPI_Request));
+    ASSERT_MALLOC(requests);
+    MIMPI_Retcode started = MIMPI_SUCCESS;
 
-            readcode->data = NULL;
-            free(readcode);
+    // Receives are posted up front, so reader threads deliver blocks in place while this process still sends.
+    for (int round = 1; round < size; round++) {
+        const int source = pairwise ? rank ^ round : (rank - round + size) % size;
+
+        const MIMPI_Retcode ret = MIMPI_Irecv((char*)recv_data + (size_t)source * count, count, comm->ranks[source], tag, &requests[round - 1]);
+        if (ret != MIMPI_SUCCESS)
+            started = ret;
+    }
+
+    for (int round = 1; round < size; round++) {
+        const int destination = pairwise ? rank ^ round : (rank + round) % size;
+
+        const MIMPI_Retcode ret = MIMPI_Isend((char const*)send_data + (size_t)destination * count, count, comm->ranks[destination], tag, &requests[size + round - 2]);
+        if (ret != MIMPI_SUCCESS)
+            started = ret;
+    }
+
+    // Requests which have been started are completed even if others have failed, a failed one is null.
+    flush_batches();
+    MIMPI_Retcode ret = MIMPI_Waitall(2 * (size - 1), requests);
+    free(requests);
+
+    return started != MIMPI_SUCCESS ? started : ret;
+}
+
+
+/// @brief Computes prefix reductions of typed data over the ranks of a group.
+///
+/// Runs the Hillis-Steele scan: in round k every process sends its partial result
+/// to the process 2^k ranks ahead and folds in the one of the process 2^k ranks behind,
+/// so ceil(log2 n) rounds cover all lower ranks. The exclusive scan first shifts data
+/// one rank ahead and then scans them among ranks above 0.
+///
+/// @param comm - group the scan runs in.
+/// @param send_data - data to be reduced.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param exclusive - flag whether the data of the process itself are left out of its result.
+///
+/// @return MIMPI_Retcode:
+///     - MIMPI_SUCCESS on successful completion, an error code otherwise.
+static MIMPI_Retcode scan(
+    const communicator* comm,
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    bool exclusive
+) {
+    const int bytes = count * MIMPI_DATATYPE_SIZES[datatype];
+    const int tag = reduce_tag(datatype, op);
+    int rank = comm->rank;
+    int size = comm->size;
+
+    if (send_data == MIMPI_IN_PLACE)
+        send_data = recv_data;
+
+    if (exclusive) {
+        if (rank + 1 < size) {
+            HANDLE_REMOTE_FINISHED(group_send(comm, send_data, bytes, rank + 1, MIMPI_BROADCAST_TAG));
+        }
+        if (rank == 0) {
+            flush_batches();
+            return MIMPI_SUCCESS;
         }
 
-        void* message_data = NULL;
-        
-        if (tag != MIMPI_NO_MESSAGE_TAG && tag != MIMPI_DEADLOCK_TAG) {
-            readcode = read_from_channel(fd_num, count);
-            message_data = readcode->data;
+        // The result of process 0 stays undefined, the others scan what came from their predecessors.
+        HANDLE_REMOTE_FINISHED(group_recv(comm, recv_data, bytes, rank - 1, MIMPI_BROADCAST_TAG));
+        rank--;
+        size--;
+    }
+    else if (recv_data != send_data) {
+        memcpy(recv_data, send_data, bytes);
+    }
 
-            readcode->data = NULL;
-            free(readcode);
+    const int shift = exclusive ? 1 : 0;
+
+    // Sends return once the data are on their way, so the partial result can be folded into right after.
+    for (int distance = 1; distance < size; distance *= 2) {
+        if (rank + distance < size) {
+            HANDLE_REMOTE_FINISHED(group_send(comm, recv_data, bytes, rank + distance + shift, tag));
         }
-        
-        bool waiting_tag = false, receive_tag = false;
+        if (rank >= distance) {
+            HANDLE_REMOTE_FINISHED(group_recv(comm, recv_data, bytes, rank - distance + shift, tag));
+        }
+    }
+
+    flush_batches();
+    return MIMPI_SUCCESS;
+}
 
-        if (tag == MIMPI_WAITING_TAG || tag == MIMPI_RECEIVED_TAG) {
-            if (tag == MIMPI_WAITING_TAG) {
-                waiting_tag = true;
-            }
-            else if (tag == MIMPI_RECEIVED_TAG) {
-                receive_tag = true;
-            }
 
-            memcpy(&count, message_data, sizeof(int));
-            memcpy(&tag, message_data + sizeof(int), sizeof(int));
-        }
+MIMPI_Retcode MIMPI_Scan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+) {
+    trace('B', "MIMPI_Scan", -1, 0, count);
+    MIMPI_Retcode ret = scan(&MIMPI_world, send_data, recv_data, count, datatype, op, false);
+    trace('E', "MIMPI_Scan", -1, 0, ret);
 
-        Message *message = create_message(tag, count, sender, message_data);
-        elem *el = create_elem(NULL, NULL, message);
+    return ret;
+}
 
-        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_mutex));
-        
-        if (tag == MIMPI_DEADLOCK_TAG) {
-            MIMPI_waiting->tag = MIMPI_DEADLOCK_TAG;
-            MIMPI_waiting->received = true;
-            
-            push_front(MIMPI_others_recv[sender], el);
 
-            ASSERT_ZERO(pthread_cond_signal(&MIMPI_cond));
-        }
-        else if (waiting_tag) {
-            elem* elem_found = find_elem_in_list(MIMPI_send_not_received, message);
+MIMPI_Retcode MIMPI_Exscan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+) {
+    trace('B', "MIMPI_Exscan", -1, 0, count);
+    MIMPI_Retcode ret = scan(&MIMPI_world, send_data, recv_data, count, datatype, op, true);
+    trace('E', "MIMPI_Exscan", -1, 0, ret);
 
-            if (elem_found == MIMPI_send_not_received->head) {
-                push_front(MIMPI_others_recv[sender], el);
+    return ret;
+}
 
-                if (MIMPI_waiting->source == sender && MIMPI_waiting->received == false) {
-                    MIMPI_waiting->received = true;
-                    MIMPI_waiting->tag = MIMPI_DEADLOCK_TAG;
 
-                    ASSERT_ZERO(pthread_cond_signal(&MIMPI_cond));
-                }
-            }
-            else {
-                delete_elem(el);
-            }
-        }
-        else if (receive_tag) {
-            remove_from_list(find_elem_in_list(MIMPI_send_not_received, message));
-            delete_elem(el);
-        }
-        else {
-            push_front(MIMPI_received_messages[sender], el);
+MIMPI_Retcode MIMPI_Allgather(
+    void const *send_data,
+    void *recv_data,
+    int count
+) {
+    trace('B', "MIMPI_Allgather", -1, 0, count);
+    MIMPI_Retcode ret = allgather(&MIMPI_world, send_data, recv_data, count);
+    trace('E', "MIMPI_Allgather", -1, 0, ret);
 
-            if (compare_message(message, MIMPI_waiting)) {
-                *MIMPI_waiting = *message;
-                MIMPI_waiting->received = true;
+    return ret;
+}
 
-                ASSERT_ZERO(pthread_cond_signal(&MIMPI_cond));
-            }
-        }
 
-        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-    }
+MIMPI_Retcode MIMPI_Alltoall(
+    void const *send_data,
+    void *recv_data,
+    int count
+) {
+    trace('B', "MIMPI_Alltoall", -1, 0, count);
+    MIMPI_Retcode ret = alltoall(&MIMPI_world, send_data, recv_data, count);
+    trace('E', "MIMPI_Alltoall", -1, 0, ret);
 
-    ASSERT_SYS_OK(close(fd_num));
-    return NULL;
-}   
+    return ret;
+}
 
 
-void MIMPI_Init(
-    bool enable_deadlock_detection
+MIMPI_Retcode MIMPI_Comm_split(
+    MIMPI_Comm comm,
+    int color,
+    int key,
+    MIMPI_Comm *newcomm
 ) {
-    channels_init();
+    trace('B', "MIMPI_Comm_split", -1, 0, color);
+    *newcomm = MIMPI_COMM_NULL;
+
+    // Identifiers of all groups a process has been in are below its next one, so the greatest
+    // among the processes splitting the group is new to every pair of processes in the new group.
+    int mine[3] = {color, key, MIMPI_next_group_id};
+    int* all = (int*)malloc(comm->size * sizeof(mine));
+    ASSERT_MALLOC(all);
+
+    MIMPI_Retcode ret = allgather(comm, mine, all, sizeof(mine));
+    if (ret != MIMPI_SUCCESS) {
+        free(all);
+        trace('E', "MIMPI_Comm_split", -1, 0, ret);
+        return ret;
+    }
 
-    MIMPI_deadlock_enabled = enable_deadlock_detection;
+    communicator* group = (communicator*)malloc(sizeof(communicator));
+    ASSERT_MALLOC(group);
+    *group = (communicator) {.id = 0, .rank = 0, .size = 0};
 
-    const int world_size = MIMPI_World_size();
-    const int world_rank = MIMPI_World_rank();
+    group->ranks = (int*)malloc(comm->size * sizeof(int));
+    ASSERT_MALLOC(group->ranks);
 
-    MIMPI_waiting = (Message*)malloc(sizeof(Message));
-    ASSERT_MALLOC(MIMPI_waiting);
-    *MIMPI_waiting = MIMPI_DEFAULT_MSG;
+    for (int i = 0; i < comm->size; i++) {
+        group->id = MAX(group->id, all[3 * i + 2]);
 
-    if (enable_deadlock_detection) {
-        for (int i = 0; i < world_size; i++) {
-            if (i == world_rank) continue;
+        if (all[3 * i] != color) continue;
 
-            MIMPI_others_recv[i] = create_list();
+        // Processes are ordered by key, ties are broken by their ranks in the split group.
+        int j = group->size++;
+        while (j > 0 && all[3 * group->ranks[j - 1] + 1] > all[3 * i + 1]) {
+            group->ranks[j] = group->ranks[j - 1];
+            j--;
         }
-
-        MIMPI_send_not_received = create_list();
+        group->ranks[j] = i;
     }
 
-    for (int i = 0; i < world_size; i++) {
-        if (i == world_rank) continue;
+    MIMPI_next_group_id = group->id + 1;
 
-        MIMPI_received_messages[i] = create_list();       
+    for (int i = 0; i < group->size; i++) {
+        if (group->ranks[i] == comm->rank) {
+            group->rank = i;
+        }
+        group->ranks[i] = comm->ranks[group->ranks[i]];
     }
 
-    pthread_attr_t attr;
-    ASSERT_ZERO(pthread_attr_init(&attr));
-    ASSERT_ZERO(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE));
+    plan_group(group);
+    free(all);
 
-    ASSERT_ZERO(pthread_mutex_init(&MIMPI_mutex, NULL));
-    ASSERT_ZERO(pthread_cond_init(&MIMPI_cond, NULL));
+    *newcomm = group;
+    trace('E', "MIMPI_Comm_split", -1, 0, ret);
+
+    return ret;
+}
 
-    for (int worker = 0; worker < world_size; worker++) {
-        if (worker == world_rank) {
-            continue;
-        }
 
-        int* worker_id = malloc(sizeof(int));
-        ASSERT_MALLOC(worker_id);
+MIMPI_Retcode MIMPI_Comm_free(
+    MIMPI_Comm *comm
+) {
+    communicator* group = *comm;
 
-        *worker_id = worker;
-        ASSERT_ZERO(pthread_create(&MIMPI_threads[worker], &attr, handle_channel, worker_id));
+    if (group != MIMPI_COMM_NULL && group != MIMPI_COMM_WORLD) {
+        free(group->schedules);
+        free(group->node_schedules);
+        free(group->ranks);
+        free(group);
     }
 
-    ASSERT_ZERO(pthread_attr_destroy(&attr));
+    *comm = MIMPI_COMM_NULL;
+    return MIMPI_SUCCESS;
 }
 
 
-void MIMPI_Finalize() {
-    const int world_size = MIMPI_World_size();
-    const int world_rank = MIMPI_World_rank();
+int MIMPI_Comm_rank(
+    MIMPI_Comm comm
+) {
+    return comm->rank;
+}
 
-    for (int i = 0; i < world_size; i++) {
-        if (i == world_rank) continue;
 
-        int fd_num = calculate_file_descriptor(world_size, i, world_rank) + 1;
-        ASSERT_SYS_OK(close(fd_num));
-    }
-    
-    for (int worker = 0; worker < world_size; worker++) {
-        if (worker == world_rank) continue;
+int MIMPI_Comm_size(
+    MIMPI_Comm comm
+) {
+    return comm->size;
+}
 
-        ASSERT_ZERO(pthread_join(MIMPI_threads[worker], NULL));
-    }
 
-    channels_finalize();
+MIMPI_Retcode MIMPI_Barrier_comm(
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Barrier_comm", -1, 0, 0);
+    MIMPI_Retcode ret = barrier(comm);
+    trace('E', "MIMPI_Barrier_comm", -1, 0, ret);
 
-    delete_message(MIMPI_waiting);
+    return ret;
+}
 
-    for (int i = 0; i < world_size; i++) {
-        if (i == world_rank) continue;
 
-        delete_list(MIMPI_received_messages[i]);
-    }
+MIMPI_Retcode MIMPI_Bcast_comm(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Bcast_comm", root, 0, count);
+    MIMPI_Retcode ret = broadcast(comm, data, count, root, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Bcast_comm", root, 0, ret);
 
-    if (MIMPI_deadlock_enabled) {
-        delete_list(MIMPI_send_not_received);
+    return ret;
+}
 
-        for (int i = 0; i < world_size; i++) {
-            if (i == world_rank) continue;
 
-            delete_list(MIMPI_others_recv[i]);
-        }
-    }
+MIMPI_Retcode MIMPI_Reduce_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Reduce_comm", root, 0, count);
+    MIMPI_Retcode ret = reduce(comm, send_data, recv_data, count, datatype, op, root, NULL, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Reduce_comm", root, 0, ret);
 
-    ASSERT_ZERO(pthread_cond_destroy(&MIMPI_cond));
-    ASSERT_ZERO(pthread_mutex_destroy(&MIMPI_mutex));
+    return ret;
 }
 
 
-int MIMPI_World_size() {
-    return atoi(getenv("MIMPI_SIZE"));
+MIMPI_Retcode MIMPI_Allreduce_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Allreduce_comm", -1, 0, count);
+    MIMPI_Retcode ret = allreduce(comm, send_data, recv_data, count, datatype, op);
+    trace('E', "MIMPI_Allreduce_comm", -1, 0, ret);
+
+    return ret;
 }
 
 
-int MIMPI_World_rank() {
-    const pid_t pid = getpid();
-    char pid_rank[40];
-    ASSERT_SPRINTF(sprintf(pid_rank, "MIMPI_PID_RANK %d", pid));
+MIMPI_Retcode MIMPI_Gather_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Gather_comm", root, 0, count);
+    MIMPI_Retcode ret = gather(comm, send_data, recv_data, count, root, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Gather_comm", root, 0, ret);
 
-    return atoi(getenv(pid_rank));
+    return ret;
 }
 
 
-MIMPI_Retcode MIMPI_Send(
-    void const *data,
+MIMPI_Retcode MIMPI_Scatter_comm(
+    void const *send_data,
+    void *recv_data,
     int count,
-    int destination,
-    int tag
+    int root,
+    MIMPI_Comm comm
 ) {
-    CHECK_RANK_ERROR(destination);
-    CHECK_SELF_OP_ERROR(destination);
-    
-    const int world_size = MIMPI_World_size();
-    const int sender = MIMPI_World_rank();
-    const int fd_num = calculate_file_descriptor(world_size, destination, sender) + 1;
+    trace('B', "MIMPI_Scatter_comm", root, 0, count);
+    MIMPI_Retcode ret = scatter(comm, send_data, recv_data, count, root, !MIMPI_relaxed_collectives);
+    trace('E', "MIMPI_Scatter_comm", root, 0, ret);
 
-    if (MIMPI_deadlock_enabled && tag >= MIMPI_ANY_TAG) {
-        ASSERT_ZERO(pthread_mutex_lock(&MIMPI_mutex));
+    return ret;
+}
 
-        Message* msg = MIMPI_others_recv[destination]->tail->next->message;
 
-        if (msg != NULL && msg->count == count && msg->tag == tag) {
-            remove_from_list(MIMPI_others_recv[destination]->tail->next);
-        }
+MIMPI_Retcode MIMPI_Allgather_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Allgather_comm", -1, 0, count);
+    MIMPI_Retcode ret = allgather(comm, send_data, recv_data, count);
+    trace('E', "MIMPI_Allgather_comm", -1, 0, ret);
+
+    return ret;
+}
 
-        Message* message = create_message(tag, count, destination, NULL);
-        elem* el = create_elem(NULL, NULL, message);
-        push_front(MIMPI_send_not_received, el);
 
-        ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-    }
+MIMPI_Retcode MIMPI_Alltoall_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Alltoall_comm", -1, 0, count);
+    MIMPI_Retcode ret = alltoall(comm, send_data, recv_data, count);
+    trace('E', "MIMPI_Alltoall_comm", -1, 0, ret);
 
-    void* to_send = NULL;
-    size_t bytes_to_send;
+    return ret;
+}
 
-    if (tag != MIMPI_NO_MESSAGE_TAG && tag != MIMPI_DEADLOCK_TAG) {
-        to_send = (void*)malloc(sizeof(void) * ((size_t)count + METADATA_SIZE));
-        ASSERT_MALLOC(to_send);
 
-        memcpy(to_send, &count, sizeof(int));
-        memcpy(to_send + sizeof(int), &tag, sizeof(int));
-        memcpy(to_send + METADATA_SIZE, data, count);
-        bytes_to_send = (size_t)count + METADATA_SIZE;
-    }
-    else {
-        to_send = (void*)malloc(sizeof(void) * METADATA_SIZE);
-        ASSERT_MALLOC(to_send);
+MIMPI_Retcode MIMPI_Scan_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Scan_comm", -1, 0, count);
+    MIMPI_Retcode ret = scan(comm, send_data, recv_data, count, datatype, op, false);
+    trace('E', "MIMPI_Scan_comm", -1, 0, ret);
 
-        memcpy(to_send, &count, sizeof(int));
-        memcpy(to_send + sizeof(int), &tag, sizeof(int));
-        bytes_to_send = METADATA_SIZE;
-    }
+    return ret;
+}
 
-    if (!write_to_channel(fd_num, bytes_to_send, to_send)) {
-        free(to_send);
 
-        return MIMPI_ERROR_REMOTE_FINISHED;
-    }
+MIMPI_Retcode MIMPI_Exscan_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    MIMPI_Comm comm
+) {
+    trace('B', "MIMPI_Exscan_comm", -1, 0, count);
+    MIMPI_Retcode ret = scan(comm, send_data, recv_data, count, datatype, op, true);
+    trace('E', "MIMPI_Exscan_comm", -1, 0, ret);
+
+    return ret;
+}
 
-    free(to_send);
 
-    return MIMPI_SUCCESS;
+/// @brief Creates a persistent request for a planned collective.
+///
+/// @param planned - pointer to the collective, owned by the request from now on.
+/// @param request_ptr - place for the handle of the request.
+static void create_persistent_request(
+    persistent* planned,
+    MIMPI_Request* request_ptr
+) {
+    request* req = (request*)malloc(sizeof(request));
+    ASSERT_MALLOC(req);
+
+    *req = (request) {.found = NULL, .ticket = NO_TICKET, .result = MIMPI_SUCCESS, .planned = planned};
+    *request_ptr = req;
 }
 
 
-MIMPI_Retcode MIMPI_Recv(
+MIMPI_Retcode MIMPI_Bcast_init(
     void *data,
     int count,
-    int source,
-    int tag
+    int root,
+    MIMPI_Request *request_ptr
 ) {
-    CHECK_RANK_ERROR(source);
-    CHECK_SELF_OP_ERROR(source);
+    CHECK_RANK_ERROR(root);
 
-    ASSERT_ZERO(pthread_mutex_lock(&MIMPI_mutex));
+    persistent* planned = (persistent*)malloc(sizeof(persistent));
+    ASSERT_MALLOC(planned);
 
-    Message* to_compare = create_message(tag, count, source, data);
-    elem* elem_found = find_elem_in_list(MIMPI_received_messages[source], to_compare);
-    free(to_compare);
+    *planned = (persistent) {.data = data, .count = count, .root = root, .is_reduce = false};
+    create_persistent_request(planned, request_ptr);
 
-    void* to_receive = NULL;
+    return MIMPI_SUCCESS;
+}
 
-    if (elem_found->message == NULL || elem_found == MIMPI_received_messages[source]->head) {
-        *MIMPI_waiting = (Message) {
-            .tag = tag, .count = count, .source = source, .data = NULL, .received = false
-        };
 
-        if (MIMPI_deadlock_enabled && tag >= MIMPI_ANY_TAG) {
-            elem* first_on_list = MIMPI_others_recv[source]->tail->next;
-            Message* msg = first_on_list->message;
+MIMPI_Retcode MIMPI_Reduce_init(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Request *request_ptr
+) {
+    CHECK_RANK_ERROR(root);
 
-            if (msg != NULL && msg->tag >= MIMPI_ANY_TAG) {
-                *MIMPI_waiting = MIMPI_DEFAULT_MSG;
-                remove_from_list(first_on_list);
+    persistent* planned = (persistent*)malloc(sizeof(persistent));
+    ASSERT_MALLOC(planned);
 
-                MIMPI_Send(NULL, MIMPI_DEFAULT_COUNT, source, MIMPI_DEADLOCK_TAG);
+    planned->staging = malloc(MAX(count * MIMPI_DATATYPE_SIZES[datatype], 1));
+    ASSERT_MALLOC(planned->staging);
 
-                ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-                return MIMPI_ERROR_DEADLOCK_DETECTED;   
-            }
+    planned->data = recv_data;
+    planned->send_data = send_data;
+    planned->count = count;
+    planned->root = root;
+    planned->is_reduce = true;
+    planned->datatype = datatype;
+    planned->op = op;
+    create_persistent_request(planned, request_ptr);
 
-            void* info = (void*)malloc(sizeof(void) * METADATA_SIZE);
-            ASSERT_MALLOC(info);
+    return MIMPI_SUCCESS;
+}
 
-            memcpy(info, &count, sizeof(int));
-            memcpy(info + sizeof(int), &tag, sizeof(int));
-                    
-            if (MIMPI_Send(info, METADATA_SIZE, source, MIMPI_WAITING_TAG) == MIMPI_ERROR_REMOTE_FINISHED) {
-                free(info);
-                *MIMPI_waiting = MIMPI_DEFAULT_MSG;
-                remove_from_list(MIMPI_others_recv[source]->tail->next);
 
-                ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-                return MIMPI_ERROR_REMOTE_FINISHED;
-            }
+MIMPI_Retcode MIMPI_Start(
+    MIMPI_Request *request_ptr
+) {
+    request* req = *request_ptr;
+    persistent* planned = req->planned;
 
-            free(info);
-        }
-        
-        while (!MIMPI_waiting->received && !MIMPI_already_left[source]) {
-            ASSERT_ZERO(pthread_cond_wait(&MIMPI_cond, &MIMPI_mutex));
-        }
+    trace('B', "MIMPI_Start", planned->root, 0, planned->count);
 
-        if (MIMPI_waiting->tag == MIMPI_DEADLOCK_TAG) {
-            *MIMPI_waiting = MIMPI_DEFAULT_MSG;
-            remove_from_list(MIMPI_others_recv[source]->tail->next);
+    if (planned->is_reduce) {
+        req->result = reduce(
+            &MIMPI_world, planned->send_data, planned->data, planned->count, planned->datatype, planned->op,
+            planned->root, planned->staging, !MIMPI_relaxed_collectives
+        );
+    }
+    else {
+        req->result = broadcast(&MIMPI_world, planned->data, planned->count, planned->root, !MIMPI_relaxed_collectives);
+    }
 
-            ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-            return MIMPI_ERROR_DEADLOCK_DETECTED;
-        }
+    trace('E', "MIMPI_Start", planned->root, 0, req->result);
 
-        if (MIMPI_already_left[source] && !MIMPI_waiting->received) {
-            *MIMPI_waiting = MIMPI_DEFAULT_MSG;
-            ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
-            return MIMPI_ERROR_REMOTE_FINISHED;
-        }
+    return req->result;
+}
 
-        to_compare = create_message(tag, count, source, data);
-        elem* elem_received = find_elem_in_list(MIMPI_received_messages[source], to_compare);
-        
-        if (tag != MIMPI_NO_MESSAGE_TAG) {
-            to_receive = (void*)malloc(sizeof(void) * count);
-            ASSERT_MALLOC(to_receive);
 
-            memcpy(to_receive, elem_received->message->data, count);
-        }
+MIMPI_Retcode MIMPI_Request_free(
+    MIMPI_Request *request_ptr
+) {
+    request* req = *request_ptr;
 
-        remove_from_list(elem_received);        
-        free(to_compare);
+    if (req == MIMPI_REQUEST_NULL || req->planned == NULL)
+        return MIMPI_Wait(request_ptr);
 
-        *MIMPI_waiting = MIMPI_DEFAULT_MSG;
-    }
-    else {
-        if (tag != MIMPI_NO_MESSAGE_TAG && tag != MIMPI_DEADLOCK_TAG) {
-            to_receive = (void*)malloc(sizeof(void) * count);
-            ASSERT_MALLOC(to_receive);
+    if (req->planned->is_reduce)
+        free(req->planned->staging);
+    free(req->planned);
+    free(req);
 
-            memcpy(to_receive, elem_found->message->data, count);
-        }
+    *request_ptr = MIMPI_REQUEST_NULL;
+    return MIMPI_SUCCESS;
+}
 
-        remove_from_list(elem_found);
-    }   
 
-    if (MIMPI_deadlock_enabled && tag >= MIMPI_ANY_TAG) {
-        void* info = (void*)malloc(sizeof(void) * METADATA_SIZE);
-        ASSERT_MALLOC(info);
+/// @brief Maps the shared memory object backing a window.
+///
+/// @param name - name of the object.
+/// @param size - size of the object.
+/// @param create - flag whether the object is to be created, rather than opened.
+///
+/// @return char*:
+///     - pointer to the mapping.
+static char* map_window(
+    const char* name,
+    size_t size,
+    bool create
+) {
+    const int memory_fd = shm_open(name, create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, S_IRUSR | S_IWUSR);
+    ASSERT_SYS_OK(memory_fd);
+    if (create) {
+        ASSERT_SYS_OK(ftruncate(memory_fd, (off_t)size));
+    }
+
+    char* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    if (memory == MAP_FAILED) {
+        syserr("mmap of window %s failed", name);
+    }
+    ASSERT_SYS_OK(close(memory_fd));
+
+    return memory;
+}
 
-        memcpy(info, &count, sizeof(int));
-        memcpy(info + sizeof(int), &tag, sizeof(int));
 
-        MIMPI_Send(info, METADATA_SIZE, source, MIMPI_RECEIVED_TAG);
-        free(info);
+MIMPI_Retcode MIMPI_Win_create(
+    int size,
+    MIMPI_Comm comm,
+    void **base,
+    MIMPI_Win *win
+) {
+    trace('B', "MIMPI_Win_create", -1, 0, size);
+
+    window* w = malloc(sizeof(window));
+    ASSERT_MALLOC(w);
+    w->comm = comm;
+    w->memory = NULL;
+    w->sizes = malloc(comm->size * sizeof(size_t));
+    ASSERT_MALLOC(w->sizes);
+    w->offsets = malloc(comm->size * sizeof(size_t));
+    ASSERT_MALLOC(w->offsets);
+
+    const size_t own_size = size;
+    MIMPI_Retcode ret = allgather(comm, &own_size, w->sizes, sizeof(size_t));
+
+    // Every process maps all segments, placed one after another behind their locks.
+    size_t offset = (size_t)comm->size * sizeof(window_lock);
+    for (int i = 0; i < comm->size; i++) {
+        w->offsets[i] = offset;
+        offset += (w->sizes[i] + WINDOW_ALIGNMENT - 1) / WINDOW_ALIGNMENT * WINDOW_ALIGNMENT;
+    }
+    w->memory_size = offset;
+
+    // The first process creates the object and initialises the locks before anyone else opens it.
+    char name[WINDOW_NAME_LENGTH] = {0};
+    if (ret == MIMPI_SUCCESS && comm->rank == 0) {
+        ASSERT_SPRINTF(snprintf(name, sizeof(name), "/mimpi-win-%d-%d", getpid(), MIMPI_next_window_id++));
+        w->memory = map_window(name, w->memory_size, true);
+
+        pthread_mutexattr_t attr;
+        ASSERT_ZERO(pthread_mutexattr_init(&attr));
+        ASSERT_ZERO(pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+        for (int i = 0; i < comm->size; i++) {
+            ASSERT_ZERO(pthread_mutex_init(&((window_lock*)w->memory)[i].mutex, &attr));
+        }
+        ASSERT_ZERO(pthread_mutexattr_destroy(&attr));
     }
 
-    ASSERT_ZERO(pthread_mutex_unlock(&MIMPI_mutex));
+    if (ret == MIMPI_SUCCESS) {
+        ret = broadcast(comm, name, sizeof(name), 0, false);
+    }
+    if (ret == MIMPI_SUCCESS && comm->rank != 0) {
+        w->memory = map_window(name, w->memory_size, false);
+    }
 
-    if (tag <= MIMPI_MAX_TAG) {
-        handle_reduce_operation(to_receive, count, tag, data);
+    // The name is no longer needed once every process has mapped the object.
+    if (ret == MIMPI_SUCCESS) {
+        ret = barrier(comm);
     }
-    else if (tag != MIMPI_NO_MESSAGE_TAG) {
-        memcpy(data, to_receive, count);
+    if (comm->rank == 0 && w->memory != NULL) {
+        ASSERT_SYS_OK(shm_unlink(name));
     }
 
-    if (to_receive)
-        free(to_receive);
+    if (ret != MIMPI_SUCCESS) {
+        if (w->memory != NULL) {
+            ASSERT_SYS_OK(munmap(w->memory, w->memory_size));
+        }
+        free(w->offsets);
+        free(w->sizes);
+        free(w);
+
+        trace('E', "MIMPI_Win_create", -1, 0, ret);
+        return ret;
+    }
+
+    *base = w->memory + w->offsets[comm->rank];
+    *win = w;
 
+    trace('E', "MIMPI_Win_create", -1, 0, ret);
     return MIMPI_SUCCESS;
 }
 
 
-MIMPI_Retcode MIMPI_Barrier() {
-    const int world_rank = MIMPI_World_rank();
-    const int world_size = MIMPI_World_size(); 
-
-    HANDLE_REMOTE_FINISHED(communication_loop(NULL, MIMPI_DEFAULT_COUNT, 0, MIMPI_NO_MESSAGE_TAG, world_rank, world_size, true));
+/// @brief Finds the place of data in a segment of a window.
+///
+/// @param w - the window.
+/// @param target - rank of the owner of the segment in the group of the window.
+/// @param displacement - offset of the data in the segment, in bytes.
+/// @param count - number of bytes of the data.
+///
+/// @return char*:
+///     - pointer to the data, or NULL if there is no process with the rank.
+static char* window_place(
+    const window* w,
+    int target,
+    int displacement,
+    size_t count
+) {
+    if (target < 0 || target >= w->comm->size) {
+        return NULL;
+    }
+    if (displacement < 0 || (size_t)displacement + count > w->sizes[target]) {
+        fatal("access to bytes %d..%zu of a window segment of %zu bytes", displacement, displacement + count, w->sizes[target]);
+    }
 
-    return communication_loop(NULL, MIMPI_DEFAULT_COUNT, 0, MIMPI_NO_MESSAGE_TAG, world_rank, world_size, false);
+    return w->memory + w->offsets[target] + displacement;
 }
 
 
-MIMPI_Retcode MIMPI_Bcast(
-    void *data,
+MIMPI_Retcode MIMPI_Put(
+    void const *origin,
     int count,
-    int root
+    int target,
+    int displacement,
+    MIMPI_Win win
 ) {
-    CHECK_RANK_ERROR(root);
+    char* place = window_place(win, target, displacement, count);
+    if (place == NULL) {
+        return MIMPI_ERROR_NO_SUCH_RANK;
+    }
+
+    memcpy(place, origin, count);
+    return MIMPI_SUCCESS;
+}
 
-    const int world_rank = MIMPI_World_rank();
-    const int world_size = MIMPI_World_size();  
 
-    HANDLE_REMOTE_FINISHED(communication_loop(NULL, MIMPI_DEFAULT_COUNT, root, MIMPI_NO_MESSAGE_TAG, world_rank, world_size, true));
+MIMPI_Retcode MIMPI_Get(
+    void *origin,
+    int count,
+    int target,
+    int displacement,
+    MIMPI_Win win
+) {
+    char const* place = window_place(win, target, displacement, count);
+    if (place == NULL) {
+        return MIMPI_ERROR_NO_SUCH_RANK;
+    }
 
-    return communication_loop(data, count, root, MIMPI_BROADCAST_TAG, world_rank, world_size, false);
+    memcpy(origin, place, count);
+    return MIMPI_SUCCESS;
 }
 
 
-MIMPI_Retcode MIMPI_Reduce(
-    void const *send_data,
-    void *recv_data,
+MIMPI_Retcode MIMPI_Accumulate(
+    void const *origin,
     int count,
+    MIMPI_Datatype datatype,
     MIMPI_Op op,
-    int root
+    int target,
+    int displacement,
+    MIMPI_Win win
 ) {
-    CHECK_RANK_ERROR(root);
+    char* place = window_place(win, target, displacement, (size_t)count * MIMPI_DATATYPE_SIZES[datatype]);
+    if (place == NULL) {
+        return MIMPI_ERROR_NO_SUCH_RANK;
+    }
 
-    const int world_rank = MIMPI_World_rank();
-    const int world_size = MIMPI_World_size();
+    // Accumulates into a segment exclude each other, so that no update of an element is lost.
+    pthread_mutex_t* mutex = &((window_lock*)win->memory)[target].mutex;
+    ASSERT_ZERO(pthread_mutex_lock(mutex));
+    MIMPI_REDUCE_KERNELS[datatype][op](place, origin, count);
+    ASSERT_ZERO(pthread_mutex_unlock(mutex));
 
-    void* memory = (void*)malloc(sizeof(void) * count);
-    ASSERT_MALLOC(memory);
+    return MIMPI_SUCCESS;
+}
 
-    memcpy(memory, send_data, count);
 
-    if (communication_loop(memory, count, root, MIMPI_MAX_TAG - op, world_rank, world_size, true) == MIMPI_ERROR_REMOTE_FINISHED) {
-        free(memory);
-        return MIMPI_ERROR_REMOTE_FINISHED;
-    }
+MIMPI_Retcode MIMPI_Win_fence(
+    MIMPI_Win win
+) {
+    trace('B', "MIMPI_Win_fence", -1, 0, 0);
+
+    // Writes to the window of this process become visible before others leave the barrier.
+    atomic_thread_fence(memory_order_seq_cst);
+    MIMPI_Retcode ret = barrier(win->comm);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    trace('E', "MIMPI_Win_fence", -1, 0, ret);
+    return ret;
+}
 
-    if (world_rank == root) {
-        memcpy(recv_data, memory, count);
-    }
 
-    free(memory);
+MIMPI_Retcode MIMPI_Win_free(
+    MIMPI_Win *win_ptr
+) {
+    window* w = *win_ptr;
+
+    ASSERT_SYS_OK(munmap(w->memory, w->memory_size));
+    free(w->offsets);
+    free(w->sizes);
+    free(w);
 
-    return communication_loop(NULL, MIMPI_DEFAULT_COUNT, root, MIMPI_NO_MESSAGE_TAG, world_rank, world_size, false);
-}
\ No newline at end of file
+    *win_ptr = MIMPI_WIN_NULL;
+    return MIMPI_SUCCESS;
+}
@@ -2,9 +2,17 @@
 #define MIMPI_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define MIMPI_ANY_TAG 0
 
+/// Source of a receive matching messages from any process.
+#define MIMPI_ANY_SOURCE (-2)
+
+/// Data of a reduction which a process holds in its place for the result,
+/// passed in place of the data to be reduced.
+#define MIMPI_IN_PLACE ((void const *)-1)
+
 /// Return code of MIMPI operations.
 typedef enum {
     MIMPI_SUCCESS = 0, /// operation ended successfully
@@ -22,8 +30,52 @@ typedef enum {
     MIMPI_MIN,
     MIMPI_SUM,
     MIMPI_PROD,
+    MIMPI_OPS, /// number of operations, not an operation itself
 } MIMPI_Op;
 
+/// @brief Type of reduced elements.
+///
+/// Type of elements combined in @ref MIMPI_Reduce_typed().
+typedef enum {
+    MIMPI_UINT8, /// `uint8_t`, as in @ref MIMPI_Reduce()
+    MIMPI_INT32, /// `int32_t`
+    MIMPI_INT64, /// `int64_t`
+    MIMPI_FLOAT, /// `float`
+    MIMPI_DOUBLE, /// `double`
+    MIMPI_DATATYPES, /// number of datatypes, not a datatype itself
+} MIMPI_Datatype;
+
+/// @brief Communication with one process, counted since @ref MIMPI_Init().
+///
+/// Messages are frames written to or read from the channel, internal frames
+/// of group functions and deadlock detection included. Compressed payloads
+/// (see `MIMPI_COMPRESS_THRESHOLD`) count with their compressed size.
+/// Capacities of pipes are reported even if counters are compiled out.
+typedef struct {
+    uint64_t messages_sent; /// frames written to the process
+    uint64_t bytes_sent; /// bytes of data in frames written to the process
+    uint64_t messages_received; /// frames read from the process
+    uint64_t bytes_received; /// bytes of data in frames read from the process
+    uint64_t unexpected_high_water; /// most messages from the process ever waiting for a receive
+    uint64_t send_pipe_size; /// capacity in bytes of the pipe to the process (see `mimpirun --pipe-size`), 0 for a TCP channel
+    uint64_t recv_pipe_size; /// capacity in bytes of the pipe from the process, 0 for a TCP channel
+} MIMPI_Peer_stats;
+
+/// @brief Communication of the calling process, counted since @ref MIMPI_Init().
+typedef struct {
+    uint64_t messages_sent; /// frames written to all processes
+    uint64_t bytes_sent; /// bytes of data in frames written to all processes
+    uint64_t messages_received; /// frames read from all processes
+    uint64_t bytes_received; /// bytes of data in frames read from all processes
+    uint64_t unexpected_high_water; /// highest high-water mark over all processes
+    uint64_t recv_wait_ns; /// nanoseconds receives spent blocked waiting for messages
+    uint64_t send_calls; /// write system calls on channels
+    uint64_t recv_calls; /// read system calls on channels
+    uint64_t control_sent; /// deadlock detection frames written
+    uint64_t control_received; /// deadlock detection frames read
+    uint64_t min_pipe_size; /// smallest capacity in bytes of pipes to and from other processes, 0 if there are none
+} MIMPI_Stats;
+
 /// @brief Initialises MIMPI framework in MIMPI programs.
 ///
 /// Opens an _MPI block_, permitting use of other MIMPI procedures.
@@ -55,6 +107,7 @@ int MIMPI_World_rank();
 ///
 /// Sends @ref count bytes of @ref data to the process with rank @ref destination.
 /// Data is tagged with @ref tag.
+/// May be called concurrently by several threads.
 ///
 /// @param data - data to be sent.
 /// @param count - number of bytes of data to be sent.
@@ -80,10 +133,14 @@ MIMPI_Retcode MIMPI_Send(
 ///
 /// Blocks until @ref count bytes of @ref data tagged with @ref tag arrives
 /// from the process with rank @ref destination. Then the data is put in @ref data.
+/// May be called concurrently by several threads, also on the same source,
+/// in which case receives are matched in the order they were posted.
 ///
 /// @param data - place where received data is to be put.
 /// @param count - number of bytes of data to be received.
-/// @param source - rank of the process for data from we are waiting. 
+/// @param source - rank of the process for data from we are waiting,
+///                 or `MIMPI_ANY_SOURCE` to accept the earliest matching
+///                 message of any process.
 /// @param tag - a discriminant of the data, which can be used
 ///              to distinguish between messages.
 /// @return MIMPI return code:
@@ -92,9 +149,11 @@ MIMPI_Retcode MIMPI_Send(
 ///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
 ///           @ref source in the world.
 ///         - `MIMPI_ERROR_REMOTE_FINISHED` if the process with rank
-///         - @ref source has already escaped _MPI block_.
+///         - @ref source has already escaped _MPI block_
+///           (all other processes, for `MIMPI_ANY_SOURCE`).
 ///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
 ///           and therefore this call would else never return.
+///           Receives from `MIMPI_ANY_SOURCE` are not checked for deadlocks.
 ///
 MIMPI_Retcode MIMPI_Recv(
     void *data,
@@ -103,6 +162,360 @@ MIMPI_Retcode MIMPI_Recv(
     int tag
 );
 
+/// @brief Description of a received message.
+///
+/// Tells which message a receive from `MIMPI_ANY_SOURCE`
+/// or with `MIMPI_ANY_TAG` has been matched with.
+typedef struct {
+    int source; /// rank of the sender
+    int tag; /// tag of the message
+    int count; /// number of bytes received
+} MIMPI_Status;
+
+/// @brief Receives data like @ref MIMPI_Recv and describes the message.
+///
+/// @param status - place where the description of the message is to be put,
+///                 may be NULL. Only set if the receive succeeded.
+/// @return MIMPI return code, as returned by @ref MIMPI_Recv.
+///
+MIMPI_Retcode MIMPI_Recv_status(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+);
+
+/// @brief Receives a message of any size up to the given one.
+///
+/// Blocks until a message tagged with @ref tag and at most @ref max_count
+/// bytes long arrives from @ref source, then puts it in @ref data.
+/// Of the messages matching, the one which arrived first is received.
+/// The message is matched once it has arrived, so a receive of its exact
+/// size posted meanwhile by another thread may take it first.
+///
+/// @param data - place where received data is to be put.
+/// @param max_count - greatest number of bytes of data to be received.
+/// @param source - rank of the sender, or `MIMPI_ANY_SOURCE`.
+/// @param tag - tag of the message, or `MIMPI_ANY_TAG`.
+/// @param status - place where the description of the message, including
+///                 its actual size, is to be put. May be NULL.
+/// @return MIMPI return code, as returned by @ref MIMPI_Recv.
+///         Receives of any size are not checked for deadlocks.
+///
+MIMPI_Retcode MIMPI_Recv_up_to(
+    void *data,
+    int max_count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+);
+
+/// @brief Sends data to one process and receives data from another at once.
+///
+/// Behaves like @ref MIMPI_Send to @ref destination together with
+/// @ref MIMPI_Recv_status from @ref source, but the receive is posted
+/// before sending. Processes exchanging data with each other by this
+/// function never wait for one another, whichever of them calls it first,
+/// also with messages above `MIMPI_EAGER_LIMIT`.
+///
+/// @param send_data - data to be sent.
+/// @param send_count - number of bytes of data to be sent.
+/// @param destination - rank of the process who is to receive the data.
+/// @param send_tag - tag of the data sent.
+/// @param recv_data - place where received data is to be put,
+///                    must not overlap @ref send_data.
+/// @param recv_count - number of bytes of data to be received.
+/// @param source - rank of the process data is received from,
+///                 or `MIMPI_ANY_SOURCE`. May equal @ref destination.
+/// @param recv_tag - tag of the data received.
+/// @param status - place where the description of the received message
+///                 is to be put, may be NULL. Only set if the receive succeeded.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if both the send and the receive ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` or `MIMPI_ERROR_NO_SUCH_RANK`
+///           if either rank is invalid, in which case nothing is sent nor received.
+///         - the error of the send, as returned by @ref MIMPI_Send, if it failed.
+///         - the error of the receive, as returned by @ref MIMPI_Recv, otherwise.
+///
+MIMPI_Retcode MIMPI_Sendrecv(
+    void const *send_data,
+    int send_count,
+    int destination,
+    int send_tag,
+    void *recv_data,
+    int recv_count,
+    int source,
+    int recv_tag,
+    MIMPI_Status *status
+);
+
+/// @brief Producer of the data of a stream, see @ref MIMPI_Send_stream.
+///
+/// Puts at most @ref capacity bytes of the stream in @ref chunk
+/// and returns their number. Returning 0 ends the stream.
+typedef int (*MIMPI_Stream_producer)(void *context, void *chunk, int capacity);
+
+/// @brief Consumer of the data of a stream, see @ref MIMPI_Recv_stream.
+///
+/// Takes @ref count bytes of the stream, in the order they were produced,
+/// from @ref chunk, which is only valid until the consumer returns.
+typedef void (*MIMPI_Stream_consumer)(void *context, void const *chunk, int count);
+
+/// @brief Sends data of any length produced on the fly to the specified process.
+///
+/// Calls @ref producer with @ref context until it returns 0, sending each
+/// chunk it produces. Only one chunk is held at a time, and the next one is
+/// only sent once the receiver has taken the previous one, so neither side
+/// holds more than a couple of chunks of the stream in memory.
+/// The stream is received by @ref MIMPI_Recv_stream with the same tag,
+/// which no other messages between the two processes may use meanwhile.
+///
+/// @param producer - function producing the data.
+/// @param context - argument passed to @ref producer.
+/// @param destination - rank of the process who is to receive the data.
+/// @param tag - a discriminant of the stream.
+/// @return MIMPI return code, as returned by @ref MIMPI_Send.
+///
+MIMPI_Retcode MIMPI_Send_stream(
+    MIMPI_Stream_producer producer,
+    void *context,
+    int destination,
+    int tag
+);
+
+/// @brief Receives a stream sent by @ref MIMPI_Send_stream, passing it on as it arrives.
+///
+/// Calls @ref consumer with @ref context on each chunk received and returns
+/// after the end of the stream.
+///
+/// @param consumer - function consuming the data.
+/// @param context - argument passed to @ref consumer.
+/// @param source - rank of the process sending the stream.
+/// @param tag - a discriminant of the stream.
+/// @return MIMPI return code, as returned by @ref MIMPI_Recv.
+///         Streams are not checked for deadlocks.
+///
+MIMPI_Retcode MIMPI_Recv_stream(
+    MIMPI_Stream_consumer consumer,
+    void *context,
+    int source,
+    int tag
+);
+
+/// @brief Waits for a message without receiving it.
+///
+/// Blocks until a message tagged with @ref tag from @ref source has arrived
+/// and is not matched by any posted receive, then describes the oldest such
+/// message. The message stays to be received, e.g. by @ref MIMPI_Recv
+/// with the size reported in @ref status. Messages of any size match.
+///
+/// @param source - rank of the sender, or `MIMPI_ANY_SOURCE`.
+/// @param tag - tag of the message, or `MIMPI_ANY_TAG`.
+/// @param status - place where the description of the message is to be put.
+///                 May be NULL.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if a message has arrived.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to probe itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the process with rank
+///           @ref source (all other processes, for `MIMPI_ANY_SOURCE`)
+///           has left without sending a matching message.
+///         Probes are not checked for deadlocks.
+///
+MIMPI_Retcode MIMPI_Probe(
+    int source,
+    int tag,
+    MIMPI_Status *status
+);
+
+/// @brief Checks whether a message has arrived without receiving it.
+///
+/// Never blocks, otherwise behaves like @ref MIMPI_Probe.
+///
+/// @param source - rank of the sender, or `MIMPI_ANY_SOURCE`.
+/// @param tag - tag of the message, or `MIMPI_ANY_TAG`.
+/// @param found - place where the flag whether a message has arrived is to be put.
+/// @param status - place where the description of the message is to be put
+///                 if it has arrived. May be NULL.
+/// @return MIMPI return code, as returned by @ref MIMPI_Probe.
+///         `MIMPI_SUCCESS` also if no message has arrived yet.
+///
+MIMPI_Retcode MIMPI_Iprobe(
+    int source,
+    int tag,
+    bool *found,
+    MIMPI_Status *status
+);
+
+/// @brief Handle of a non-blocking operation.
+///
+/// Returned by @ref MIMPI_Isend and @ref MIMPI_Irecv and released by
+/// @ref MIMPI_Wait, or by @ref MIMPI_Test once the operation has completed.
+typedef struct MIMPI_Request_data *MIMPI_Request;
+
+/// Handle which refers to no operation. Waiting for it completes immediately.
+#define MIMPI_REQUEST_NULL ((MIMPI_Request)0)
+
+/// @brief Starts sending data to the specified process.
+///
+/// Behaves like @ref MIMPI_Send, but the outcome is reported by
+/// @ref MIMPI_Wait or @ref MIMPI_Test on @ref request.
+/// @ref data must not be modified until the request has completed.
+/// Messages of at least 1 KiB are written by a helper thread while the caller goes on,
+/// smaller ones are written before the function returns. A later send to the same
+/// process waits for earlier non-blocking ones to be written, so messages keep their order.
+///
+/// @param data - data to be sent.
+/// @param count - number of bytes of data to be sent.
+/// @param destination - rank of the process who is to receive the data.
+/// @param tag - a discriminant of the data, which can be used
+///              to distinguish between messages.
+/// @param request - place where the handle of the operation is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if the operation has been started.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to send to itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref destination in the world.
+///         In case of an error @ref request is set to `MIMPI_REQUEST_NULL`.
+///
+MIMPI_Retcode MIMPI_Isend(
+    void const *data,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Request *request
+);
+
+/// @brief Posts a receive of data from the specified process.
+///
+/// Returns immediately. The data is put in @ref data once a message
+/// matching @ref count and @ref tag arrives from @ref source, which is
+/// reported by @ref MIMPI_Wait or @ref MIMPI_Test on @ref request.
+/// Receives posted on the same source are matched in the order of posting,
+/// as are receives from `MIMPI_ANY_SOURCE` with those on the sender.
+///
+/// @param data - place where received data is to be put.
+/// @param count - number of bytes of data to be received.
+/// @param source - rank of the process for data from we are waiting,
+///                 or `MIMPI_ANY_SOURCE`.
+/// @param tag - a discriminant of the data, which can be used
+///              to distinguish between messages.
+/// @param request - place where the handle of the operation is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if the receive has been posted.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to receive from itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///         In case of an error @ref request is set to `MIMPI_REQUEST_NULL`.
+///
+MIMPI_Retcode MIMPI_Irecv(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Request *request
+);
+
+/// @brief Waits for a non-blocking operation to complete.
+///
+/// Releases the request and sets @ref request to `MIMPI_REQUEST_NULL`,
+/// unless it is a persistent collective (see @ref MIMPI_Start).
+///
+/// @param request - handle of the operation.
+/// @return MIMPI return code of the operation, as returned by
+///         @ref MIMPI_Send or @ref MIMPI_Recv respectively.
+///         `MIMPI_SUCCESS` if @ref request is `MIMPI_REQUEST_NULL`.
+///
+MIMPI_Retcode MIMPI_Wait(
+    MIMPI_Request *request
+);
+
+/// @brief Waits like @ref MIMPI_Wait and describes the received message.
+///
+/// @param request - handle of the operation.
+/// @param status - place where the description of the message is to be put,
+///                 may be NULL. Only set if @ref request is a receive which succeeded.
+/// @return MIMPI return code, as returned by @ref MIMPI_Wait.
+///
+MIMPI_Retcode MIMPI_Wait_status(
+    MIMPI_Request *request,
+    MIMPI_Status *status
+);
+
+/// @brief Checks whether a non-blocking operation has completed.
+///
+/// Never blocks. If the operation has completed, releases the request
+/// and sets @ref request to `MIMPI_REQUEST_NULL`, as @ref MIMPI_Wait does.
+/// Persistent collectives are always complete.
+///
+/// @param request - handle of the operation.
+/// @param completed - place where the flag whether the operation
+///                    has completed is to be put.
+/// @return MIMPI return code:
+///         - return code of the operation if it has completed.
+///         - `MIMPI_SUCCESS` if it has not completed yet.
+///
+MIMPI_Retcode MIMPI_Test(
+    MIMPI_Request *request,
+    bool *completed
+);
+
+/// @brief Waits for all the given non-blocking operations to complete.
+///
+/// @param count - number of requests.
+/// @param requests - handles of the operations, all of which are released.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if all operations ended successfully.
+///         - return code of the first failed operation otherwise.
+///
+MIMPI_Retcode MIMPI_Waitall(
+    int count,
+    MIMPI_Request *requests
+);
+
+/// @brief Writes out messages coalesced by the sending process.
+///
+/// With `MIMPI_COALESCE_SIZE` set, small messages sent to a process may be
+/// kept back and written together with the following ones. They are written
+/// out when the buffer fills up, before the process blocks in a MIMPI call,
+/// at the end of each group function and by this function.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if all messages have been written out.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process which messages
+///           were kept back for has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Flush();
+
+/// @brief Reads the communication statistics of the calling process.
+///
+/// Counters are kept only if the library has been built with `MIMPI_STATS`
+/// defined, all of them are zero otherwise.
+///
+/// @param stats - statistics to be filled.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` always.
+///
+MIMPI_Retcode MIMPI_Get_stats(
+    MIMPI_Stats *stats
+);
+
+/// @brief Reads the statistics of communication with one process.
+///
+/// @param rank - rank of the process.
+/// @param stats - statistics to be filled.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if the statistics have been read.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to read its own statistics.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank `rank` in the world.
+///
+MIMPI_Retcode MIMPI_Get_peer_stats(
+    int rank,
+    MIMPI_Peer_stats *stats
+);
+
 /// @brief Synchronises all processes.
 ///
 /// Blocks execution of the calling process until all processes execute
@@ -145,14 +558,42 @@ MIMPI_Retcode MIMPI_Bcast(
     int root
 );
 
+/// @brief Broadcasts data to all processes without synchronising them.
+///
+/// Works like @ref MIMPI_Bcast, but skips the pass making it a synchronisation point:
+/// @ref root may return before other processes have entered the call,
+/// which saves log2(n) message latencies.
+///
+/// @param data - for @ref root, data to be broadcast; for other processes,
+///               place where data are to be put.
+/// @param count - number of bytes of data to be broadcast.
+/// @param root - rank of the process whose data are to be broadcast.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Bcast_nosync(
+    void *data,
+    int count,
+    int root
+);
+
 /// @brief Reduces data from all processes to one.
 ///
 /// Performs reduction of kind @ref op over @ref count bytes of data
 /// stored at address @ref send_data in every process. The reduction's result
 /// is put at @ref recv_data *ONLY* in the process with rank @ref root.
 /// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+/// With `MIMPI_IN_PLACE`, the result replaces the data of @ref root,
+/// while @ref recv_data of other processes is left as it is.
 ///
-/// @param send_data - data to be reduced.
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
 /// @param recv_data - place where reduction's result is to be put.
 /// @param count - number of bytes of data to be reduced.
 /// @param op - a particular operation to be performed for reduction.
@@ -175,4 +616,784 @@ MIMPI_Retcode MIMPI_Reduce(
     int root
 );
 
+/// @brief Reduces data from all processes to one without synchronising them.
+///
+/// Works like @ref MIMPI_Reduce, but skips the pass making it a synchronisation point:
+/// processes other than @ref root may return as soon as they have passed
+/// their partial results on, which saves log2(n) message latencies.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place where reduction's result is to be put.
+/// @param count - number of bytes of data to be reduced.
+/// @param op - a particular operation to be performed for reduction.
+/// @param root - rank of the process who is to hold the result of reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Reduce_nosync(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+);
+
+/// @brief Reduces typed data from all processes to one.
+///
+/// Works like @ref MIMPI_Reduce, but combines @ref count elements
+/// of type @ref datatype instead of @ref count bytes.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place where reduction's result is to be put.
+/// @param count - number of elements of data to be reduced.
+/// @param datatype - type of the elements.
+/// @param op - a particular operation to be performed for reduction.
+/// @param root - rank of the process who is to hold the result of reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Reduce_typed(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root
+);
+
+/// @brief Reduces data from all processes and makes the result available to all of them.
+///
+/// Performs reduction of kind @ref op over @ref count bytes of data
+/// stored at address @ref send_data in every process. The reduction's result
+/// is put at @ref recv_data in *every* process.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place where reduction's result is to be put.
+/// @param count - number of bytes of data to be reduced.
+/// @param op - a particular operation to be performed for reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allreduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+);
+
+/// @brief Reduces typed data from all processes and makes the result available to all of them.
+///
+/// Works like @ref MIMPI_Allreduce, but combines @ref count elements
+/// of type @ref datatype instead of @ref count bytes.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place where reduction's result is to be put.
+/// @param count - number of elements of data to be reduced.
+/// @param datatype - type of the elements.
+/// @param op - a particular operation to be performed for reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allreduce_typed(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+);
+
+/// @brief Collects a block of data from every process in the root.
+///
+/// Blocks travel up the broadcast tree: every process passes its parent
+/// the blocks of its whole subtree in a single message.
+///
+/// @param send_data - block of data of the process.
+/// @param recv_data - place for the blocks of all processes, ordered by rank,
+///                    significant only in @ref root.
+/// @param count - number of bytes of a single block.
+/// @param root - rank of the process who is to hold the blocks.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Gather(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+);
+
+/// @brief Hands every process its own block of the data of the root.
+///
+/// Blocks travel down the broadcast tree: every process receives the blocks
+/// of its whole subtree in a single message and splits them among its children.
+///
+/// @param send_data - blocks for all processes, ordered by rank,
+///                    significant only in @ref root.
+/// @param recv_data - place for the block of the process.
+/// @param count - number of bytes of a single block.
+/// @param root - rank of the process whose data are scattered.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Scatter(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+);
+
+/// @brief Collects a block of data from every process in all of them.
+///
+/// Works like @ref MIMPI_Gather to rank 0 followed by a broadcast of the result.
+///
+/// @param send_data - block of data of the process.
+/// @param recv_data - place for the blocks of all processes, ordered by rank.
+/// @param count - number of bytes of a single block.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allgather(
+    void const *send_data,
+    void *recv_data,
+    int count
+);
+
+/// @brief Sends a separate block of data from every process to every process.
+///
+/// In round i a process exchanges blocks with the process whose rank differs
+/// from its own by XOR with i (or with ranks i ahead and behind, if the size
+/// of the world is not a power of two), while the blocks of later rounds already arrive.
+///
+/// @param send_data - blocks for all processes, ordered by rank.
+/// @param recv_data - place for the blocks from all processes, ordered by rank.
+/// @param count - number of bytes of a single block.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Alltoall(
+    void const *send_data,
+    void *recv_data,
+    int count
+);
+
+/// @brief Reduces typed data of every process with the data of all processes of lower ranks.
+///
+/// Process i receives the reduction of the data of processes 0 to i. The scan takes
+/// ceil(log2 n) rounds, in round k every process sends its partial result
+/// to the process 2^k ranks ahead. Unlike @ref MIMPI_Reduce, this is not a synchronisation point.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Scan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+);
+
+/// @brief Works like @ref MIMPI_Scan, but leaves the data of the process itself out of its result.
+///
+/// Process i receives the reduction of the data of processes 0 to i - 1,
+/// @ref recv_data of process 0 is left as it is.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Exscan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op
+);
+
+/// @brief Handle of a group of processes collectives can run among.
+///
+/// Created by @ref MIMPI_Comm_split and released by @ref MIMPI_Comm_free.
+/// Collectives of different groups never match each other's messages,
+/// so groups with no process in common run their collectives in parallel.
+typedef struct MIMPI_Comm_data *MIMPI_Comm;
+
+/// Group of all processes, which collectives without a group run among.
+extern struct MIMPI_Comm_data MIMPI_world;
+#define MIMPI_COMM_WORLD (&MIMPI_world)
+
+/// Handle which refers to no group.
+#define MIMPI_COMM_NULL ((MIMPI_Comm)0)
+
+/// @brief Splits a group into groups of processes passing the same color.
+///
+/// Has to be called by all processes of @ref comm. Processes of a new group
+/// are ranked by @ref key, ties are broken by their ranks in @ref comm.
+///
+/// @param comm - group to be split.
+/// @param color - identifier of the group the process joins.
+/// @param key - value the process is ranked by in its new group.
+/// @param newcomm - place for the handle of the new group.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Comm_split(
+    MIMPI_Comm comm,
+    int color,
+    int key,
+    MIMPI_Comm *newcomm
+);
+
+/// @brief Releases a group created by @ref MIMPI_Comm_split.
+///
+/// Does not communicate. @ref MIMPI_COMM_WORLD is never released.
+///
+/// @param comm - handle of the group, set to `MIMPI_COMM_NULL`.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` always.
+///
+MIMPI_Retcode MIMPI_Comm_free(
+    MIMPI_Comm *comm
+);
+
+/// @brief Obtains the rank of the process in a group.
+///
+/// @param comm - group the process belongs to.
+/// @return rank of the process in @ref comm.
+///
+int MIMPI_Comm_rank(
+    MIMPI_Comm comm
+);
+
+/// @brief Obtains the number of processes in a group.
+///
+/// @param comm - group of processes.
+/// @return number of processes in @ref comm.
+///
+int MIMPI_Comm_size(
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Barrier among processes of a group.
+///
+/// @param comm - group to be synchronised.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Barrier_comm(
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Bcast among processes of a group.
+///
+/// @param data - data of the root, place for them in other processes.
+/// @param count - number of bytes of data.
+/// @param root - rank in @ref comm of the process whose data are broadcast.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the group.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Bcast_comm(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Reduce_typed among processes of a group.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place for the result in the root.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param root - rank in @ref comm of the process who is to hold the result.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the group.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Reduce_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Allreduce_typed among processes of a group.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allreduce_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Gather among processes of a group, blocks are ordered by ranks in it.
+///
+/// @param send_data - block of data of the process.
+/// @param recv_data - place for the blocks of all processes, significant only in @ref root.
+/// @param count - number of bytes of a single block.
+/// @param root - rank in @ref comm of the process who is to hold the blocks.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the group.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Gather_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Scatter among processes of a group, blocks are ordered by ranks in it.
+///
+/// @param send_data - blocks for all processes, significant only in @ref root.
+/// @param recv_data - place for the block of the process.
+/// @param count - number of bytes of a single block.
+/// @param root - rank in @ref comm of the process whose data are scattered.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the group.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Scatter_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Allgather among processes of a group, blocks are ordered by ranks in it.
+///
+/// @param send_data - block of data of the process.
+/// @param recv_data - place for the blocks of all processes.
+/// @param count - number of bytes of a single block.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allgather_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Alltoall among processes of a group, blocks are ordered by ranks in it.
+///
+/// @param send_data - blocks for all processes.
+/// @param recv_data - place for the blocks from all processes.
+/// @param count - number of bytes of a single block.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Alltoall_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Scan among processes of a group, ordered by ranks in it.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Scan_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    MIMPI_Comm comm
+);
+
+/// @brief Works like @ref MIMPI_Exscan among processes of a group, ordered by ranks in it.
+///
+/// @param send_data - data to be reduced, or `MIMPI_IN_PLACE` if it is in @ref recv_data.
+/// @param recv_data - place for the result.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param comm - group of the processes.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Exscan_comm(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    MIMPI_Comm comm
+);
+
+/// @brief Plans a broadcast to be run many times with @ref MIMPI_Start.
+///
+/// Nothing is communicated yet. Every @ref MIMPI_Start of the request
+/// works like @ref MIMPI_Bcast with the same arguments, which have to stay valid
+/// until the request is freed, but skips planning the tree again.
+///
+/// @param data - data to be broadcast, or place for them, at every start.
+/// @param count - number of bytes of data.
+/// @param root - rank of the process whose data are broadcast.
+/// @param request - place for the handle of the persistent broadcast.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if the broadcast has been planned.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank `root` in the world.
+///
+MIMPI_Retcode MIMPI_Bcast_init(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Request *request
+);
+
+/// @brief Plans a typed reduction to be run many times with @ref MIMPI_Start.
+///
+/// Nothing is communicated yet. Every @ref MIMPI_Start of the request
+/// works like @ref MIMPI_Reduce_typed with the same arguments, which have to stay
+/// valid until the request is freed, but neither plans the tree nor allocates.
+///
+/// @param send_data - data to be reduced at every start.
+/// @param recv_data - place for the result in the root.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param root - rank of the process who is to hold the result.
+/// @param request - place for the handle of the persistent reduction.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if the reduction has been planned.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank `root` in the world.
+///
+MIMPI_Retcode MIMPI_Reduce_init(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Request *request
+);
+
+/// @brief Runs a collective planned with @ref MIMPI_Bcast_init or @ref MIMPI_Reduce_init.
+///
+/// All processes have to start their requests of the same collective in the same order,
+/// as if they called the collective itself. The collective completes before
+/// the function returns, @ref MIMPI_Wait and @ref MIMPI_Test then report its result
+/// without releasing the request, which can be started again.
+///
+/// @param request - handle of the persistent collective.
+/// @return MIMPI return code of the collective, as returned by
+///         @ref MIMPI_Bcast or @ref MIMPI_Reduce_typed respectively.
+///
+MIMPI_Retcode MIMPI_Start(
+    MIMPI_Request *request
+);
+
+/// @brief Releases a request and sets @ref request to `MIMPI_REQUEST_NULL`.
+///
+/// A non-blocking operation is completed first, as by @ref MIMPI_Wait.
+/// Persistent collectives can only be released by this function.
+///
+/// @param request - handle of the operation.
+/// @return MIMPI return code:
+///         - return code of the non-blocking operation.
+///         - `MIMPI_SUCCESS` for persistent collectives and `MIMPI_REQUEST_NULL`.
+///
+MIMPI_Retcode MIMPI_Request_free(
+    MIMPI_Request *request
+);
+
+/// @brief Handle of a one-sided window.
+///
+/// Created by @ref MIMPI_Win_create and released by @ref MIMPI_Win_free.
+typedef struct MIMPI_Win_data *MIMPI_Win;
+
+/// Handle which refers to no window.
+#define MIMPI_WIN_NULL ((MIMPI_Win)0)
+
+/// @brief Creates a window other processes of a group access without taking part.
+///
+/// Has to be called by all processes of @ref comm. Every process contributes a segment
+/// of @ref size bytes, allocated by the call, and all segments live in a single mapping
+/// shared by the processes, so that accesses to them are plain memory operations.
+/// All processes of @ref comm have to run on the same host, as all ranks of a single host
+/// of `mimpirun` do. Accesses of different processes are ordered only by @ref MIMPI_Win_fence.
+///
+/// @param size - number of bytes of the segment of the process.
+/// @param comm - group of the processes.
+/// @param base - place for the pointer to the segment of the process.
+/// @param win - place for the handle of the window.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Win_create(
+    int size,
+    MIMPI_Comm comm,
+    void **base,
+    MIMPI_Win *win
+);
+
+/// @brief Writes data to a segment of a window, without the owner of the segment taking part.
+///
+/// Accesses outside of the segment are fatal.
+///
+/// @param origin - data to be written.
+/// @param count - number of bytes of data.
+/// @param target - rank, in the group of the window, of the owner of the segment.
+/// @param displacement - offset in the segment, in bytes.
+/// @param win - the window.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref target in the group of the window.
+///
+MIMPI_Retcode MIMPI_Put(
+    void const *origin,
+    int count,
+    int target,
+    int displacement,
+    MIMPI_Win win
+);
+
+/// @brief Reads data from a segment of a window, without the owner of the segment taking part.
+///
+/// Accesses outside of the segment are fatal.
+///
+/// @param origin - place for the data.
+/// @param count - number of bytes of data.
+/// @param target - rank, in the group of the window, of the owner of the segment.
+/// @param displacement - offset in the segment, in bytes.
+/// @param win - the window.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref target in the group of the window.
+///
+MIMPI_Retcode MIMPI_Get(
+    void *origin,
+    int count,
+    int target,
+    int displacement,
+    MIMPI_Win win
+);
+
+/// @brief Combines typed data into a segment of a window, as a reduction would.
+///
+/// Accumulates into the same segment exclude each other, so that concurrent ones
+/// from many processes lose no update. Accesses outside of the segment are fatal.
+///
+/// @param origin - data to be combined.
+/// @param count - number of elements of data.
+/// @param datatype - type of the elements.
+/// @param op - reduction operation.
+/// @param target - rank, in the group of the window, of the owner of the segment.
+/// @param displacement - offset in the segment, in bytes.
+/// @param win - the window.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref target in the group of the window.
+///
+MIMPI_Retcode MIMPI_Accumulate(
+    void const *origin,
+    int count,
+    MIMPI_Datatype datatype,
+    MIMPI_Op op,
+    int target,
+    int displacement,
+    MIMPI_Win win
+);
+
+/// @brief Separates accesses to a window before and after the call.
+///
+/// Has to be called by all processes of the group of the window. Works like
+/// @ref MIMPI_Barrier_comm, after which all accesses made before it by any process are visible.
+///
+/// @param win - the window.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a process this one communicates with
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Win_fence(
+    MIMPI_Win win
+);
+
+/// @brief Releases a window created by @ref MIMPI_Win_create.
+///
+/// Does not communicate. Segments stay valid for the processes which still hold the window.
+///
+/// @param win - handle of the window, set to `MIMPI_WIN_NULL`.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` always.
+///
+MIMPI_Retcode MIMPI_Win_free(
+    MIMPI_Win *win
+);
+
 #endif /* MIMPI_H */
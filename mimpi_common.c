@@ -6,6 +6,7 @@
 #include "mimpi_common.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -51,3 +52,47 @@ int calculate_file_descriptor(
 ) {
     return FIRST_AVAILABLE_DESCRIPTOR + 2 * (receiver * (world_size - 1) + sender - (sender > receiver));
 }
+
+
+int move_descriptor(
+    const int world_size,
+    const int fd
+) {
+    const int lowest = FIRST_AVAILABLE_DESCRIPTOR + 2 * world_size * (world_size - 1);
+    const int moved = fcntl(fd, F_DUPFD_CLOEXEC, lowest);
+
+    ASSERT_SYS_OK(moved);
+    ASSERT_SYS_OK(close(fd));
+
+    return moved;
+}
+
+
+bool shared_memory_transport() {
+    const char* transport = getenv(TRANSPORT_VAR);
+    return transport != NULL && strcmp(transport, "shm") == 0;
+}
+
+
+bool tcp_transport() {
+    const char* transport = getenv(TRANSPORT_VAR);
+    return transport != NULL && strcmp(transport, "tcp") == 0;
+}
+
+
+int shared_memory_descriptor(
+    const int world_size
+) {
+    return FIRST_AVAILABLE_DESCRIPTOR + 2 * world_size * (world_size - 1);
+}
+
+
+size_t shared_memory_offset(
+    const int world_size,
+    const int receiver,
+    const int sender,
+    const size_t ring_size
+) {
+    const int channel = (calculate_file_descriptor(world_size, receiver, sender) - FIRST_AVAILABLE_DESCRIPTOR) / 2;
+    return (size_t)channel * chringsize(ring_size);
+}
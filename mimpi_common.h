@@ -82,6 +82,42 @@ do {
 /* First available descriptor */
 #define FIRST_AVAILABLE_DESCRIPTOR 20
 
+/* Environment variable selecting the transport of channels: `pipe` (default), `shm` or `tcp`. */
+#define TRANSPORT_VAR "MIMPI_TRANSPORT"
+
+/* Environment variable with the capacity (in bytes) of every shared memory ring. */
+#define SHM_RING_SIZE_VAR "MIMPI_SHM_RING_SIZE"
+
+/* Default capacity of a shared memory ring, equal to the default capacity of a pipe. */
+#define SHM_DEFAULT_RING_SIZE 65536
+
+/* Environment variable with the default hostfile of `mimpirun`, listing the hosts ranks are placed on. */
+#define HOSTFILE_VAR "MIMPI_HOSTFILE"
+
+/* Environment variable with the comma-separated nodes (indices of hosts) of all ranks, set by `mimpirun` from a hostfile. */
+#define NODES_VAR "MIMPI_NODES"
+
+/* Environment variable with the default capacity (in bytes) `mimpirun` gives every pipe, the kernel's default if unset. */
+#define PIPE_SIZE_VAR "MIMPI_PIPE_SIZE"
+
+/* Environment variable with the default placement of processes by `mimpirun`: `none`, `core` or `socket`. */
+#define BIND_TO_VAR "MIMPI_BIND_TO"
+
+/* Environment variable with the default order `mimpirun` places processes in: `core` or `socket`. */
+#define MAP_BY_VAR "MIMPI_MAP_BY"
+
+/* Environment variable with the comma-separated list of CPUs helper threads of a process run on. */
+#define HELPER_CPUS_VAR "MIMPI_HELPER_CPUS"
+
+/* Environment variable with the path `mimpirun` writes the merged trace of all processes to. */
+#define TRACE_VAR "MIMPI_TRACE"
+
+/* Environment variable with the directory processes write their traces to, set by `mimpirun`. */
+#define TRACE_DIR_VAR "MIMPI_TRACE_DIR"
+
+/* Name of the trace of a process in the directory of traces, formatted with its rank. */
+#define TRACE_FILE_FORMAT "%s/trace.%d"
+
 
 /// @brief Calculates a file descriptor based on world size, receiver, and sender information.
 ///
@@ -97,4 +133,63 @@ int calculate_file_descriptor(
     const int sender
 );
 
+
+/// @brief Moves a descriptor to the first free number above all channel descriptors.
+///
+/// Keeps descriptors opened by MIMPI itself out of the ranges owned by user programs.
+///
+/// @param world_size - total number of processes.
+/// @param fd - descriptor to be moved, closed on success.
+///
+/// @return int:
+///     - number of the new descriptor (with close-on-exec set).
+int move_descriptor(
+    const int world_size,
+    const int fd
+);
+
+
+/// @brief Checks whether channels should carry data through shared memory rings.
+///
+/// @return bool:
+///     - true if the shared memory transport has been requested.
+bool shared_memory_transport();
+
+
+/// @brief Checks whether all channels should be TCP connections.
+///
+/// @return bool:
+///     - true if the TCP transport has been requested.
+bool tcp_transport();
+
+
+/// @brief Calculates the descriptor of the shared memory holding rings of all channels.
+///
+/// It directly follows descriptors of the channels.
+///
+/// @param world_size - total number of processes.
+///
+/// @return int:
+///     - number of the descriptor.
+int shared_memory_descriptor(
+    const int world_size
+);
+
+
+/// @brief Calculates the position of a channel's ring in the shared memory.
+///
+/// @param world_size - total number of processes.
+/// @param receiver - rank of the receiving process.
+/// @param sender - rank of the sending process.
+/// @param ring_size - capacity of a single ring.
+///
+/// @return size_t:
+///     - offset of the ring from the beginning of the shared memory.
+size_t shared_memory_offset(
+    const int world_size,
+    const int receiver,
+    const int sender,
+    const size_t ring_size
+);
+
 #endif // MIMPI_COMMON_H
\ No newline at end of file
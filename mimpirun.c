@@ -2,27 +2,1391 @@
  * This file is for implementation of mimpirun program.
  * */
 
+#define _GNU_SOURCE
+
 #include "mimpi_common.h"
 #include "channel.h"
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <linux/mempolicy.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <time.h>
 
-int main(int argc, char** argv) {
-    const int n = atoi(argv[1]);
-    ASSERT_SYS_OK(setenv("MIMPI_SIZE", argv[1], 0));
 
-    const char* prog = argv[2];
-    
+/* Sets of CPUs a process can be bound to. */
+typedef enum {
+    BIND_NONE,
+    BIND_CORE,
+    BIND_SOCKET,
+} binding;
+
+
+/* Orders in which consecutive ranks are spread over the CPUs. */
+typedef enum {
+    MAP_CORE,
+    MAP_SOCKET,
+} mapping;
+
+
+/* CPUs mimpirun may use and the sockets they belong to. */
+typedef struct topology {
+    int count;
+    int cpus[CPU_SETSIZE];
+    int sockets[CPU_SETSIZE];
+    int socket_count;           // Number of distinct sockets.
+    int socket_ids[CPU_SETSIZE]; // Distinct sockets in order of their first CPU.
+} topology;
+
+
+/* Largest number of hosts a hostfile may list. */
+#define MAX_HOSTS 256
+
+
+/* Host ranks are placed on, with the socket accepting TCP channels to its ranks. */
+typedef struct host {
+    char name[256];
+    struct sockaddr_in address; // Address of the listening socket.
+    int slots;                  // Number of ranks placed on the host.
+    int listener;               // Descriptor of the listening socket.
+} host;
+
+
+/// @brief Makes sure descriptors of all channels fit under the limit of open files.
+///
+/// Raises the soft limit up to the hard one when needed, quits otherwise.
+///
+/// @param n - number of processes to be launched.
+/// @param listeners - number of sockets listening for TCP channels.
+static void ensure_descriptor_limit(
+    const int n,
+    const int listeners
+) {
+    const rlim_t needed = FIRST_AVAILABLE_DESCRIPTOR + 2 * (rlim_t)n * (n - 1) + 1 + listeners;
+    struct rlimit limit;
+    ASSERT_SYS_OK(getrlimit(RLIMIT_NOFILE, &limit));
+
+    if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < needed) {
+        if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < needed) {
+            fatal(
+                "%d processes need %llu file descriptors, but RLIMIT_NOFILE allows only %llu",
+                n, (unsigned long long)needed, (unsigned long long)limit.rlim_max
+            );
+        }
+
+        limit.rlim_cur = needed;
+        ASSERT_SYS_OK(setrlimit(RLIMIT_NOFILE, &limit));
+    }
+}
+
+
+/// @brief Creates the shared memory holding rings of all channels.
+///
+/// The memory is left open at @ref shared_memory_descriptor for the children,
+/// and the capacity of a ring (rounded up to a power of two) is exported to them.
+///
+/// @param n - number of processes to be launched.
+static void create_shared_memory(
+    const int n
+) {
+    const char* ring_size_str = getenv(SHM_RING_SIZE_VAR);
+    const long long requested = ring_size_str != NULL ? atoll(ring_size_str) : SHM_DEFAULT_RING_SIZE;
+    if (requested < 1) {
+        fatal("%s must be positive, got %s", SHM_RING_SIZE_VAR, ring_size_str);
+    }
+
+    size_t ring_size = 1;
+    while (ring_size < (size_t)requested) {
+        ring_size *= 2;
+    }
+
+    char ring_size_exported[24];
+    ASSERT_SPRINTF(sprintf(ring_size_exported, "%zu", ring_size));
+    ASSERT_SYS_OK(setenv(SHM_RING_SIZE_VAR, ring_size_exported, 1));
+
+    const int memory_fd = memfd_create("mimpi", 0);
+    ASSERT_SYS_OK(memory_fd);
+    ASSERT_SYS_OK(ftruncate(memory_fd, (off_t)n * (n - 1) * chringsize(ring_size)));
+
+    ASSERT_SYS_OK(dup2(memory_fd, shared_memory_descriptor(n)));
+    ASSERT_SYS_OK(close(memory_fd));
+}
+
+
+/// @brief Keeps the channel ends of a process open across exec.
+///
+/// All channels are created close-on-exec, so the kernel drops the ones
+/// not owned by the process at exec, instead of the child closing them one by one.
+///
+/// @param n - number of processes launched.
+/// @param rank - rank of the process.
+static void keep_own_channels(
+    const int n,
+    const int rank
+) {
+    for (int other = 0; other < n; other++) {
+        if (other == rank) continue;
+
+        ASSERT_SYS_OK(fcntl(calculate_file_descriptor(n, rank, other), F_SETFD, 0));
+        ASSERT_SYS_OK(fcntl(calculate_file_descriptor(n, other, rank) + 1, F_SETFD, 0));
+    }
+}
+
+
+/// @brief Reads a number from a file of the sysfs or procfs.
+///
+/// @param path - path of the file.
+/// @param fallback - value returned if the file cannot be read.
+///
+/// @return int:
+///     - the number read, @p fallback otherwise.
+static int read_sysfs_number(
+    const char* path,
+    const int fallback
+) {
+    FILE* file = fopen(path, "r");
+    int value = fallback;
+
+    if (file != NULL) {
+        if (fscanf(file, "%d", &value) != 1) {
+            value = fallback;
+        }
+        ASSERT_ZERO(fclose(file));
+    }
+
+    return value;
+}
+
+
+/// @brief Finds the NUMA node of a CPU.
+///
+/// @param cpu - number of the CPU.
+///
+/// @return int:
+///     - number of the node, -1 if the system does not tell.
+static int cpu_node(
+    const int cpu
+) {
+    char path[64];
+    ASSERT_SPRINTF(sprintf(path, "/sys/devices/system/cpu/cpu%d", cpu));
+
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    int node = -1;
+    struct dirent* entry;
+
+    while (node < 0 && (entry = readdir(dir)) != NULL) {
+        if (sscanf(entry->d_name, "node%d", &node) != 1) {
+            node = -1;
+        }
+    }
+
+    ASSERT_SYS_OK(closedir(dir));
+    return node;
+}
+
+
+/// @brief Lists the CPUs mimpirun is allowed to run on, with their sockets.
+///
+/// @param topo - pointer to the topology to be filled.
+static void read_topology(
+    topology* topo
+) {
+    cpu_set_t allowed;
+    ASSERT_SYS_OK(sched_getaffinity(0, sizeof(allowed), &allowed));
+
+    topo->count = 0;
+    topo->socket_count = 0;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+
+        char path[96];
+        ASSERT_SPRINTF(sprintf(path, "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu));
+        const int socket = read_sysfs_number(path, 0);
+
+        topo->cpus[topo->count] = cpu;
+        topo->sockets[topo->count] = socket;
+        topo->count++;
+
+        bool known = false;
+        for (int i = 0; i < topo->socket_count; i++) {
+            known |= topo->socket_ids[i] == socket;
+        }
+        if (!known) {
+            topo->socket_ids[topo->socket_count++] = socket;
+        }
+    }
+}
+
+
+/// @brief Chooses the CPU a process is placed on.
+///
+/// @param topo - pointer to the topology.
+/// @param map - order in which ranks are spread.
+/// @param rank - rank of the process.
+///
+/// @return int:
+///     - index of the CPU in the topology.
+static int place_rank(
+    const topology* topo,
+    const mapping map,
+    const int rank
+) {
+    if (map == MAP_CORE) {
+        return rank % topo->count;
+    }
+
+    // Consecutive ranks go to consecutive sockets, each one filling its CPUs in order.
+    const int socket = topo->socket_ids[rank % topo->socket_count];
+    int on_socket = 0;
+
+    for (int i = 0; i < topo->count; i++) {
+        on_socket += topo->sockets[i] == socket;
+    }
+
+    int wanted = rank / topo->socket_count % on_socket;
+
+    for (int i = 0; i < topo->count; i++) {
+        if (topo->sockets[i] == socket && wanted-- == 0) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+
+/// @brief Binds the calling process to the CPUs chosen for its rank, before it executes the program.
+///
+/// The memory of the process is preferably allocated on the node of the CPU,
+/// and its helper threads are told to stay on the socket of the CPU.
+///
+/// @param topo - pointer to the topology.
+/// @param bind - set of CPUs the process is bound to.
+/// @param map - order in which ranks are spread.
+/// @param rank - rank of the process.
+static void bind_rank(
+    const topology* topo,
+    const binding bind,
+    const mapping map,
+    const int rank
+) {
+    const int placed = place_rank(topo, map, rank);
+    const int socket = topo->sockets[placed];
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    char helper_cpus[8 * CPU_SETSIZE] = "";
+    size_t length = 0;
+
+    for (int i = 0; i < topo->count; i++) {
+        if (topo->sockets[i] != socket) continue;
+
+        if (bind == BIND_SOCKET) {
+            CPU_SET(topo->cpus[i], &cpus);
+        }
+        const int written = sprintf(helper_cpus + length, "%s%d", length > 0 ? "," : "", topo->cpus[i]);
+        ASSERT_SPRINTF(written);
+        length += written;
+    }
+
+    if (bind == BIND_CORE) {
+        CPU_SET(topo->cpus[placed], &cpus);
+    }
+
+    ASSERT_SYS_OK(sched_setaffinity(0, sizeof(cpus), &cpus));
+    ASSERT_SYS_OK(setenv(HELPER_CPUS_VAR, helper_cpus, 0));
+
+    // Only a hint, kernels without NUMA support refuse it and allocate locally anyway.
+    const int node = cpu_node(topo->cpus[placed]);
+    if (node >= 0 && node < (int)(8 * sizeof(unsigned long))) {
+        const unsigned long nodemask = 1UL << node;
+        const long ret = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodemask, 8 * sizeof(nodemask));
+        if (ret != 0 && errno != ENOSYS && errno != EPERM) {
+            syserr("Setting the memory policy of rank %d failed", rank);
+        }
+    }
+}
+
+
+/// @brief Parses the name of a binding.
+///
+/// @param name - name given by the user.
+///
+/// @return binding:
+///     - the binding named, quits if the name is unknown.
+static binding parse_binding(
+    const char* name
+) {
+    if (strcmp(name, "none") == 0) return BIND_NONE;
+    if (strcmp(name, "core") == 0) return BIND_CORE;
+    if (strcmp(name, "socket") == 0) return BIND_SOCKET;
+
+    fatal("Unknown binding %s, expected core, socket or none", name);
+}
+
+
+/// @brief Parses the name of a mapping.
+///
+/// @param name - name given by the user.
+///
+/// @return mapping:
+///     - the mapping named, quits if the name is unknown.
+static mapping parse_mapping(
+    const char* name
+) {
+    if (strcmp(name, "core") == 0) return MAP_CORE;
+    if (strcmp(name, "socket") == 0) return MAP_SOCKET;
+
+    fatal("Unknown mapping %s, expected core or socket", name);
+}
+
+
+/* File with the largest capacity an unprivileged process may give a pipe. */
+#define PIPE_MAX_SIZE_PATH "/proc/sys/fs/pipe-max-size"
+
+
+/// @brief Parses the capacity of pipes.
+///
+/// @param size - capacity in bytes given by the user.
+///
+/// @return int:
+///     - the capacity, quits if it is not a positive number.
+static int parse_pipe_size(
+    const char* size
+) {
+    char* end;
+    const long value = strtol(size, &end, 10);
+
+    if (*size == '\0' || *end != '\0' || value < 1 || value > INT_MAX) {
+        fatal("Pipe size must be a positive number of bytes, got %s", size);
+    }
+
+    return (int)value;
+}
+
+
+/// @brief Gives a pipe the requested capacity, as far as the system allows.
+///
+/// The kernel rounds the capacity up to a power of two pages. A pipe the capacity
+/// cannot be given to (e.g. over the limit of pipe buffers of the user) keeps its own,
+/// processes learn the capacities in effect from their descriptors.
+///
+/// @param fd - descriptor of either end of the pipe.
+/// @param size - requested capacity in bytes, 0 to keep the default one.
+/// @param max_size - largest capacity allowed.
+static void set_pipe_size(
+    const int fd,
+    const int size,
+    const int max_size
+) {
+    if (size > 0) {
+        fcntl(fd, F_SETPIPE_SZ, size < max_size ? size : max_size);
+    }
+}
+
+
+/// @brief Resolves a host and starts listening for TCP channels on it.
+///
+/// Ranks can only be started on this machine, so the host has to be one of its addresses
+/// (e.g. any of `127.0.0.0/8`), and each host stands for a separate node.
+/// The listening socket is moved past descriptors of the channels.
+///
+/// @param name - name or IPv4 address of the host.
+/// @param slots - number of ranks placed on the host.
+/// @param n - number of processes to be launched.
+/// @param h - pointer to the host to be filled.
+static void open_host(
+    const char* name,
+    const int slots,
+    const int n,
+    host* h
+) {
+    struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_STREAM};
+    struct addrinfo* found;
+
+    const int ret = getaddrinfo(name, NULL, &hints, &found);
+    if (ret != 0) {
+        fatal("Resolving host %s failed: %s", name, gai_strerror(ret));
+    }
+    memcpy(&h->address, found->ai_addr, sizeof(h->address));
+    freeaddrinfo(found);
+
+    ASSERT_SPRINTF(snprintf(h->name, sizeof(h->name), "%s", name));
+    h->slots = slots;
+
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_SYS_OK(fd);
+
+    if (bind(fd, (const struct sockaddr*)&h->address, sizeof(h->address)) != 0) {
+        if (errno == EADDRNOTAVAIL) {
+            fatal("Host %s is not an address of this machine, ranks cannot be started remotely", name);
+        }
+        syserr("Binding a socket to host %s failed", name);
+    }
+
+    socklen_t length = sizeof(h->address);
+    ASSERT_SYS_OK(getsockname(fd, (struct sockaddr*)&h->address, &length));
+    ASSERT_SYS_OK(listen(fd, 1));
+
+    h->listener = move_descriptor(n, fd);
+}
+
+
+/// @brief Reads a hostfile and places ranks on its hosts.
+///
+/// Every line names a host, optionally followed by `slots=N` (1 by default);
+/// `#` starts a comment. Hosts take consecutive ranks, as many as their slots.
+///
+/// @param path - path of the hostfile.
+/// @param n - number of processes to be launched.
+/// @param hosts - array of @ref MAX_HOSTS hosts to be filled.
+/// @param rank_host - array of @p n indices of hosts, filled for every rank.
+///
+/// @return int:
+///     - number of hosts read, quits if the file is invalid or has fewer slots than @p n.
+static int read_hostfile(
+    const char* path,
+    const int n,
+    host* hosts,
+    int* rank_host
+) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        syserr("Opening hostfile %s failed", path);
+    }
+
+    int count = 0, placed = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "#\n")] = '\0';
+
+        char name[256], extra[32];
+        int slots = 1;
+
+        const int fields = sscanf(line, "%255s %31s", name, extra);
+        if (fields < 1) continue;
+
+        if ((fields == 2 && sscanf(extra, "slots=%d", &slots) != 1) || slots < 1) {
+            fatal("Invalid line of hostfile %s: %s", path, line);
+        }
+        if (count == MAX_HOSTS) {
+            fatal("Hostfile %s lists more than %d hosts", path, MAX_HOSTS);
+        }
+
+        open_host(name, slots, n, &hosts[count]);
+        for (int i = 0; i < slots && placed < n; i++) {
+            rank_host[placed++] = count;
+        }
+        count++;
+    }
+
+    ASSERT_ZERO(fclose(file));
+
+    if (placed < n) {
+        fatal("Hostfile %s has %d slots, %d processes requested", path, placed, n);
+    }
+
+    return count;
+}
+
+
+/// @brief Connects a TCP channel between two hosts.
+///
+/// The connection is bound to the address of the sending host, so that it crosses
+/// the same interface a connection between two machines would.
+///
+/// @param receiver - pointer to the host of the receiving process.
+/// @param sender - pointer to the host of the sending process.
+/// @param channelfd - the reading and the writing end of the channel, as returned by `pipe`.
+static void connect_channel(
+    const host* receiver,
+    const host* sender,
+    int channelfd[2]
+) {
+    const int writing = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_SYS_OK(writing);
+
+    struct sockaddr_in local = sender->address;
+    local.sin_port = 0;
+    ASSERT_SYS_OK(bind(writing, (const struct sockaddr*)&local, sizeof(local)));
+    ASSERT_SYS_OK(connect(writing, (const struct sockaddr*)&receiver->address, sizeof(receiver->address)));
+
+    // Only mimpirun connects, one connection at a time.
+    const int reading = accept4(receiver->listener, NULL, NULL, SOCK_CLOEXEC);
+    ASSERT_SYS_OK(reading);
+
+    // Frames are written whole, waiting for more of them only delays the receiver.
+    const int on = 1;
+    ASSERT_SYS_OK(setsockopt(writing, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)));
+
+    channelfd[0] = reading;
+    channelfd[1] = writing;
+}
+
+
+/// @brief Creates channels between all processes to be launched, at the descriptors they expect.
+///
+/// Channels between ranks placed on different hosts of the hostfile (or all, with the tcp transport)
+/// are TCP connections, the rest are pipes. With the shm transport, the memory of the rings is created too.
+///
+/// @param n - number of processes to be launched.
+/// @param hostfile - path of the hostfile, NULL if there is none.
+/// @param pipe_size - capacity requested for pipes, 0 for the default one.
+/// @param extra - number of descriptors mimpirun needs open next to the channels.
+static void wire_channels(
+    const int n,
+    const char* hostfile,
+    const int pipe_size,
+    const int extra
+) {
+    static host hosts[MAX_HOSTS];
+    int* rank_host = (int*)calloc(n, sizeof(int));
+    ASSERT_MALLOC(rank_host);
+    int host_count = 0;
+
+    // Without a hostfile, the tcp transport places every rank on a separate node of the loopback.
+    ensure_descriptor_limit(n, (hostfile != NULL ? MAX_HOSTS : 1) + extra);
+    if (hostfile != NULL) {
+        host_count = read_hostfile(hostfile, n, hosts, rank_host);
+
+        // Ranks learn the layout to plan collectives along it.
+        char* nodes = (char*)malloc(12 * (size_t)n);
+        ASSERT_MALLOC(nodes);
+
+        for (int i = 0, length = 0; i < n; i++) {
+            const int written = sprintf(nodes + length, "%s%d", i > 0 ? "," : "", rank_host[i]);
+            ASSERT_SPRINTF(written);
+            length += written;
+        }
+        ASSERT_SYS_OK(setenv(NODES_VAR, nodes, 1));
+        free(nodes);
+    }
+    else if (tcp_transport()) {
+        open_host("127.0.0.1", n, n, &hosts[host_count++]);
+    }
+
+    const int pipe_max_size = read_sysfs_number(PIPE_MAX_SIZE_PATH, INT_MAX);
+
     for (int i = 0, nr = FIRST_AVAILABLE_DESCRIPTOR; i < n * (n-1); i++, nr += 2) {
+        // Channels follow the order of calculate_file_descriptor.
+        const int receiver = i / (n - 1);
+        const int sender = i % (n - 1) + (i % (n - 1) >= receiver);
+
         int pipefd[2];
-        ASSERT_SYS_OK(channel(pipefd));
+        if (tcp_transport() || rank_host[receiver] != rank_host[sender]) {
+            connect_channel(&hosts[rank_host[receiver]], &hosts[rank_host[sender]], pipefd);
+        }
+        else {
+            ASSERT_SYS_OK(channel(pipefd));
+            set_pipe_size(pipefd[1], pipe_size, pipe_max_size);
+        }
         
-        ASSERT_SYS_OK(dup2(pipefd[0], nr));
+        ASSERT_SYS_OK(dup3(pipefd[0], nr, O_CLOEXEC));
         ASSERT_SYS_OK(close(pipefd[0]));
         
-        ASSERT_SYS_OK(dup2(pipefd[1], nr + 1));
+        ASSERT_SYS_OK(dup3(pipefd[1], nr + 1, O_CLOEXEC));
         ASSERT_SYS_OK(close(pipefd[1]));
     }
 
+    for (int i = 0; i < host_count; i++) {
+        ASSERT_SYS_OK(close(hosts[i].listener));
+    }
+    free(rank_host);
+
+    if (shared_memory_transport()) {
+        create_shared_memory(n);
+    }
+}
+
+
+/// @brief Closes the channels and shared memory, once the launched processes have their copies.
+///
+/// @param n - number of processes launched.
+static void release_channels(
+    const int n
+) {
+    if (n > 1) {
+        ASSERT_SYS_OK(close_range(FIRST_AVAILABLE_DESCRIPTOR, shared_memory_descriptor(n) - 1, 0));
+    }
+
+    if (shared_memory_transport()) {
+        ASSERT_SYS_OK(close(shared_memory_descriptor(n)));
+    }
+}
+
+
+/// @brief Reads the monotonic clock, shared with the launched processes.
+///
+/// @return unsigned long long:
+///     - current time in nanoseconds.
+static unsigned long long monotonic_clock() {
+    struct timespec now;
+    ASSERT_SYS_OK(clock_gettime(CLOCK_MONOTONIC, &now));
+    return (unsigned long long)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+
+/// @brief Merges traces of all processes into a single Chrome (Perfetto) JSON timeline.
+///
+/// Processes become `pid`s and their threads `tid`s. Timestamps of all processes
+/// come from the same monotonic clock and are shifted, so that the launch is time zero.
+/// Traces are removed once merged.
+///
+/// @param path - path of the merged trace.
+/// @param directory - directory holding traces of the processes.
+/// @param n - number of processes launched.
+/// @param epoch - time of the launch.
+static void merge_traces(
+    const char* path,
+    const char* directory,
+    const int n,
+    const unsigned long long epoch
+) {
+    FILE* output = fopen(path, "w");
+    if (output == NULL) {
+        syserr("Opening %s failed", path);
+    }
+
+    fprintf(output, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+
+    for (int rank = 0; rank < n; rank++) {
+        fprintf(
+            output, "%s{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"name\": \"rank %d\"}}",
+            rank > 0 ? ",\n" : "", rank, rank
+        );
+
+        char trace_path[PATH_MAX];
+        ASSERT_SPRINTF(snprintf(trace_path, sizeof(trace_path), TRACE_FILE_FORMAT, directory, rank));
+
+        // A process which has crashed leaves no trace.
+        FILE* trace = fopen(trace_path, "r");
+        if (trace == NULL) continue;
+
+        char line[256];
+        while (fgets(line, sizeof(line), trace) != NULL) {
+            char phase, name[64];
+            unsigned long long time;
+            int thread, peer, tag, count;
+
+            if (sscanf(line, "T %d %63[^\n]", &thread, name) == 2) {
+                fprintf(
+                    output, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                    rank, thread, name
+                );
+            }
+            else if (sscanf(line, "%c %llu %d %63s %d %d %d", &phase, &time, &thread, name, &peer, &tag, &count) == 7) {
+                fprintf(
+                    output, ",\n{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": %d, \"tid\": %d, ",
+                    name, phase, (double)(time - epoch) / 1000, rank, thread
+                );
+
+                if (phase == 'B') {
+                    fprintf(output, "\"args\": {\"peer\": %d, \"tag\": %d, \"count\": %d}}", peer, tag, count);
+                }
+                else {
+                    fprintf(output, "\"args\": {\"result\": %d}}", count);
+                }
+            }
+        }
+
+        ASSERT_ZERO(fclose(trace));
+        ASSERT_SYS_OK(unlink(trace_path));
+    }
+
+    fprintf(output, "\n]}\n");
+    ASSERT_ZERO(fclose(output));
+    ASSERT_SYS_OK(rmdir(directory));
+}
+
+
+/* Job submitted to a daemon: what exec of every rank needs, apart from its wiring. */
+typedef struct job_header {
+    int argc;
+    int envc;
+    size_t length; // Of the strings following the header: working directory, arguments, environment.
+} job_header;
+
+
+/* Number of descriptors a job takes over from its client: standard input, output and error. */
+#define JOB_DESCRIPTORS 3
+
+
+/* Limit on the length of the strings of a job, well above what exec accepts. */
+#define JOB_MAX_LENGTH ((size_t)1 << 24)
+
+
+/* Time (in seconds) a client has to submit its job once connected. */
+#define JOB_SUBMIT_TIMEOUT 5
+
+
+/* Outcomes of receiving a job. */
+typedef enum {
+    JOB_RECEIVED,
+    JOB_NONE,       // The socket has been closed without a job.
+    JOB_REJECTED,   // The submission was malformed, nothing of it is kept.
+} job_receipt;
+
+
+/* Path of the socket of the daemon, removed when it is stopped. */
+static const char* daemon_socket_path;
+
+
+/// @brief Writes the whole buffer to a socket.
+///
+/// @param fd - descriptor of the socket.
+/// @param buffer - data to be written.
+/// @param length - length of the data.
+static void write_all(
+    const int fd,
+    const void* buffer,
+    const size_t length
+) {
+    for (size_t done = 0; done < length; ) {
+        const ssize_t written = write(fd, (const char*)buffer + done, length - done);
+        if (written < 0 && errno == EINTR) continue;
+        ASSERT_SYS_OK(written);
+        done += written;
+    }
+}
+
+
+/// @brief Reads a whole buffer from a socket.
+///
+/// @param fd - descriptor of the socket.
+/// @param buffer - memory the data is read to.
+/// @param length - length of the data.
+///
+/// @return bool:
+///     - true if the data has been read, false if the socket has been closed or has failed before.
+static bool read_all(
+    const int fd,
+    void* buffer,
+    const size_t length
+) {
+    for (size_t done = 0; done < length; ) {
+        const ssize_t count = read(fd, (char*)buffer + done, length - done);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        done += count;
+    }
+
+    return true;
+}
+
+
+/// @brief Sends a job through a socket, passing its standard descriptors along.
+///
+/// @param fd - descriptor of the socket.
+/// @param header - header of the job.
+/// @param strings - strings of the job, `header->length` bytes.
+/// @param descriptors - standard input, output and error of the job.
+static void send_job(
+    const int fd,
+    const job_header* header,
+    const char* strings,
+    const int descriptors[JOB_DESCRIPTORS]
+) {
+    union {
+        char buffer[CMSG_SPACE(sizeof(int) * JOB_DESCRIPTORS)];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct iovec iov = {.iov_base = (void*)header, .iov_len = sizeof(*header)};
+    struct msghdr message = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = sizeof(control.buffer),
+    };
+
+    struct cmsghdr* rights = CMSG_FIRSTHDR(&message);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(int) * JOB_DESCRIPTORS);
+    memcpy(CMSG_DATA(rights), descriptors, sizeof(int) * JOB_DESCRIPTORS);
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    ASSERT_SYS_OK(sent);
+
+    // Stream sockets send ancillary data with the first byte, the rest may follow separately.
+    write_all(fd, (const char*)header + sent, sizeof(*header) - sent);
+    write_all(fd, strings, header->length);
+}
+
+
+/// @brief Checks that the strings of a job hold exactly the entries its header promises.
+///
+/// @param header - header of the job.
+/// @param strings - strings of the job, `header->length` bytes.
+///
+/// @return bool:
+///     - true if the strings are the working directory, `argc` arguments and `envc` variables, each NUL-terminated.
+static bool valid_strings(
+    const job_header* header,
+    const char* strings
+) {
+    size_t entries = 0;
+    for (size_t i = 0; i < header->length; i++) {
+        entries += strings[i] == '\0';
+    }
+
+    return strings[header->length - 1] == '\0' && entries == (size_t)header->argc + header->envc + 1;
+}
+
+
+/// @brief Receives a job sent with @ref send_job.
+///
+/// A malformed submission is rejected with a warning, and whatever has been received of it is released.
+///
+/// @param fd - descriptor of the socket.
+/// @param header - header of the job to be filled in.
+/// @param strings - set to the strings of the job, allocated with malloc.
+/// @param descriptors - set to copies of the standard descriptors of the job, close-on-exec.
+///
+/// @return job_receipt:
+///     - JOB_RECEIVED if a job has been received, JOB_NONE if the socket has been closed instead,
+///       JOB_REJECTED if the submission was malformed.
+static job_receipt receive_job(
+    const int fd,
+    job_header* header,
+    char** strings,
+    int descriptors[JOB_DESCRIPTORS]
+) {
+    union {
+        char buffer[CMSG_SPACE(sizeof(int) * JOB_DESCRIPTORS)];
+        struct cmsghdr align;
+    } control;
+
+    struct iovec iov = {.iov_base = header, .iov_len = sizeof(*header)};
+    struct msghdr message = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = sizeof(control.buffer),
+    };
+
+    ssize_t received;
+    do {
+        received = recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received == 0) return JOB_NONE;
+
+    // Descriptors passed along are ours from here on, whether the job is taken or not.
+    int passed[JOB_DESCRIPTORS];
+    int passed_count = 0;
+    struct cmsghdr* rights = received > 0 ? CMSG_FIRSTHDR(&message) : NULL;
+    if (rights != NULL && rights->cmsg_level == SOL_SOCKET && rights->cmsg_type == SCM_RIGHTS) {
+        passed_count = (rights->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        memcpy(passed, CMSG_DATA(rights), sizeof(int) * passed_count);
+    }
+
+    const char* problem = NULL;
+    *strings = NULL;
+
+    if (received < 0) {
+        problem = "receiving it failed";
+    }
+    else if (passed_count != JOB_DESCRIPTORS || (message.msg_flags & MSG_CTRUNC)) {
+        problem = "it came without its standard descriptors";
+    }
+    else if (!read_all(fd, (char*)header + received, sizeof(*header) - received)) {
+        problem = "it was cut short";
+    }
+    else if (header->length == 0 || header->length > JOB_MAX_LENGTH || header->argc < 1 || header->envc < 0
+             || (size_t)header->argc + header->envc + 1 > header->length) {
+        problem = "its header is invalid";
+    }
+    else {
+        *strings = (char*)malloc(header->length);
+        ASSERT_MALLOC(*strings);
+
+        if (!read_all(fd, *strings, header->length)) {
+            problem = "it was cut short";
+        }
+        else if (!valid_strings(header, *strings)) {
+            problem = "its strings do not match its header";
+        }
+    }
+
+    if (problem != NULL) {
+        fprintf(stderr, "WARNING: Rejected a job, %s\n", problem);
+        for (int i = 0; i < passed_count; i++) {
+            ASSERT_SYS_OK(close(passed[i]));
+        }
+        free(*strings);
+        return JOB_REJECTED;
+    }
+
+    memcpy(descriptors, passed, sizeof(int) * JOB_DESCRIPTORS);
+    return JOB_RECEIVED;
+}
+
+
+/// @brief Checks that a client of the daemon runs as the same user as the daemon.
+///
+/// @param fd - descriptor of the connection of the client.
+///
+/// @return bool:
+///     - true if the client may submit jobs.
+static bool trusted_client(
+    const int fd
+) {
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0 || credentials.uid != geteuid()) {
+        fprintf(stderr, "WARNING: Rejected a job of another user\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+/// @brief Closes the channel ends not owned by a process, keeping its own ones.
+///
+/// Spares a warm rank closing them at exec, when a job is already waiting for it.
+///
+/// @param n - number of processes launched.
+/// @param rank - rank of the process.
+static void close_other_channels(
+    const int n,
+    const int rank
+) {
+    int next = FIRST_AVAILABLE_DESCRIPTOR;
+
+    // Own descriptors in increasing order: reading ends of channels to the process form the block
+    // of the process as a receiver, writing ends lie one in the block of every other receiver.
+    for (int receiver = 0; receiver < n; receiver++) {
+        for (int sender = 0; sender < n; sender++) {
+            if (sender == receiver || (receiver != rank && sender != rank)) continue;
+
+            const int fd = calculate_file_descriptor(n, receiver, sender) + (receiver != rank);
+            if (fd > next) {
+                ASSERT_SYS_OK(close_range(next, fd - 1, 0));
+            }
+            next = fd + 1;
+        }
+    }
+
+    if (next < shared_memory_descriptor(n)) {
+        ASSERT_SYS_OK(close_range(next, shared_memory_descriptor(n) - 1, 0));
+    }
+}
+
+
+/// @brief Replaces a warm rank with the program of a job.
+///
+/// The rank takes the standard descriptors, working directory and environment of the client,
+/// keeping variables of its wiring set up by the daemon. Jobs are not traced.
+///
+/// @param header - header of the job.
+/// @param strings - strings of the job.
+/// @param descriptors - standard descriptors of the job.
+/// @param pid_rank - name of the variable holding the rank.
+_Noreturn static void exec_job(
+    const job_header* header,
+    char* strings,
+    const int descriptors[JOB_DESCRIPTORS],
+    const char* pid_rank
+) {
+    const char* wiring[] = {"MIMPI_SIZE", pid_rank, TRANSPORT_VAR, SHM_RING_SIZE_VAR, NODES_VAR, HELPER_CPUS_VAR};
+    const int wiring_count = sizeof(wiring) / sizeof(wiring[0]);
+    char* values[sizeof(wiring) / sizeof(wiring[0])];
+
+    for (int i = 0; i < wiring_count; i++) {
+        values[i] = getenv(wiring[i]) != NULL ? strdup(getenv(wiring[i])) : NULL;
+    }
+
+    for (int i = 0; i < JOB_DESCRIPTORS; i++) {
+        ASSERT_SYS_OK(dup2(descriptors[i], i));
+        ASSERT_SYS_OK(close(descriptors[i]));
+    }
+
+    char* cwd = strings;
+    char** args = (char**)calloc(header->argc + 1, sizeof(char*));
+    ASSERT_MALLOC(args);
+
+    char* string = cwd + strlen(cwd) + 1;
+    for (int i = 0; i < header->argc; i++, string += strlen(string) + 1) {
+        args[i] = string;
+    }
+
+    ASSERT_SYS_OK(clearenv());
+    for (int i = 0; i < header->envc; i++, string += strlen(string) + 1) {
+        ASSERT_ZERO(putenv(string));
+    }
+
+    for (int i = 0; i < wiring_count; i++) {
+        if (values[i] != NULL) {
+            ASSERT_SYS_OK(setenv(wiring[i], values[i], 1));
+        }
+        else {
+            ASSERT_SYS_OK(unsetenv(wiring[i]));
+        }
+    }
+    ASSERT_SYS_OK(unsetenv(TRACE_DIR_VAR));
+
+    if (chdir(cwd) != 0) {
+        syserr("Entering %s failed", cwd);
+    }
+    execvp(args[0], args);
+    syserr("Executing %s failed", args[0]);
+}
+
+
+/// @brief Starts a pool of warm ranks, wired and waiting for a job.
+///
+/// Every rank keeps its channels and waits for a job on a socket of its own,
+/// exiting once the socket is closed without one.
+///
+/// @param n - number of ranks of the pool.
+/// @param hostfile - path of the hostfile, NULL if there is none.
+/// @param pipe_size - capacity requested for pipes, 0 for the default one.
+/// @param topo - CPUs ranks are bound to.
+/// @param bind_to - sets of CPUs ranks are bound to.
+/// @param map_by - order of placing ranks on the CPUs.
+/// @param pids - filled with ids of the ranks.
+/// @param controls - filled with descriptors of the sockets the ranks wait for a job on.
+static void prepare_pool(
+    const int n,
+    const char* hostfile,
+    const int pipe_size,
+    const topology* topo,
+    const binding bind_to,
+    const mapping map_by,
+    pid_t* pids,
+    int* controls
+) {
+    // The daemon keeps its descriptors above those of channels, which are wired at fixed numbers.
+    const int control_descriptor = shared_memory_descriptor(n) + 1;
+    wire_channels(n, hostfile, pipe_size, n + JOB_DESCRIPTORS + 2);
+
+    for (int i = 0; i < n; i++) {
+        int sockets[2];
+        ASSERT_SYS_OK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets));
+        controls[i] = fcntl(sockets[0], F_DUPFD_CLOEXEC, control_descriptor);
+        ASSERT_SYS_OK(controls[i]);
+        ASSERT_SYS_OK(close(sockets[0]));
+
+        const pid_t pid = fork();
+        ASSERT_SYS_OK(pid);
+
+        if (pid == 0) {
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+
+            // Descriptors of the daemon, including sockets of other ranks, are not needed by the rank.
+            ASSERT_SYS_OK(dup3(sockets[1], control_descriptor, O_CLOEXEC));
+            ASSERT_SYS_OK(close(sockets[1]));
+            ASSERT_SYS_OK(close_range(control_descriptor + 1, ~0U, 0));
+
+            char pid_rank[40], rank[12];
+            ASSERT_SPRINTF(sprintf(pid_rank, "MIMPI_PID_RANK %d", getpid()));
+            ASSERT_SPRINTF(sprintf(rank, "%d", i));
+            ASSERT_SYS_OK(setenv(pid_rank, rank, 1));
+
+            keep_own_channels(n, i);
+            close_other_channels(n, i);
+
+            if (bind_to != BIND_NONE) {
+                bind_rank(topo, bind_to, map_by, i);
+            }
+
+            job_header header;
+            char* strings;
+            int descriptors[JOB_DESCRIPTORS];
+            if (receive_job(control_descriptor, &header, &strings, descriptors) != JOB_RECEIVED) {
+                _exit(0);
+            }
+            exec_job(&header, strings, descriptors, pid_rank);
+        }
+
+        ASSERT_SYS_OK(close(sockets[1]));
+        pids[i] = pid;
+    }
+
+    release_channels(n);
+}
+
+
+/// @brief Removes the socket of the daemon and quits, on SIGINT or SIGTERM.
+///
+/// Warm ranks exit by themselves, once their sockets are closed.
+static void stop_daemon(
+    int signal
+) {
+    (void)signal;
+    unlink(daemon_socket_path);
+    _exit(0);
+}
+
+
+/// @brief Runs jobs submitted through a socket on pools of ranks wired in advance.
+///
+/// Jobs run one at a time; the pool of the next job is prepared as soon as one finishes,
+/// while the daemon waits for a submission, so that a job only waits for its ranks to exec its program.
+/// Closing the connection of a client tells it its job has finished.
+///
+/// @param path - path of the socket jobs are submitted to.
+/// @param n - number of ranks of every job.
+/// @param hostfile - path of the hostfile, NULL if there is none.
+/// @param pipe_size - capacity requested for pipes, 0 for the default one.
+/// @param topo - CPUs ranks are bound to.
+/// @param bind_to - sets of CPUs ranks are bound to.
+/// @param map_by - order of placing ranks on the CPUs.
+_Noreturn static void run_daemon(
+    const char* path,
+    const int n,
+    const char* hostfile,
+    const int pipe_size,
+    const topology* topo,
+    const binding bind_to,
+    const mapping map_by
+) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fatal("Path of the socket %s is too long", path);
+    }
+    strcpy(address.sun_path, path);
+
+    const int daemon_descriptor = shared_memory_descriptor(n) + 1;
+    const int socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_SYS_OK(socket_fd);
+    if (bind(socket_fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        syserr("Binding the socket %s failed", path);
+    }
+    ASSERT_SYS_OK(listen(socket_fd, SOMAXCONN));
+    const int listener = fcntl(socket_fd, F_DUPFD_CLOEXEC, daemon_descriptor);
+    ASSERT_SYS_OK(listener);
+    ASSERT_SYS_OK(close(socket_fd));
+
+    daemon_socket_path = path;
+    struct sigaction action = {.sa_handler = stop_daemon};
+    ASSERT_SYS_OK(sigemptyset(&action.sa_mask));
+    ASSERT_SYS_OK(sigaction(SIGINT, &action, NULL));
+    ASSERT_SYS_OK(sigaction(SIGTERM, &action, NULL));
+
+    pid_t* pids = (pid_t*)malloc(n * sizeof(pid_t));
+    int* controls = (int*)malloc(n * sizeof(int));
+    ASSERT_MALLOC(pids);
+    ASSERT_MALLOC(controls);
+
+    prepare_pool(n, hostfile, pipe_size, topo, bind_to, map_by, pids, controls);
+
+    while (true) {
+        const int accepted = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+        if (accepted < 0 && errno == EINTR) continue;
+        ASSERT_SYS_OK(accepted);
+
+        // Warm ranks forked later must not hold the connection, which the client waits to be closed.
+        const int client = fcntl(accepted, F_DUPFD_CLOEXEC, daemon_descriptor);
+        ASSERT_SYS_OK(client);
+        ASSERT_SYS_OK(close(accepted));
+
+        // A client which stalls, or is not trusted, must not keep the daemon from the next one.
+        const struct timeval timeout = {.tv_sec = JOB_SUBMIT_TIMEOUT};
+        ASSERT_SYS_OK(setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+
+        job_header header;
+        char* strings;
+        int descriptors[JOB_DESCRIPTORS];
+        if (!trusted_client(client) || receive_job(client, &header, &strings, descriptors) != JOB_RECEIVED) {
+            ASSERT_SYS_OK(close(client));
+            continue;
+        }
+
+        for (int i = 0; i < n; i++) {
+            send_job(controls[i], &header, strings, descriptors);
+            ASSERT_SYS_OK(close(controls[i]));
+        }
+        for (int i = 0; i < JOB_DESCRIPTORS; i++) {
+            ASSERT_SYS_OK(close(descriptors[i]));
+        }
+        free(strings);
+
+        for (int i = 0; i < n; i++) {
+            while (waitpid(pids[i], NULL, 0) < 0) {
+                if (errno != EINTR) syserr("Waiting for rank %d failed", i);
+            }
+        }
+        ASSERT_SYS_OK(close(client));
+
+        prepare_pool(n, hostfile, pipe_size, topo, bind_to, map_by, pids, controls);
+    }
+}
+
+
+/// @brief Submits a job to a daemon and waits for it to finish.
+///
+/// The job runs with the standard descriptors, working directory and environment of the client.
+///
+/// @param path - path of the socket of the daemon.
+/// @param argc - number of arguments of the job, the program first.
+/// @param argv - arguments of the job.
+static void submit_job(
+    const char* path,
+    const int argc,
+    char** argv
+) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fatal("Path of the socket %s is too long", path);
+    }
+    strcpy(address.sun_path, path);
+
+    const int daemon_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_SYS_OK(daemon_fd);
+    if (connect(daemon_fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        syserr("Connecting to the daemon at %s failed", path);
+    }
+
+    char* cwd = getcwd(NULL, 0);
+    ASSERT_MALLOC(cwd);
+
+    job_header header = {.argc = argc, .envc = 0, .length = strlen(cwd) + 1};
+    for (int i = 0; i < argc; i++) {
+        header.length += strlen(argv[i]) + 1;
+    }
+    for (char** variable = environ; *variable != NULL; variable++, header.envc++) {
+        header.length += strlen(*variable) + 1;
+    }
+
+    char* strings = (char*)malloc(header.length);
+    ASSERT_MALLOC(strings);
+    char* end = stpcpy(strings, cwd) + 1;
+    for (int i = 0; i < argc; i++) {
+        end = stpcpy(end, argv[i]) + 1;
+    }
+    for (char** variable = environ; *variable != NULL; variable++) {
+        end = stpcpy(end, *variable) + 1;
+    }
+
+    const int descriptors[JOB_DESCRIPTORS] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    send_job(daemon_fd, &header, strings, descriptors);
+    free(strings);
+    free(cwd);
+
+    // The daemon never writes back, it closes the connection once all ranks have exited.
+    char byte;
+    while (read_all(daemon_fd, &byte, 1)) {}
+    ASSERT_SYS_OK(close(daemon_fd));
+}
+
+
+int main(int argc, char** argv) {
+    binding bind = getenv(BIND_TO_VAR) != NULL ? parse_binding(getenv(BIND_TO_VAR)) : BIND_NONE;
+    mapping map = getenv(MAP_BY_VAR) != NULL ? parse_mapping(getenv(MAP_BY_VAR)) : MAP_CORE;
+    int pipe_size = getenv(PIPE_SIZE_VAR) != NULL ? parse_pipe_size(getenv(PIPE_SIZE_VAR)) : 0;
+    const char* hostfile = getenv(HOSTFILE_VAR);
+    const char* daemon_path = NULL;
+    const char* submit_path = NULL;
+
+    static const struct option options[] = {
+        {"bind-to", required_argument, NULL, 'b'},
+        {"map-by", required_argument, NULL, 'm'},
+        {"pipe-size", required_argument, NULL, 'p'},
+        {"hostfile", required_argument, NULL, 'h'},
+        {"daemon", required_argument, NULL, 'd'},
+        {"submit", required_argument, NULL, 's'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "+", options, NULL)) != -1) {
+        if (option == 'b') {
+            bind = parse_binding(optarg);
+        }
+        else if (option == 'm') {
+            map = parse_mapping(optarg);
+        }
+        else if (option == 'p') {
+            pipe_size = parse_pipe_size(optarg);
+        }
+        else if (option == 'h') {
+            hostfile = optarg;
+        }
+        else if (option == 'd') {
+            daemon_path = optarg;
+        }
+        else if (option == 's') {
+            submit_path = optarg;
+        }
+        else {
+            optind = argc;
+            break;
+        }
+    }
+
+    if (submit_path != NULL && argc - optind >= 1) {
+        submit_job(submit_path, argc - optind, argv + optind);
+        return 0;
+    }
+
+    if (argc - optind < (daemon_path != NULL ? 1 : 2) || submit_path != NULL) {
+        fatal(
+            "Usage: %s [--bind-to core|socket|none] [--map-by core|socket] [--pipe-size BYTES] [--hostfile FILE] n prog [args...]\n"
+            "       %s [--bind-to core|socket|none] [--map-by core|socket] [--pipe-size BYTES] [--hostfile FILE] --daemon SOCKET n\n"
+            "       %s --submit SOCKET prog [args...]",
+            argv[0], argv[0], argv[0]
+        );
+    }
+
+    const int n = atoi(argv[optind]);
+    if (n < 1) {
+        fatal("Number of processes must be positive, got %s", argv[optind]);
+    }
+
+    ASSERT_SYS_OK(setenv("MIMPI_SIZE", argv[optind], 0));
+
+    topology topo;
+    if (bind != BIND_NONE) {
+        read_topology(&topo);
+    }
+
+    if (daemon_path != NULL) {
+        run_daemon(daemon_path, n, hostfile, pipe_size, &topo, bind, map);
+    }
+
+    const char* prog = argv[optind + 1];
+
+    const char* trace_path = getenv(TRACE_VAR);
+    char trace_directory[] = "/tmp/mimpi_trace.XXXXXX";
+    unsigned long long epoch = 0;
+
+    if (trace_path != NULL) {
+        if (mkdtemp(trace_directory) == NULL) {
+            syserr("Creating a directory for traces failed");
+        }
+        ASSERT_SYS_OK(setenv(TRACE_DIR_VAR, trace_directory, 1));
+        epoch = monotonic_clock();
+    }
+
+    wire_channels(n, hostfile, pipe_size, 0);
+
     for (int i = 0; i < n; i++) {
         const pid_t pid = fork();
 
@@ -35,32 +1399,26 @@ int main(int argc, char** argv) {
 
             ASSERT_SYS_OK(setenv(pid_rank, rank, 0));
 
-            for (int receiver = 0; receiver < n; receiver++) {
-                for (int sender = 0; sender < n; sender++) {
-                    if (receiver == sender) continue;
-                    
-                    int fd_num = calculate_file_descriptor(n, receiver, sender);
-                    
-                    if (receiver != i)
-                        ASSERT_SYS_OK(close(fd_num));
-                    if (sender != i)
-                        ASSERT_SYS_OK(close(fd_num + 1));
-                }
+            keep_own_channels(n, i);
+
+            if (bind != BIND_NONE) {
+                bind_rank(&topo, bind, map, i);
             }
 
-            ASSERT_SYS_OK(execvp(prog, argv + 2));
+            ASSERT_SYS_OK(execvp(prog, argv + optind + 1));
         }
     }
 
-    for (int i = 0, nr = FIRST_AVAILABLE_DESCRIPTOR; i < n * (n-1); i++, nr += 2) {
-        ASSERT_SYS_OK(close(nr));
-        ASSERT_SYS_OK(close(nr + 1));
-    }
+    release_channels(n);
     
     for (int i = 0; i < n; i++) {
         ASSERT_SYS_OK(wait(NULL));
     }
 
+    if (trace_path != NULL) {
+        merge_traces(trace_path, trace_directory, n, epoch);
+    }
+
     ASSERT_SYS_OK(clearenv());
 
     return 0;
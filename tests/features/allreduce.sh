@@ -0,0 +1,5 @@
+#!/bin/bash
+set -ex
+for n in 1 2 3 4 5 7 8 13 16; do
+    ./run_test 5 $n examples_build/allreduce
+done
@@ -0,0 +1,15 @@
+#!/bin/bash
+set -ex
+./run_test 10 1 examples_build/alltoall
+./run_test 10 2 examples_build/alltoall
+./run_test 10 5 examples_build/alltoall
+./run_test 10 8 examples_build/alltoall
+./run_test 10 12 examples_build/alltoall
+./run_test 10 16 examples_build/alltoall
+./run_test 10 4 examples_build/alltoall 0
+./run_test 20 8 examples_build/alltoall 200000
+./run_test 20 6 examples_build/alltoall 200000
+MIMPI_EAGER_LIMIT=0 ./run_test 10 8 examples_build/alltoall
+MIMPI_EAGER_LIMIT=1024 ./run_test 20 7 examples_build/alltoall 100000
+MIMPI_TRANSPORT=shm ./run_test 10 9 examples_build/alltoall
+MIMPI_COALESCE_SIZE=4096 ./run_test 10 8 examples_build/alltoall
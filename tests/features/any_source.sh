@@ -0,0 +1,16 @@
+#!/bin/bash
+set -ex
+./run_test 10 2 examples_build/any_source
+./run_test 10 5 examples_build/any_source
+./run_test 10 9 examples_build/any_source
+./run_test 10 16 examples_build/any_source
+./run_test 10 4 examples_build/any_source 0
+./run_test 10 6 examples_build/any_source 64 any_tag
+./run_test 20 4 examples_build/any_source 100000
+MIMPI_EAGER_LIMIT=0 ./run_test 10 6 examples_build/any_source
+MIMPI_EAGER_LIMIT=1024 ./run_test 20 5 examples_build/any_source 50000 any_tag
+MIMPI_TRANSPORT=shm ./run_test 10 7 examples_build/any_source
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 7 examples_build/any_source
+MIMPI_COALESCE_SIZE=4096 ./run_test 10 6 examples_build/any_source
+./run_test 10 5 examples_build/any_source 64 detect
+MIMPI_DEADLOCK_TIMEOUT=0 ./run_test 10 4 examples_build/any_source 64 any_tag detect
@@ -0,0 +1,21 @@
+#!/bin/bash
+set -ex
+for algorithm in binomial dissemination kary:2 kary:4 kary:32; do
+    export MIMPI_BARRIER_ALGORITHM=$algorithm
+    ./run_test 10 1 examples_build/barrier
+    ./run_test 10 3 examples_build/barrier
+    ./run_test 10 8 examples_build/barrier
+    ./run_test 10 2 examples_build/barrier_remote_finish
+    ./run_test 10 7 examples_build/barrier_remote_finish
+    for rank in 0 5 15; do
+        ./run_test 2 16 examples_build/broken_barrier $rank
+    done
+    ./run_test 10 5 examples_build/persistent
+    # The timing gates of the default barrier hold for every algorithm.
+    for gate in tests/effectiveness/barrier_*.self; do
+        expected=`tail -n +2 $gate`
+        actual=`bash -c "$(head -n1 $gate)"`
+        [ "$expected" = "=====================================================================
+$actual" ]
+    done
+done
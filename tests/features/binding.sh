@@ -0,0 +1,12 @@
+#!/bin/bash
+set -ex
+MIMPI_BIND_TO=core ./run_test 5 4 examples_build/allreduce
+MIMPI_BIND_TO=core MIMPI_PROGRESS_ENGINE=epoll ./run_test 5 4 examples_build/nonblocking
+MIMPI_BIND_TO=socket MIMPI_MAP_BY=socket ./run_test 10 8 examples_build/threaded_recv
+MIMPI_BIND_TO=none ./run_test 5 4 examples_build/coalesce
+# Bound to a core, a rank may run on a single CPU only.
+test "$(./mimpirun --bind-to core --map-by socket 4 grep -c '^Cpus_allowed_list:[[:space:]]*[0-9]*$' /proc/self/status | grep -c '^1$')" = 4
+# Without binding, ranks inherit the CPUs of mimpirun.
+test "$(./mimpirun --bind-to none 2 grep Cpus_allowed_list /proc/self/status | sort -u)" = "$(grep Cpus_allowed_list /proc/self/status)"
+! ./mimpirun --bind-to everything 2 true
+! ./mimpirun --map-by node 2 true
@@ -0,0 +1,23 @@
+#!/bin/bash
+set -ex
+./run_test 2 3 examples_build/buffered_send
+
+for buffer in 4096 1048576; do
+    export MIMPI_SEND_BUFFER=$buffer
+    ./run_test 4 3 examples_build/buffered_send
+    ./run_test 0.4 16 examples_build/send_recv
+    ./run_test 10s 2 examples_build/order_of_msg
+    ./run_test 5 2 examples_build/big_message
+    ./run_test 10 4 examples_build/nonblocking
+    ./run_test 10 8 examples_build/threaded_recv
+    ./run_test 10 5 examples_build/alltoall 200000
+    ./run_test 10 2 examples_build/stream
+    ./run_test 1 4 examples_build/recv_remote_finish
+    ./run_test 1 4 examples_build/deadlock
+    MIMPI_EAGER_LIMIT=65536 ./run_test 10 5 examples_build/rendezvous
+    MIMPI_COALESCE_SIZE=4096 ./run_test 5 4 examples_build/coalesce
+    MIMPI_PROGRESS_ENGINE=epoll ./run_test 4 3 examples_build/buffered_send
+    MIMPI_TRANSPORT=shm ./run_test 4 3 examples_build/buffered_send
+    MIMPI_TRANSPORT=tcp ./run_test 4 3 examples_build/buffered_send
+    CHANNELS_READ_DELAY=1 ./run_test 10 2 examples_build/send_any_size 200000 0 1
+done
@@ -0,0 +1,15 @@
+#!/bin/bash
+set -ex
+./run_test 5 4 examples_build/coalesce
+export MIMPI_COALESCE_SIZE=4096
+./run_test 5 2 examples_build/coalesce
+./run_test 10 8 examples_build/coalesce
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 8 examples_build/coalesce
+MIMPI_TRANSPORT=shm ./run_test 10 8 examples_build/coalesce
+MIMPI_COALESCE_SIZE=10 ./run_test 10 4 examples_build/coalesce
+MIMPI_EAGER_LIMIT=1024 ./run_test 10 4 examples_build/rendezvous
+./run_test 10 4 examples_build/nonblocking
+./run_test 10 8 examples_build/threaded_recv
+./run_test 10 16 examples_build/allreduce
+./run_test 5 16 examples_build/broadcast1 5
+./run_test 1 4 examples_build/deadlock
@@ -0,0 +1,13 @@
+#!/bin/bash
+set -ex
+./run_test 10 1 examples_build/comm_split
+./run_test 10 2 examples_build/comm_split
+./run_test 10 7 examples_build/comm_split
+./run_test 10 16 examples_build/comm_split
+./run_test 10 13 examples_build/comm_split 3
+./run_test 10 12 examples_build/comm_split 5
+MIMPI_BARRIER_ALGORITHM=kary:2 ./run_test 10 9 examples_build/comm_split 3
+MIMPI_BARRIER_ALGORITHM=dissemination ./run_test 10 10 examples_build/comm_split 3
+MIMPI_EAGER_LIMIT=0 ./run_test 10 8 examples_build/comm_split
+MIMPI_RELAXED_COLLECTIVES=1 ./run_test 10 16 examples_build/comm_split
+MIMPI_TRANSPORT=shm ./run_test 10 6 examples_build/comm_split 2
@@ -0,0 +1,20 @@
+#!/bin/bash
+set -ex
+./run_test 2 4 examples_build/compression
+
+export MIMPI_COMPRESS_THRESHOLD=4096
+./run_test 2 4 examples_build/compression 100000 1
+./run_test 2 2 examples_build/compression 4096 1
+./run_test 2 2 examples_build/compression 4095
+./run_test 5 3 examples_build/compression 3000000 1
+MIMPI_EAGER_LIMIT=65536 ./run_test 5 3 examples_build/compression 1000000 1
+MIMPI_COALESCE_SIZE=65536 ./run_test 2 4 examples_build/compression 8192 1
+MIMPI_SPLICE_THRESHOLD=65536 ./run_test 5 2 examples_build/compression 1000000 1
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 5 4 examples_build/compression 1000000 1
+MIMPI_TRANSPORT=shm ./run_test 5 4 examples_build/compression 1000000 1
+MIMPI_TRANSPORT=tcp ./run_test 5 4 examples_build/compression 1000000 1
+./run_test 10 5 examples_build/alltoall 200000
+./run_test 10 4 examples_build/reduce_any_size 100000 3 >/dev/null
+./run_test 10 2 examples_build/stream
+./run_test 1 4 examples_build/recv_remote_finish
+CHANNELS_WRITE_DELAY=1 ./run_test 10 2 examples_build/send_any_size 200000 0 1
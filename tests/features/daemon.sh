@@ -0,0 +1,83 @@
+#!/bin/bash
+set -ex
+workdir=$(mktemp -d)
+socket="$workdir/mimpi.sock"
+output="$workdir/output"
+
+# Jobs run on warm ranks of a daemon; checked like ./run_test does.
+submit() {
+    local workers=$1
+    shift
+    timeout 10 ./mimpirun --submit "$socket" "$@" 2> "$output"
+    test "$(grep -c '<<success>>' "$output")" -eq "$workers"
+    ! grep -q '<<error>>' "$output"
+}
+
+start_daemon() {
+    ./mimpirun --daemon "$socket" "$1" 2> "$workdir/daemon.log" &
+    daemon=$!
+    trap 'kill $daemon; rm -rf "$workdir"' EXIT
+    while [ ! -S "$socket" ]; do sleep 0.01; done
+}
+
+stop_daemon() {
+    kill "$daemon"
+    wait "$daemon" || true
+    trap 'rm -rf "$workdir"' EXIT
+    test ! -e "$socket"
+}
+
+start_daemon 4
+submit 4 examples_build/hello
+submit 4 examples_build/send_recv
+submit 4 examples_build/all_my_file_desc
+submit 4 examples_build/reduce 3
+MIMPI_PROGRESS_ENGINE=epoll submit 4 examples_build/allreduce
+submit 4 examples_build/alltoall
+submit 4 examples_build/deadlock
+
+# Jobs take the working directory, environment and standard descriptors of the client.
+test "$(./mimpirun --submit "$socket" sh -c 'echo $MIMPI_SIZE' | sort -u)" = 4
+test "$(cd "$workdir" && MIMPI_TEST_VALUE=job "$OLDPWD/mimpirun" --submit "$socket" sh -c 'echo "$PWD $MIMPI_TEST_VALUE"' | sort -u)" = "$workdir job"
+echo input | ./mimpirun --submit "$socket" sh -c 'cat' > "$output"
+test "$(grep -c input "$output")" -eq 1
+
+# Malformed submissions are rejected without stopping the daemon: junk without descriptors,
+# an absurd length of strings, and strings holding fewer entries than the header promises.
+reject() {
+    python3 -c '
+import socket, struct, sys
+client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+client.connect(sys.argv[1])
+header, strings = bytes.fromhex(sys.argv[2]), bytes.fromhex(sys.argv[3])
+try:
+    if strings:
+        socket.send_fds(client, [header], [0, 1, 2])
+        client.sendall(strings)
+    else:
+        client.sendall(header)
+    client.shutdown(socket.SHUT_WR)
+    client.recv(1)
+except (BrokenPipeError, ConnectionResetError):
+    pass  # The daemon has rejected the job already.
+' "$socket" "$@"
+    grep -q 'Rejected a job' "$workdir/daemon.log"
+    : > "$workdir/daemon.log"
+}
+reject "$(printf '%032x' 1)" ""
+reject "$(python3 -c 'import struct; print(struct.pack("iiQ", 1, 0, 1 << 40).hex())')" 2f00
+reject "$(python3 -c 'import struct; print(struct.pack("iiQ", 2, 0, 4).hex())')" 2f006100
+submit 4 examples_build/hello
+stop_daemon
+
+MIMPI_TRANSPORT=shm start_daemon 8
+submit 8 examples_build/broadcast1 3
+submit 8 examples_build/reduce_any_size 100000 3 > /dev/null
+stop_daemon
+
+MIMPI_TRANSPORT=tcp start_daemon 8
+submit 8 examples_build/send_recv
+stop_daemon
+
+# Without a daemon, submitting fails.
+! ./mimpirun --submit "$socket" true 2> /dev/null
@@ -0,0 +1,11 @@
+#!/bin/bash
+set -ex
+./run_test 5 4 examples_build/deadlock_log
+for timeout in 0 1 50; do
+    export MIMPI_DEADLOCK_TIMEOUT=$timeout
+    ./run_test 5 4 examples_build/deadlock_log
+    ./run_test 5 2 examples_build/deadlock3
+    ./run_test 5 4 examples_build/deadlock
+done
+MIMPI_COALESCE_SIZE=4096 ./run_test 5 4 examples_build/deadlock_log
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 5 4 examples_build/deadlock_log
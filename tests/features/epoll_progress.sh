@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+export MIMPI_PROGRESS_ENGINE=epoll
+./run_test 0.4 16 examples_build/send_recv
+./run_test 1 4 examples_build/recv_remote_finish
+./run_test 1 4 examples_build/deadlock
+./run_test 10s 2 examples_build/order_of_msg
+./run_test 2 16 examples_build/broadcast1 5
+./run_test 2 16 examples_build/reduce 7
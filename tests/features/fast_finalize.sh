@@ -0,0 +1,13 @@
+#!/bin/bash
+set -ex
+MIMPI_FAST_FINALIZE=1 ./run_test 10 1 examples_build/fast_finalize 0
+MIMPI_FAST_FINALIZE=1 ./run_test 10 2 examples_build/fast_finalize
+MIMPI_FAST_FINALIZE=1 ./run_test 10 8 examples_build/fast_finalize
+MIMPI_FAST_FINALIZE=1 ./run_test 10 16 examples_build/fast_finalize 500
+MIMPI_FAST_FINALIZE=1 MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 8 examples_build/fast_finalize
+MIMPI_FAST_FINALIZE=1 MIMPI_TRANSPORT=shm ./run_test 10 8 examples_build/fast_finalize
+MIMPI_FAST_FINALIZE=1 MIMPI_SEND_BUFFER=65536 ./run_test 10 5 examples_build/fast_finalize
+./run_test 10 4 examples_build/fast_finalize 100
+MIMPI_FAST_FINALIZE=1 ./run_test 10 4 examples_build/recv_remote_finish
+MIMPI_FAST_FINALIZE=1 ./run_test 10 4 examples_build/send_remote_finish
+MIMPI_FAST_FINALIZE=1 ./run_test 10 6 examples_build/lot_of_messages
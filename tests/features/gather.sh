@@ -0,0 +1,14 @@
+#!/bin/bash
+set -ex
+./run_test 10 1 examples_build/gather
+./run_test 10 2 examples_build/gather
+./run_test 10 5 examples_build/gather
+./run_test 10 8 examples_build/gather
+./run_test 10 13 examples_build/gather
+./run_test 10 16 examples_build/gather
+./run_test 10 6 examples_build/gather 0
+./run_test 20 5 examples_build/gather 300000
+MIMPI_RELAXED_COLLECTIVES=1 ./run_test 10 7 examples_build/gather
+MIMPI_EAGER_LIMIT=0 ./run_test 10 6 examples_build/gather
+MIMPI_BCAST_SEGMENT=16 ./run_test 10 4 examples_build/gather
+MIMPI_TRANSPORT=shm ./run_test 10 9 examples_build/gather
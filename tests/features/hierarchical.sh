@@ -0,0 +1,24 @@
+#!/bin/bash
+set -ex
+hostfile=$(mktemp)
+trap 'rm -f "$hostfile"' EXIT
+
+printf '127.0.0.1 slots=2\n127.0.0.2 slots=3\n127.0.0.3 slots=3\n' > "$hostfile"
+export MIMPI_HOSTFILE="$hostfile"
+./run_test 2 8 examples_build/hierarchy 3
+./run_test 2 5 examples_build/hierarchy 2
+MIMPI_TRANSPORT=shm ./run_test 2 8 examples_build/hierarchy 3
+MIMPI_BARRIER_ALGORITHM=dissemination ./run_test 2 8 examples_build/barrier
+./run_test 2 8 examples_build/reduce_any_size 1000 3 >/dev/null
+./run_test 2 8 examples_build/comm_split
+./run_test 2 8 examples_build/comm_split 3
+./run_test 2 8 examples_build/gather
+./run_test 2 8 examples_build/persistent
+
+printf '127.0.0.1 slots=1\n127.0.0.2 slots=7\n' > "$hostfile"
+./run_test 2 8 examples_build/hierarchy 2
+./run_test 2 8 examples_build/broadcast1 7
+unset MIMPI_HOSTFILE
+
+# On a single node the trees stay flat.
+./run_test 2 4 examples_build/hierarchy 1
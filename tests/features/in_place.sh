@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+./run_test 1 1 examples_build/in_place
+./run_test 2 2 examples_build/in_place 1000 1
+./run_test 2 5 examples_build/in_place 1000 3
+./run_test 4 16 examples_build/in_place 100000 0
+./run_test 4 16 examples_build/in_place 7 11
+MIMPI_RELAXED_COLLECTIVES=1 ./run_test 4 9 examples_build/in_place 100000 4
+./run_test 4 8 examples_build/reduce_any_size 100000 5 >/dev/null
@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+# Readers of a process wait for their delayed links at the same time (about 9 s when serialised).
+CHANNELS_READ_DELAY=100 ./run_test 6 8 examples_build/alltoall 1
+CHANNELS_LATENCY=200 CHANNELS_BANDWIDTH=100 ./run_test 10 5 examples_build/send_recv
+CHANNELS_LINKS='*-0=1000/10,3-*=50/0' ./run_test 10 6 examples_build/allreduce
+CHANNELS_LATENCY=100 MIMPI_TRANSPORT=shm ./run_test 10 4 examples_build/broadcast
+# Malformed links are rejected.
+CHANNELS_LINKS='0-1=100' ./mimpirun 2 examples_build/hello 2>&1 | grep -q malformed
@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+./run_test 2 2 examples_build/nonblocking
+./run_test 2 4 examples_build/nonblocking
+./run_test 4 16 examples_build/nonblocking
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 4 16 examples_build/nonblocking
+MIMPI_TRANSPORT=shm ./run_test 4 16 examples_build/nonblocking
+CHANNELS_WRITE_DELAY=1 ./run_test 10 4 examples_build/nonblocking
+./run_test 2 4 examples_build/send_recv
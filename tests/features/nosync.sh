@@ -0,0 +1,10 @@
+#!/bin/bash
+set -ex
+./run_test 2 2 examples_build/nosync
+./run_test 2 5 examples_build/nosync
+./run_test 4 16 examples_build/nosync
+export MIMPI_RELAXED_COLLECTIVES=1
+./run_test 4 16 examples_build/nosync
+./run_test 2 16 examples_build/broadcast1 5
+./run_test 2 16 examples_build/reduce 7
+./run_test 5 13 examples_build/allreduce
@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+./run_test 10 1 examples_build/persistent
+./run_test 10 2 examples_build/persistent
+./run_test 10 5 examples_build/persistent
+./run_test 10 8 examples_build/persistent
+MIMPI_RELAXED_COLLECTIVES=1 ./run_test 10 6 examples_build/persistent
+MIMPI_COALESCE_SIZE=4096 ./run_test 10 8 examples_build/persistent
+MIMPI_BCAST_SEGMENT=16 ./run_test 10 4 examples_build/persistent
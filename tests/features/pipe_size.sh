@@ -0,0 +1,13 @@
+#!/bin/bash
+set -ex
+max_size=$(cat /proc/sys/fs/pipe-max-size)
+./run_test 5 3 examples_build/pipe_size 65536
+MIMPI_PIPE_SIZE=262144 ./run_test 5 4 examples_build/pipe_size 262144
+MIMPI_PIPE_SIZE=262144 MIMPI_TRANSPORT=shm ./run_test 5 4 examples_build/pipe_size 262144
+# The kernel rounds capacities up to a power of two pages, and mimpirun caps them at the system limit.
+MIMPI_PIPE_SIZE=300000 ./run_test 5 2 examples_build/pipe_size 524288
+MIMPI_PIPE_SIZE=$((max_size * 4)) ./run_test 5 2 examples_build/pipe_size "$max_size"
+# The option takes precedence over the variable.
+MIMPI_PIPE_SIZE=262144 ./mimpirun --pipe-size 131072 3 examples_build/pipe_size 131072 | grep -c "Pipe size OK" | grep -q '^3$'
+! ./mimpirun --pipe-size 0 2 true
+! ./mimpirun --pipe-size 64k 2 true
@@ -0,0 +1,13 @@
+#!/bin/bash
+set -ex
+./run_test 10 2 examples_build/probe
+./run_test 10 5 examples_build/probe
+./run_test 10 9 examples_build/probe
+./run_test 10 16 examples_build/probe
+./run_test 10 4 examples_build/probe 1
+./run_test 20 4 examples_build/probe 40000
+MIMPI_EAGER_LIMIT=0 ./run_test 10 6 examples_build/probe
+MIMPI_EAGER_LIMIT=512 ./run_test 20 5 examples_build/probe 5000
+MIMPI_TRANSPORT=shm ./run_test 10 7 examples_build/probe
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 7 examples_build/probe
+MIMPI_COALESCE_SIZE=4096 ./run_test 10 6 examples_build/probe
@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+MIMPI_REDUCE_SEGMENT=0 ./run_test 4 8 examples_build/reduce_any_size 100000 3 >/dev/null
+MIMPI_REDUCE_SEGMENT=1 ./run_test 4 5 examples_build/reduce_typed 3
+MIMPI_REDUCE_SEGMENT=12 ./run_test 4 16 examples_build/reduce_typed 11
+MIMPI_REDUCE_SEGMENT=4096 ./run_test 4 8 examples_build/reduce_any_size 100000 5 >/dev/null
+MIMPI_REDUCE_SEGMENT=4096 ./run_test 4 7 examples_build/in_place 100000 4
+MIMPI_REDUCE_SEGMENT=100 ./run_test 4 6 examples_build/persistent
+MIMPI_REDUCE_SEGMENT=100 MIMPI_TRANSPORT=shm ./run_test 4 9 examples_build/reduce_any_size 10000 3 >/dev/null
@@ -0,0 +1,7 @@
+#!/bin/bash
+set -ex
+./run_test 1 1 examples_build/reduce_typed 0
+./run_test 1 2 examples_build/reduce_typed 1
+./run_test 2 5 examples_build/reduce_typed 3
+./run_test 4 16 examples_build/reduce_typed 0
+./run_test 4 16 examples_build/reduce_typed 11
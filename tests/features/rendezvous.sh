@@ -0,0 +1,17 @@
+#!/bin/bash
+set -ex
+export MIMPI_EAGER_LIMIT=65536
+./run_test 5 2 examples_build/rendezvous
+./run_test 10 5 examples_build/rendezvous
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 5 examples_build/rendezvous
+MIMPI_TRANSPORT=shm ./run_test 10 5 examples_build/rendezvous
+MIMPI_RENDEZVOUS_BUFFER=2097152 ./run_test 10 5 examples_build/rendezvous
+MIMPI_RENDEZVOUS_BUFFER=0 ./run_test 5 2 examples_build/big_message
+./run_test 5 2 examples_build/big_message
+MIMPI_EAGER_LIMIT=100 ./run_test 0.4 7 examples_build/obstruction
+./run_test 5 16 examples_build/broadcast1 5
+./run_test 10 8 examples_build/allreduce
+./run_test 10 4 examples_build/nonblocking
+./run_test 10 8 examples_build/threaded_recv
+./run_test 1 4 examples_build/deadlock
+MIMPI_EAGER_LIMIT=0 ./run_test 10 4 examples_build/nonblocking
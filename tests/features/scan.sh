@@ -0,0 +1,12 @@
+#!/bin/bash
+set -ex
+./run_test 5 1 examples_build/scan
+./run_test 5 2 examples_build/scan
+./run_test 5 5 examples_build/scan
+./run_test 5 8 examples_build/scan
+./run_test 5 13 examples_build/scan 1
+./run_test 5 16 examples_build/scan 0
+./run_test 10 6 examples_build/scan 300000
+MIMPI_EAGER_LIMIT=0 ./run_test 5 7 examples_build/scan
+MIMPI_COALESCE_SIZE=4096 ./run_test 5 9 examples_build/scan
+MIMPI_TRANSPORT=shm ./run_test 5 11 examples_build/scan
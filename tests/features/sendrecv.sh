@@ -0,0 +1,11 @@
+#!/bin/bash
+set -ex
+./run_test 2 2 examples_build/sendrecv
+./run_test 2 5 examples_build/sendrecv 1
+./run_test 5 8 examples_build/sendrecv 1000000
+MIMPI_EAGER_LIMIT=65536 ./run_test 5 2 examples_build/sendrecv
+MIMPI_EAGER_LIMIT=65536 ./run_test 5 7 examples_build/sendrecv 1000000
+MIMPI_EAGER_LIMIT=0 ./run_test 5 4 examples_build/sendrecv 1
+MIMPI_PROGRESS_ENGINE=epoll MIMPI_EAGER_LIMIT=65536 ./run_test 5 6 examples_build/sendrecv
+MIMPI_TRANSPORT=shm MIMPI_EAGER_LIMIT=65536 ./run_test 5 6 examples_build/sendrecv
+MIMPI_SEND_BUFFER=65536 ./run_test 5 6 examples_build/sendrecv
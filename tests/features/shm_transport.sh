@@ -0,0 +1,13 @@
+#!/bin/bash
+set -ex
+export MIMPI_TRANSPORT=shm
+./run_test 0.4 16 examples_build/send_recv
+./run_test 0.4 2 examples_build/big_message
+./run_test 1 4 examples_build/recv_remote_finish
+./run_test 4s 10 examples_build/send_remote_finish
+./run_test 1 4 examples_build/deadlock
+./run_test 10s 2 examples_build/order_of_msg
+./run_test 1 16 examples_build/reduce_any_size 100000 3 >/dev/null
+MIMPI_SHM_RING_SIZE=1000 ./run_test 1 2 examples_build/big_message
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 2 16 examples_build/broadcast1 5
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 2 16 examples_build/reduce 7
@@ -0,0 +1,15 @@
+#!/bin/bash
+set -ex
+
+# Receives spin before blocking, messages arriving during the spin or after it have to be received alike.
+export MIMPI_SPIN_US=200
+./run_test 0.4 16 examples_build/send_recv
+./run_test 1 4 examples_build/recv_remote_finish
+./run_test 10s 2 examples_build/order_of_msg
+./run_test 2 4 examples_build/threaded_recv
+./run_test 2 4 examples_build/nonblocking
+./run_test 1 4 examples_build/deadlock
+MIMPI_TRANSPORT=shm ./run_test 2 16 examples_build/reduce 7
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 1 2 examples_build/big_message
+# The message arrives while the receive still spins.
+test "$(MIMPI_SPIN_US=2000000 timeout 4 ./mimpirun 2 examples_build/delayed_recv | grep -c Done)" -eq 2
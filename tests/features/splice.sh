@@ -0,0 +1,15 @@
+#!/bin/bash
+set -ex
+export MIMPI_SPLICE_THRESHOLD=65536
+./run_test 5 2 examples_build/big_message
+./run_test 10 2 examples_build/send_any_size 5000000 0 1
+./run_test 10 2 examples_build/send_any_size 65536 1 0
+./run_test 10 5 examples_build/alltoall 200000
+./run_test 10 4 examples_build/nonblocking
+./run_test 10 2 examples_build/stream
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 4 examples_build/alltoall 200000
+MIMPI_EAGER_LIMIT=65536 ./run_test 10 5 examples_build/rendezvous
+MIMPI_TRANSPORT=shm ./run_test 5 2 examples_build/big_message
+CHANNELS_WRITE_DELAY=1 ./run_test 10 2 examples_build/send_any_size 200000 0 1
+MIMPI_SPLICE_THRESHOLD=1 ./run_test 10 8 examples_build/broadcast1 5
+MIMPI_SPLICE_THRESHOLD=4096 ./run_test 10 8 examples_build/threaded_recv
@@ -0,0 +1,12 @@
+#!/bin/bash
+set -ex
+./run_test 5 4 examples_build/stats
+MIMPI_COALESCE_SIZE=4096 ./run_test 5 4 examples_build/stats
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 5 4 examples_build/stats
+output=$(mktemp -d)
+MIMPI_STATS_OUTPUT="$output" ./run_test 5 3 examples_build/stats
+test "$(ls "$output" | wc -l)" = 3
+for rank in 0 1 2; do
+    grep -q "^{\"rank\": $rank, \"size\": 3, \"messages_sent\": [0-9]*, .*\"peers\": \[{\"rank\": " "$output/mimpi_stats.$rank.json"
+done
+rm -r "$output"
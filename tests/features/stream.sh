@@ -0,0 +1,13 @@
+#!/bin/bash
+set -ex
+./run_test 10 2 examples_build/stream
+./run_test 10 5 examples_build/stream
+./run_test 10 4 examples_build/stream 0
+./run_test 10 2 examples_build/stream 1
+./run_test 10 2 examples_build/stream 1048576
+./run_test 20 2 examples_build/stream 40000000
+MIMPI_EAGER_LIMIT=0 ./run_test 10 4 examples_build/stream
+MIMPI_EAGER_LIMIT=100000 ./run_test 10 2 examples_build/stream
+MIMPI_TRANSPORT=shm ./run_test 10 4 examples_build/stream
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 4 examples_build/stream
+MIMPI_COALESCE_SIZE=4096 ./run_test 10 2 examples_build/stream
@@ -0,0 +1,37 @@
+#!/bin/bash
+set -ex
+hostfile=$(mktemp)
+stats=$(mktemp -d)
+trap 'rm -rf "$hostfile" "$stats"' EXIT
+
+MIMPI_TRANSPORT=tcp ./run_test 0.4 16 examples_build/send_recv
+MIMPI_TRANSPORT=tcp ./run_test 0.4 2 examples_build/big_message
+MIMPI_TRANSPORT=tcp ./run_test 1 4 examples_build/recv_remote_finish
+MIMPI_TRANSPORT=tcp ./run_test 4s 10 examples_build/send_remote_finish
+MIMPI_TRANSPORT=tcp ./run_test 1 4 examples_build/deadlock
+MIMPI_TRANSPORT=tcp ./run_test 10s 2 examples_build/order_of_msg
+MIMPI_TRANSPORT=tcp MIMPI_PROGRESS_ENGINE=epoll ./run_test 2 16 examples_build/reduce 7
+MIMPI_TRANSPORT=tcp MIMPI_SPLICE_THRESHOLD=4096 ./run_test 1 2 examples_build/big_message
+MIMPI_TRANSPORT=tcp MIMPI_STATS_OUTPUT="$stats" ./run_test 1 2 examples_build/hello
+grep -q '"send_pipe_size": 0' "$stats/mimpi_stats.0.json"
+
+# Two nodes on the loopback: channels between them are TCP connections, the others pipes or rings.
+printf '127.0.0.1 slots=2 # first node\n\n127.0.0.2 slots=3\n' > "$hostfile"
+export MIMPI_HOSTFILE="$hostfile"
+./run_test 1 5 examples_build/send_recv
+./run_test 2 5 examples_build/broadcast1 3
+./run_test 4s 5 examples_build/send_remote_finish
+MIMPI_TRANSPORT=shm ./run_test 2 5 examples_build/reduce_any_size 100000 3 >/dev/null
+MIMPI_TRANSPORT=shm ./run_test 1 4 examples_build/recv_remote_finish
+./run_test 5 2 examples_build/pipe_size 65536
+MIMPI_STATS_OUTPUT="$stats" ./run_test 1 5 examples_build/hello
+grep -q '"send_pipe_size": 0' "$stats/mimpi_stats.1.json"
+grep -q '"send_pipe_size": 65536' "$stats/mimpi_stats.1.json"
+unset MIMPI_HOSTFILE
+
+# Hosts have to be addresses of this machine, with enough slots for all ranks.
+! ./mimpirun --hostfile "$hostfile" 6 true
+echo "192.0.2.1" > "$hostfile"
+! ./mimpirun --hostfile "$hostfile" 1 true
+echo "127.0.0.1 slots=x" > "$hostfile"
+! ./mimpirun --hostfile "$hostfile" 1 true
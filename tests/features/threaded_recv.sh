@@ -0,0 +1,6 @@
+#!/bin/bash
+set -ex
+./run_test 5 2 examples_build/threaded_recv
+./run_test 10 8 examples_build/threaded_recv
+MIMPI_PROGRESS_ENGINE=epoll ./run_test 10 8 examples_build/threaded_recv
+MIMPI_TRANSPORT=shm ./run_test 10 8 examples_build/threaded_recv
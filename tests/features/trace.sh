@@ -0,0 +1,19 @@
+#!/bin/bash
+set -ex
+trace=$(mktemp)
+MIMPI_TRACE="$trace" ./run_test 5 4 examples_build/allreduce
+# Every traced call of every rank is in the timeline, with matching beginnings and ends.
+for rank in 0 1 2 3; do
+    grep -q "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": $rank, \"args\": {\"name\": \"rank $rank\"}}" "$trace"
+    grep -q "{\"name\": \"MIMPI_Send\", \"ph\": \"B\", \"ts\": [0-9.]*, \"pid\": $rank, " "$trace"
+    grep -q "{\"name\": \"dispatch\", \"ph\": \"E\", \"ts\": [0-9.]*, \"pid\": $rank, " "$trace"
+done
+test "$(grep -c '"ph": "B"' "$trace")" = "$(grep -c '"ph": "E"' "$trace")"
+grep -q '"args": {"name": "main"}' "$trace"
+grep -q '"args": {"name": "reader 1"}' "$trace"
+MIMPI_TRACE="$trace" MIMPI_PROGRESS_ENGINE=epoll ./run_test 5 4 examples_build/nonblocking
+grep -q '"args": {"name": "progress"}' "$trace"
+# A small ring keeps only the latest events of each thread.
+MIMPI_TRACE="$trace" MIMPI_TRACE_EVENTS=4 ./run_test 5 2 examples_build/nonblocking
+test "$(grep -c '"ph": "[BE]"' "$trace")" -le 16
+rm "$trace"
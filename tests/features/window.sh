@@ -0,0 +1,9 @@
+#!/bin/bash
+set -ex
+./run_test 5 1 examples_build/window
+./run_test 5 2 examples_build/window
+./run_test 5 5 examples_build/window
+./run_test 5 8 examples_build/window 1 1000
+./run_test 10 16 examples_build/window 100000 10
+MIMPI_TRANSPORT=shm ./run_test 5 7 examples_build/window
+MIMPI_BARRIER_ALGORITHM=dissemination ./run_test 5 6 examples_build/window